@@ -18,6 +18,9 @@ void* CORENewMap(COREContext* c, void* keys, void* values, uint len, COREMapKind
 //Context COREreater/deleters
 extern COREContext* CORENewContext();
 extern void COREDeleteContext(COREContext*);
+//Arrays, strings and maps returned by the API between Begin and EndScope are all freed by EndScope
+extern void COREContextBeginScope(COREContext* context);
+extern void COREContextEndScope(COREContext* context);
 extern COREType* COREContextNamedType(COREContext* context, const char* namespace_, const char* type_name);
 extern COREType* COREContextFlip(COREContext* context, COREType* type);
 
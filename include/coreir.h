@@ -15,6 +15,9 @@
 #include "coreir/ir/moduledef.h"
 #include "coreir/ir/wireable.h"
 #include "coreir/ir/coreirlib.h"
+#include "coreir/ir/interner.h"
+#include "coreir/ir/fingerprint.h"
+#include "coreir/ir/generatorcache.h"
 
 #include "coreir/ir/error.h"
 
@@ -0,0 +1,59 @@
+#ifndef COREIR_ARENA_HPP_
+#define COREIR_ARENA_HPP_
+
+#include "fwd_declare.h"
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace CoreIR {
+
+//Bump allocator which carves objects out of large contiguous slabs.
+//Blocks returned with deallocate are kept on a per-size free list and reused.
+//All memory is given back in one shot when the arena is reset or destroyed.
+//NOTE: the arena does not run destructors. Use create/destroy for objects.
+class Arena {
+  static const size_t minSlabSize = 4096;
+  static const size_t maxSlabSize = 1 << 20;
+  static const size_t alignment = alignof(std::max_align_t);
+
+  std::vector<void*> slabs;
+  char* cur = nullptr;
+  char* end = nullptr;
+  size_t nextSlabSize = minSlabSize;
+  size_t bytesReserved = 0;
+  size_t bytesUsed = 0;
+
+  //size -> head of an intrusive singly linked list of free blocks
+  std::map<size_t,void*> freeLists;
+
+  void newSlab(size_t minSize);
+  public :
+    Arena() {}
+    ~Arena() { reset(); }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size);
+    void deallocate(void* p, size_t size);
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+      return new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+    template<typename T>
+    void destroy(T* obj) {
+      obj->~T();
+      deallocate(obj,sizeof(T));
+    }
+
+    //Frees every slab. Any object still living in the arena is invalidated.
+    void reset();
+
+    size_t getBytesReserved() const { return bytesReserved; }
+    size_t getBytesUsed() const { return bytesUsed; }
+};
+
+}//CoreIR namespace
+
+#endif //ARENA_HPP_
@@ -12,7 +12,11 @@ namespace CoreIR {
 //TODO Ugly hack to create a sorted connection. Should make my own connection class
 Connection connectionCtor(Wireable* a, Wireable* b);
 
-typedef std::set<Connection,ConnectionCompFast> ConnectionsFast;
+typedef std::unordered_set<Connection,ConnectionHasher> ConnectionsFast;
+
+//Given a map from the top level wireables (interface and instances) of one def
+//to wireables of another, returns the wireable corresponding to w
+Wireable* selCorresponding(Wireable* w, const std::unordered_map<Wireable*,Wireable*>& topMap);
 
 //These are defined in helpers
 bool isNumber(std::string s);
@@ -21,6 +25,8 @@ bool isPower2(uint n);
 
 //Used to make sure string formats are valid for inst names, module names, etc
 void checkStringSyntax(std::string& str);
+//Same check without asserting
+bool isValidName(const std::string& str);
 
 //Checks that the values are of the correct names and types
 void checkValuesAreParams(Values args, Params params,std::string errstring="");
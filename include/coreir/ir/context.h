@@ -2,6 +2,8 @@
 #define COREIR_CONTEXT_HPP_
 
 #include "fwd_declare.h"
+#include <atomic>
+#include <mutex>
 
 namespace CoreIR {
 
@@ -16,14 +18,32 @@ class Context {
 
   uint maxErrors;
   std::vector<std::string> errors;
+  std::mutex errorLock;
  
   Module* top = nullptr;
 
-  //Unique int
-  uint unique=0;
+  //Unique int (module parallel passes can ask for one concurrently)
+  std::atomic<uint> unique{0};
+
+  //Threads that loaders (and passes that support it) may use
+  uint numThreads;
+  //Started on first use and kept until numThreads changes
+  ThreadPool* threadPool = nullptr;
+
+  //Directory the dirty flags of the modules are relative to (saveToDirectory)
+  std::string syncedDirectory;
+
+  //On disk cache of generated module definitions. Empty when not used
+  std::string generatorCacheDirectory;
 
   CoreIRLibrary* libmanager;
 
+  //Interned instance names and select strings
+  StringInterner* interner;
+
+  //Kept up to date by the IR once constructed (see createinstancegraph)
+  InstanceGraph* instanceGraph = nullptr;
+
   public :
     //Used for caching the types
     ValueCache* valuecache;
@@ -49,6 +69,15 @@ class Context {
     std::vector<DirectedConnection**> directedConnectionPtrArrays;
     std::vector<DirectedInstance**> directedInstancePtrArrays;
 
+    //Stack of open C API scopes. While a scope is open the arrays and maps
+    //above are allocated from its arena and released together by endScope.
+    struct Scope;
+    std::vector<Scope*> scopes;
+    template<typename T>
+    T* newArray(std::vector<T*>& list, int size);
+    template<typename T>
+    T* newMap(std::vector<T*>& list);
+
   public :
     Context();
     ~Context();
@@ -90,6 +119,23 @@ class Context {
     //Dynamically load a coreir library
     CoreIRLibrary* getLibraryManager() { return libmanager; }
 
+    StringInterner* getInterner() { return interner; }
+    InstanceGraph* getInstanceGraph() { return instanceGraph; }
+    void setInstanceGraph(InstanceGraph* ig) { instanceGraph = ig; }
+
+    //Defaults to 1, which makes everything serial. Do not call while a
+    //parallelFor is running on the pool.
+    void setNumThreads(uint n);
+    uint getNumThreads() const { return numThreads; }
+    ThreadPool* getThreadPool();
+    void setSyncedDirectory(std::string dirname) { syncedDirectory = dirname; }
+    const std::string& getSyncedDirectory() const { return syncedDirectory; }
+    //Definitions built by versioned generators (Generator::setVersion) are
+    //stored in dirname and reused instead of running the generator again.
+    //Defaults to $COREIR_GENERATOR_CACHE.
+    void setGeneratorCacheDirectory(std::string dirname) { generatorCacheDirectory = dirname; }
+    const std::string& getGeneratorCacheDirectory() const { return generatorCacheDirectory; }
+
     //Factory functions for Types
     BitType* Bit(); //Construct a BitOut type
     BitInType* BitIn();
@@ -149,6 +195,12 @@ class Context {
     DirectedConnection** newDirectedConnectionPtrArray(int size);
     DirectedInstance** newDirectedInstancePtrArray(int size);
 
+    //Scopes for the C API arrays/buffers/maps above. Everything allocated between
+    //beginScope and the matching endScope is freed by endScope. Scopes nest.
+    void beginScope();
+    void endScope();
+    uint getScopeDepth() const { return scopes.size(); }
+
 
 };
 
@@ -159,12 +211,39 @@ void deleteContext(Context* c);
 //This will load the namespaces in the file into the context
 //If there is a labeled "top", it will be returned in top (if it is not null)
 //if no "top" in file, *top == nullptr
-bool loadFromFile(Context* c, std::string filename,Module** top=nullptr);
+//With lazy, all symbols are declared but each module definition is only parsed
+//the first time it is requested (Module::getDef). The file stays mapped until
+//then. The layout of each definition is checked when the file is loaded, but
+//other errors in a definition are only found at that point and are fatal.
+bool loadFromFile(Context* c, std::string filename,Module** top=nullptr, bool lazy=false);
+
+//Loads several json files as one. The files are read concurrently and
+//references between them are resolved after everything is declared, so the
+//order of the files does not matter. Duplicate definitions (including ones
+//that differ from a definition the context already has), conflicting
+//declarations or tops and missing symbols of all the files are reported
+//together and no definition is built if there are any. The declarations made
+//before the problems were found stay in the context.
+bool linkFiles(Context* c, const std::vector<std::string>& filenames, Module** top=nullptr);
 
 //Save namespace to a file with optional "top" module
 bool saveToFile(Namespace* ns, std::string filename,Module* top=nullptr); //This will go away
 bool saveToFilePretty(Namespace* ns, std::string filename,Module* top=nullptr);
-bool saveToFile(Context* c, std::string filename, bool nocoreir=true);
+bool saveToFile(Context* c, std::string filename, bool nocoreir=true, bool compact=false);
+
+//Compact binary (.coreirb) version of loadFromFile/saveToFile.
+//The file stays memory mapped and module definitions are only built the first
+//time they are requested (Module::getDef) unless lazy is false.
+bool loadFromBinaryFile(Context* c, std::string filename, Module** top=nullptr, bool lazy=true);
+bool saveToBinaryFile(Context* c, std::string filename, bool nocoreir=true);
+bool saveToBinaryFile(Context* c, std::string filename, const std::vector<std::string>& namespaces);
+
+//Directory version of loadFromFile/saveToFile. Each module and each generator
+//(with its generated modules) is its own json file, listed in index.json.
+//With incremental, only the files of modules that are dirty (Module::isDirty)
+//since the directory was last saved or loaded are rewritten.
+bool loadFromDirectory(Context* c, std::string dirname, Module** top=nullptr, bool lazy=false);
+bool saveToDirectory(Context* c, std::string dirname, bool nocoreir=true, bool incremental=true);
 
 
 //Save a module to a dot file (for viewing in graphviz)
@@ -0,0 +1,24 @@
+#ifndef COREIR_FINGERPRINT_HPP_
+#define COREIR_FINGERPRINT_HPP_
+
+#include "fwd_declare.h"
+
+namespace CoreIR {
+
+//Canonical description of the structure of a module.
+//For a module with a definition this covers the type, modparams, default
+//modargs, metadata and the definition itself (instance names, referenced
+//modules, modargs and connections) but not the module's own name, so two
+//modules compare equal exactly when one can replace the other.
+//Modules without a definition are only equal to themselves.
+std::string getStructuralKey(Module* m);
+
+//64 bit FNV-1a hash of getStructuralKey. Stable between runs and builds.
+uint64_t getFingerprint(Module* m);
+
+//64 bit FNV-1a hash of s
+uint64_t hashString(const std::string& s);
+
+}//CoreIR namespace
+
+#endif //FINGERPRINT_HPP_
@@ -6,6 +6,8 @@
 #include <deque>
 #include <map>
 #include <set>
+#include <unordered_set>
+#include <unordered_map>
 #include <memory>
 #include <cassert>
 #include <sstream>
@@ -76,6 +78,9 @@ class TypeGen;
 
 class TypeCache;
 class ValueCache;
+class StringInterner;
+class ThreadPool;
+class Arena;
 
 class CoreIRLibrary;
 
@@ -128,6 +133,7 @@ typedef TemplatedConst<Json> ConstJson;
 
 class Pass;
 class PassManager;
+class InstanceGraph;
 
 typedef std::map<std::string,Value*> Values;
 typedef std::map<std::string,ValueType*> Params;
@@ -145,6 +151,15 @@ typedef std::function<void (Context* c,Values genargs,ModuleDef*) > ModuleDefGen
 typedef std::vector<std::pair<std::string,Type*>> RecordParams ;
 
 typedef std::deque<std::string> SelectPath;
+//Interned name (see interner.h). Only meaningful within the Context that created it
+struct Symbol {
+  uint32_t id;
+  explicit Symbol(uint32_t id=0) : id(id) {}
+  bool operator==(const Symbol& r) const { return id==r.id; }
+  bool operator!=(const Symbol& r) const { return id!=r.id; }
+  bool operator<(const Symbol& r) const { return id<r.id; }
+};
+typedef std::vector<Symbol> SymbolPath;
 typedef std::vector<std::reference_wrapper<const std::string>> ConstSelectPath;
 typedef std::pair<Wireable*,Wireable*> Connection;
 //This is meant to be in relation to an instance. First wireable of the pair is of that instance.
@@ -183,6 +198,26 @@ inline void hash_combine(size_t& seed, const T& v) {
   seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
 }
 
+//Hashes a Connection by its wireable pointers. Same (lack of) guarentees as ConnectionCompFast
+struct ConnectionHasher {
+  size_t operator()(const Connection& con) const {
+    size_t h = 0;
+    hash_combine(h,con.first);
+    hash_combine(h,con.second);
+    return h;
+  }
+};
+
+struct SymbolPathHasher {
+  size_t operator()(const SymbolPath& path) const {
+    size_t h = 0;
+    for (auto sym : path) {
+      hash_combine(h,sym.id);
+    }
+    return h;
+  }
+};
+
 
 
 } //CoreIR namespace
@@ -204,6 +239,13 @@ namespace std {
     size_t operator() (const CoreIR::Values& args) const;
   };
   
+  template <>
+  struct hash<CoreIR::Symbol> {
+    size_t operator() (const CoreIR::Symbol& sym) const {
+      return std::hash<uint32_t>()(sym.id);
+    }
+  };
+
   template <>
   struct hash<CoreIR::SelectPath> {
     size_t operator() (const CoreIR::SelectPath& path) const {
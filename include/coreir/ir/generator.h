@@ -4,6 +4,7 @@
 
 #include "fwd_declare.h"
 #include "globalvalue.h"
+#include <mutex>
 
 namespace CoreIR {
 
@@ -18,7 +19,13 @@ class Generator : public GlobalValue {
 
   //This is memory managed
   std::map<Values,Module*,ValuesComp> genCache;
+  //Module parallel passes can instance generators concurrently
+  std::recursive_mutex genCacheLock;
   GeneratorDef* def = nullptr;
+
+  //Identifies the behavior of def. Only versioned generators use the
+  //generator cache (see Context::setGeneratorCacheDirectory)
+  std::string version;
   
   public :
     Generator(Namespace* ns,std::string name,TypeGen* typegen, Params genparams);
@@ -49,6 +56,10 @@ class Generator : public GlobalValue {
     //This will transfer memory management of def to this Generator
     void setDef(GeneratorDef* def) { assert(!this->def); this->def = def;}
     void setGeneratorDefFromFun(ModuleDefGenFun fun);
+
+    //Has to change whenever the modules generated by def change
+    void setVersion(std::string version) { this->version = version; }
+    const std::string& getVersion() const { return version; }
     Params getGenParams() {return genparams;}
 
     //This will add (and override) default args
@@ -0,0 +1,27 @@
+#ifndef COREIR_GENERATORCACHE_HPP_
+#define COREIR_GENERATORCACHE_HPP_
+
+#include "fwd_declare.h"
+
+namespace CoreIR {
+
+//On disk cache of the definitions of generated modules. An entry is keyed by
+//the generator, its version and the genargs, and holds the json of the module
+//(see Context::setGeneratorCacheDirectory).
+
+//Generator, version and genargs of the generated module m
+std::string getGeneratorCacheKey(Module* m);
+
+//File of the entry for m in the cache directory of its context
+std::string getGeneratorCacheFile(Module* m);
+
+//Builds the definition of m from its cache entry. Returns false (leaving m
+//without a definition) if there is no entry or it does not match m.
+bool loadFromGeneratorCache(Module* m);
+
+//Stores the definition of m. Failing to write is not an error.
+void saveToGeneratorCache(Module* m);
+
+}//CoreIR namespace
+
+#endif //GENERATORCACHE_HPP_
@@ -3,40 +3,87 @@
 
 #include "coreir.h"
 #include "list"
+#include <mutex>
 
 namespace CoreIR {
 
 class InstanceGraphNode;
+//Once constructed the graph is kept up to date by the IR: adding, removing
+//and replacing instances, setting definitions and creating or deleting
+//modules update it (see Context::getInstanceGraph).
 class InstanceGraph {
   public:
     struct ModuleCmp {
       bool operator()(const Module* l, const Module* r) const;
     };
   private:
+    Context* c = nullptr;
     std::map<Module*,InstanceGraphNode*,ModuleCmp> nodeMap;
+    //Same nodes by pointer (for the updates)
+    std::unordered_map<Module*,InstanceGraphNode*> nodes;
     std::set<Module*,ModuleCmp> onlyTopNodes;
     std::list<InstanceGraphNode*> sortedNodes;
+    std::vector<std::vector<InstanceGraphNode*>> levels;
+    //The order (sortedNodes, levels and onlyTopNodes) only changes when a
+    //module starts or stops instancing another one. It is then recomputed
+    //from the edges when next asked for.
+    bool sorted = false;
+    Module* sortedTop = nullptr;
+    //Nodes each module instances
+    std::unordered_map<Module*,std::unordered_set<InstanceGraphNode*>> instanced;
+    //Updates can come from lazy definitions loaded by concurrent tasks.
+    //Module local passes detach the modules they run on instead of locking.
+    std::recursive_mutex lock;
+    InstanceGraphNode* getNode(Module* m);
+    InstanceGraphNode* addNode(Module* m);
+    void resync(Module* m);
+    void sort();
+    void updateOrder();
+    friend class InstanceGraphNode;
   public :
     InstanceGraph() {}
     ~InstanceGraph() {this->releaseMemory();}
     void construct(Context* c);
-    std::list<InstanceGraphNode*> getSortedNodes() { return sortedNodes;}
+    bool isConstructed() { return c != nullptr;}
+    std::list<InstanceGraphNode*> getSortedNodes();
+    //Nodes grouped by InstanceGraphNode::getLevel (in sorted order within a
+    //level). No node instances another node of the same level.
+    std::vector<std::vector<InstanceGraphNode*>> getLevels();
     bool validOnlyTop(InstanceGraphNode* node);
     void releaseMemory();
     void sortVisit(InstanceGraphNode* node);
+
+    //The updates (called by the IR)
+    void addModule(Module* m);
+    void eraseModule(Module* m);
+    void addInstance(Instance* i);
+    void removeInstance(Instance* i);
+
+    //While m is detached, changes to its definition are not applied to the
+    //graph. attachModule brings the instances of m up to date again. Used by
+    //the pass manager around concurrent module local passes.
+    void detachModule(Module* m);
+    void attachModule(Module* m);
 };
 
 class InstanceGraphNode {
   //The underlying instantiable
   Module* m;
+  InstanceGraph* ig;
   typedef std::vector<Instance*> InstanceList;
-  InstanceList instanceList;
+  //Ordered by the containing module and then by name
+  struct InstanceCmp {
+    bool operator()(Instance* l, Instance* r) const;
+  };
   bool external;
   public:
-    InstanceGraphNode(Module* m,bool external) : m(m), external(external) {}
+    InstanceGraphNode(Module* m,InstanceGraph* ig,bool external) : m(m), ig(ig), external(external) {}
     //Returns a list of instances that instantiate THIS instantiable (Kind of like a Use-def
-    InstanceList getInstanceList() { return instanceList;}
+    InstanceList getInstanceList();
     Module* getModule() { return m;}
+    //0 if the module instances nothing, else one more than the highest level
+    //of the modules it instances
+    int getLevel() { return level;}
 
     bool isExternal() {return external;}
 
@@ -49,12 +96,12 @@ class InstanceGraphNode {
     void detachField(std::string label);
 
   private:
-    std::vector<InstanceGraphNode*> ignList;
+    //Instances of this in each module
+    std::map<Module*,std::unordered_set<Instance*>,InstanceGraph::ModuleCmp> parents;
+    //Modules instanced by this one (set by InstanceGraph::sort)
+    std::vector<InstanceGraphNode*> children;
     int mark=0; //unmarked=0, temp=1,perm=2
-    void addInstance(Instance* i, InstanceGraphNode* ign) { 
-      instanceList.push_back(i);
-      ignList.push_back(ign);
-    }
+    int level=0;
 
   friend class InstanceGraph;
 };
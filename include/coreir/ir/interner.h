@@ -0,0 +1,68 @@
+#ifndef COREIR_INTERNER_HPP_
+#define COREIR_INTERNER_HPP_
+
+#include "fwd_declare.h"
+#include <atomic>
+#include <mutex>
+
+namespace CoreIR {
+
+//Context wide table of unique strings.
+//Every distinct string is stored exactly once and is identified by a small
+//integer Symbol, so equality and hashing of names is O(1).
+//References returned by getString stay valid for the lifetime of the table.
+//Concurrent passes can add names. Looking up a name or a symbol does not
+//lock, only adding a new name does.
+class StringInterner {
+  //Chunk k holds 2^(firstChunkBits+k) strings. Chunks are never moved, so
+  //strings can be read while others are added.
+  static const uint32_t firstChunkBits = 10;
+  static const uint32_t maxChunks = 22;
+  std::atomic<std::string*> chunks[maxChunks];
+  //Strings below this are fully constructed
+  std::atomic<uint32_t> count{0};
+
+  //Open addressing hash table of symbol ids + 1 (0 is empty). It is kept at
+  //most half full by replacing it with one twice the size. Replaced tables
+  //are kept until the interner is destroyed since readers may still use them.
+  struct Table {
+    uint32_t mask;
+    std::atomic<uint32_t>* slots;
+  };
+  std::atomic<Table*> table;
+  std::vector<Table*> tables;
+  //Held to add a string
+  std::mutex mutex;
+
+  const std::string& at(uint32_t id) const {
+    uint32_t n = id + (1u << firstChunkBits);
+    uint32_t k = 31 - __builtin_clz(n) - firstChunkBits;
+    return chunks[k].load(std::memory_order_acquire)[n - (1u << (firstChunkBits+k))];
+  }
+  bool find(const std::string& s, size_t hash, Symbol& sym) const;
+  void insert(Table* t, uint32_t id, size_t hash);
+
+  public :
+    StringInterner();
+    ~StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    Symbol intern(const std::string& s);
+    bool isInterned(const std::string& s) const {
+      Symbol sym;
+      return find(s,std::hash<std::string>()(s),sym);
+    }
+    const std::string& getString(Symbol sym) const {
+      ASSERT(sym.id < count.load(std::memory_order_acquire),"Unknown symbol: " + std::to_string(sym.id));
+      return at(sym.id);
+    }
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    SymbolPath toSymbolPath(const SelectPath& path);
+    SelectPath toSelectPath(const SymbolPath& path) const;
+};
+
+}//CoreIR namespace
+
+#endif //INTERNER_HPP_
@@ -0,0 +1,32 @@
+#ifndef COREIR_MAPPEDFILE_HPP_
+#define COREIR_MAPPEDFILE_HPP_
+
+#include "fwd_declare.h"
+
+namespace CoreIR {
+
+//Read only memory mapping of a whole file. Pages are loaded by the OS on
+//demand and can be dropped again, so nothing proportional to the file size
+//lives on the heap.
+//An empty file is open but has begin()==end().
+class MappedFile {
+  const char* data = nullptr;
+  size_t size = 0;
+  bool opened = false;
+  public :
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    bool isOpen() const { return opened; }
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+    size_t getSize() const { return size; }
+
+    //Hint that the file will be read front to back
+    void adviseSequential();
+};
+
+}//CoreIR namespace
+
+#endif //MAPPEDFILE_HPP_
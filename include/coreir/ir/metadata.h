@@ -3,17 +3,36 @@
 
 #include "fwd_declare.h"
 #include "json.h"
+#include <memory>
 
 using json = nlohmann::json;
 
 namespace CoreIR {
+
+//The json object is only allocated on first use so that the (vast majority of)
+//objects without metadata cost a single null pointer.
 class MetaData {
-  json metadata;
+  std::unique_ptr<json> metadata;
   public:
-    MetaData() : metadata(json::value_t::object) {}
-    json& getMetaData() {return metadata;}
-    bool hasMetaData() {return !metadata.empty();}
-    void setMetaData(json j) {metadata = j;}
+    MetaData() {}
+    MetaData(const MetaData& m) : metadata(m.metadata ? new json(*m.metadata) : nullptr) {}
+    MetaData& operator=(const MetaData& m) {
+      metadata.reset(m.metadata ? new json(*m.metadata) : nullptr);
+      return *this;
+    }
+
+    //Creates an empty metadata object if there is none yet.
+    //Use hasMetaData to check for metadata without allocating.
+    json& getMetaData() {
+      if (!metadata) metadata.reset(new json(json::value_t::object));
+      return *metadata;
+    }
+    bool hasMetaData() const {return metadata && !metadata->empty();}
+    bool hasMetaData(const std::string& key) const {return metadata && metadata->count(key) > 0;}
+    void setMetaData(json j) {
+      if (j.empty()) metadata.reset();
+      else metadata.reset(new json(std::move(j)));
+    }
 };
 
 }//CoreIR namespace
@@ -5,12 +5,29 @@
 #include "fwd_declare.h"
 #include "args.h"
 #include "globalvalue.h"
+#include <atomic>
+#include <mutex>
 
 namespace CoreIR {
 
 class Module : public GlobalValue, public Args {
   RecordType* type;
   ModuleDef* def = nullptr;
+  //Produces def the first time it is requested (see setDefLoader)
+  mutable std::function<void(Module*)> defLoader;
+  //Set until the lazy definition is loaded. Tasks of parallel passes can ask
+  //for the same definition, so it is loaded under defLock
+  mutable std::atomic<bool> lazyDef{false};
+  mutable std::recursive_mutex defLock;
+
+  //Changed since it was last saved (see saveToDirectory)
+  bool dirty = true;
+  //Changed since the pass manager last verified it
+  bool unverified = true;
+  //See InstanceGraph::detachModule. graphStale is set when the definition
+  //changes while detached, possibly from the task loading it.
+  bool graphDetached = false;
+  std::atomic<bool> graphStale{false};
   
   const Params modparams;
   Values defaultModArgs;
@@ -31,10 +48,24 @@ class Module : public GlobalValue, public Args {
     Module(Namespace* ns,std::string name, Type* type,Params modparams, Generator* g, Values genargs);
     virtual ~Module();
     static bool classof(const GlobalValue* i) {return i->getKind()==GVK_Module;}
-    bool hasDef() const { return !!def; }
+    bool hasDef() const { return lazyDef || def; }
     ModuleDef* getDef() const;
     //This will validate def
     void setDef(ModuleDef* def, bool validate=true);
+
+    //Attaches a definition that is only built when it is first requested.
+    //The loader is run at most once and is expected to call setDef.
+    void setDefLoader(std::function<void(Module*)> loader);
+    //True if the definition has not been materialized yet
+    bool hasLazyDef() const { return lazyDef; }
+
+    //Set whenever the interface, default args or definition of the module
+    //changes. Metadata edits are not tracked, call markDirty after those.
+    bool isDirty() const { return dirty; }
+    void markDirty() { dirty = true; unverified = true; }
+    void clearDirty() { dirty = false; }
+    bool isUnverified() const { return unverified; }
+    void clearUnverified() { unverified = false; }
    
     ModuleDef* newModuleDef();
     
@@ -68,9 +99,12 @@ class Module : public GlobalValue, public Args {
 
   private :
     //This should be used very carefully. Could make things inconsistent
+    friend class InstanceGraph;
     friend class InstanceGraphNode;
+    friend class ModuleDef;
     void setType(RecordType* t) {
       this->type = t;
+      this->markDirty();
     }
 };
 
@@ -6,32 +6,53 @@
 #include "context.h"
 #include "module.h"
 #include "wireable.h"
+#include "arena.h"
 
 namespace CoreIR {
 
 class ModuleDef {
     friend class Wireable;
   protected:
+    //Backing memory for every wireable (interface, instances, selects) of this def
+    Arena arena;
+
     Module* module;
     Interface* interface; 
     std::map<std::string,Instance*> instances;
-    std::set<Connection,ConnectionCompFast> connections;
+    //Same instances keyed by interned name
+    std::unordered_map<Symbol,Instance*> instanceSyms;
+    //Connections are always stored in connectionCtor order
+    std::unordered_set<Connection,ConnectionHasher> connections;
+
+    //Only connections which actually have metadata get an entry
+    std::unordered_map<Connection,json,ConnectionHasher> connMetaData;
 
-    std::map<Connection,MetaData*,ConnectionCompFast> connMetaData;
+    //Connections made by connectBulk that commitBulk has not checked yet
+    std::vector<Connection> uncheckedConnections;
     
     // Instances Iterator Internal Fields/API
     Instance* instancesIterFirst = nullptr;
     Instance* instancesIterLast = nullptr;
-    std::map<Instance*,Instance*> instancesIterNextMap;
-    std::map<Instance*,Instance*> instancesIterPrevMap;
     void appendInstanceToIter(Instance* instance);
     void removeInstanceFromIter(Instance* instance);
+
+    //Wireables are carved out of the arena and handed back with freeWireable
+    template<typename T, typename... Args>
+    T* newWireable(Args&&... args) {
+      return arena.create<T>(std::forward<Args>(args)...);
+    }
+    void freeWireable(Wireable* w);
+
+    //The instance graph to update (if there is one, this is the definition
+    //of the module and the module is not detached from it)
+    InstanceGraph* getInstanceGraph();
+    friend class Instance;
     
   public :
     ModuleDef(Module* m);
     ~ModuleDef();
     const std::map<std::string,Instance*>& getInstances(void) const { return instances;}
-    const std::set<Connection,ConnectionCompFast>& getConnections(void) const { return connections; }
+    const std::unordered_set<Connection,ConnectionHasher>& getConnections(void) const { return connections; }
     const std::vector<Connection> getSortedConnections(void) const;
     bool hasInstances(void) { return !instances.empty();}
     void print(void);
@@ -50,6 +71,9 @@ class ModuleDef {
     Wireable* sel(const std::string& s);
     //Or using a select Path
     Wireable* sel(const SelectPath& path);
+    //Or using interned names
+    Wireable* sel(Symbol s);
+    Wireable* sel(const SymbolPath& path);
 
     //Ignore these
     Wireable* sel(std::initializer_list<const char*> path);
@@ -72,11 +96,32 @@ class ModuleDef {
     Instance* getInstancesIterNext(Instance* instance);
 
     //API for connecting two instances together
+    //Note this can rehash the connections and invalidate iterators from getConnections()
     void connect(Wireable* a, Wireable* b);
     void connect(const SelectPath& pathA, const SelectPath& pathB);
     void connect(const std::string& pathA, const std::string& pathB); //dot notation a.b.c, e.f.g
     void connect(std::initializer_list<const char*> pA, std::initializer_list<const char*> pB);
     void connect(std::initializer_list<std::string> pA, std::initializer_list<std::string> pB);
+
+    //Bulk construction API for large (generated) definitions
+    //Reserves room for this many additional instances and connections
+    void reserve(size_t numInstances, size_t numConnections);
+    //An instance of an already resolved module (generated modules come from
+    //Generator::getModule)
+    struct InstanceDecl {
+      std::string name;
+      Module* modref;
+      Values modargs;
+    };
+    //Adds the instances in order and returns them in the same order
+    std::vector<Instance*> addInstances(const std::vector<InstanceDecl>& decls);
+    //Connects already selected wireables without parsing select paths. The
+    //types are not checked here but all at once by commitBulk.
+    void connectBulk(const std::vector<Connection>& cons);
+    //Type checks the connections made by connectBulk since the last commit.
+    //Module::setDef commits (or fully validates) the def it installs.
+    //Returns true if there is an error
+    bool commitBulk();
     
     bool hasConnection(Wireable* a, Wireable* b);
     Connection getConnection(Wireable* a, Wireable* b);
@@ -0,0 +1,60 @@
+#ifndef COREIR_PARALLEL_HPP_
+#define COREIR_PARALLEL_HPP_
+
+#include "fwd_declare.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace CoreIR {
+
+//Number of hardware threads (at least 1)
+uint getHardwareThreads();
+
+//Worker threads that are started once and reused by every parallelFor. The
+//calling thread is one of the numThreads, so numThreads-1 workers are started.
+class ThreadPool {
+  std::vector<std::thread> workers;
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  bool stopping = false;
+  //Bumped for every loop handed to the workers
+  uint generation = 0;
+  //Workers still running the current loop
+  uint active = 0;
+  //Set while a loop is running. Nested or concurrent loops run serially
+  std::atomic<bool> busy{false};
+
+  //The current loop
+  std::function<void(size_t)>* job = nullptr;
+  size_t jobSize = 0;
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+
+  void work();
+  void workerLoop();
+
+  public :
+    explicit ThreadPool(uint numThreads);
+    ~ThreadPool();
+    uint getNumThreads() const { return workers.size()+1; }
+
+    //Runs f(i) for every i in [0,n) on the pool and returns once all are
+    //done. Work is handed out one index at a time, so uneven items balance
+    //out. If the pool is already running a loop (f calls parallelFor, or
+    //another thread does) the items are run on the calling thread.
+    //If f throws, the remaining items are skipped and the first exception is
+    //rethrown in the calling thread.
+    void parallelFor(size_t n, std::function<void(size_t)> f);
+};
+
+//Runs the loop on the thread pool of c (see Context::setNumThreads)
+void parallelFor(Context* c, size_t n, std::function<void(size_t)> f);
+
+}//CoreIR namespace
+
+#endif //PARALLEL_HPP_
@@ -17,6 +17,9 @@ class Pass {
     //Whether this is an isAnalysis pass
     bool isAnalysis;
     std::vector<std::string> dependencies;
+    //Analyses that are still valid after this pass modifies the IR
+    std::set<std::string> preserved;
+    bool keptUpToDate = false;
     PassManager* pm;
   public:
     explicit Pass(PassKind kind,std::string name, std::string description, bool isAnalysis) : kind(kind), name(name), description(description), isAnalysis(isAnalysis) {}
@@ -27,6 +30,14 @@ class Pass {
     virtual void releaseMemory() {}
     virtual void setAnalysisInfo() {}
     void addDependency(std::string name) { dependencies.push_back(name);}
+    //Declares that this (transform) pass keeps the analysis name valid. By
+    //default every analysis is invalidated when the pass modifies the IR.
+    void addPreserved(std::string name) { preserved.insert(name);}
+    bool preserves(std::string name) { return preserved.count(name)>0;}
+    //Declares that this analysis follows the changes to the IR itself, so no
+    //pass invalidates it
+    void setKeptUpToDate() { keptUpToDate = true;}
+    bool isKeptUpToDate() { return keptUpToDate;}
     Context* getContext();
     std::string getName() { return name;}
     virtual void print() {}
@@ -74,6 +85,7 @@ class NamespacePass : public Pass {
 //Loops through all the modules (with defs) within the namespace
 //You can edit the current module but not any other module!
 class ModulePass : public Pass {
+  bool moduleParallel = false;
   public:
     explicit ModulePass(std::string name, std::string description, bool isAnalysis=false) : Pass(PK_Module,name,description,isAnalysis) {}
     static bool classof(const Pass* p) {return p->getKind()==PK_Module;}
@@ -82,7 +94,14 @@ class ModulePass : public Pass {
     virtual void releaseMemory() override {}
     virtual void setAnalysisInfo() override {}
     virtual void print() override {}
-
+    
+    //Declares that runOnModule can run on several modules at once (see
+    //Context::setNumThreads). runOnModule may then only read and change m's
+    //own definition; other modules can be instanced but not changed (or have
+    //their lazy definition loaded), and the namespaces cannot be changed. Members of the pass that runOnModule writes
+    //need their own lock.
+    void setModuleParallel() { moduleParallel = true; }
+    bool isModuleParallel() const { return moduleParallel; }
 };
 
 //Loops through all instances of all modules
@@ -132,12 +151,17 @@ class InstanceGraphNode;
 class InstanceGraphPass : public Pass {
   protected:
     bool onlyTop = false;
+    //The nodes of a level (see InstanceGraph::getLevels) can run at once (see
+    //Context::setNumThreads). runOnInstanceGraphNode may then only change the
+    //module of the node and read the modules of lower levels.
+    bool levelParallel = false;
   public:
     
     explicit InstanceGraphPass(std::string name, std::string description, bool isAnalysis=false) : Pass(PK_InstanceGraph,name,description,isAnalysis) {
       addDependency("createinstancegraph");
     }
     bool isOnlyTop() { return onlyTop; }
+    bool isLevelParallel() { return levelParallel; }
     static bool classof(const Pass* p) {return p->getKind()==PK_InstanceGraph;}
     virtual void initialize(int argc, char** argv) override {}
     virtual bool runOnInstanceGraphNode(InstanceGraphNode& node) = 0;
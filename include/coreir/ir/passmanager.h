@@ -3,10 +3,28 @@
 
 #include "fwd_declare.h"
 #include <stack>
+#include <ostream>
 
 namespace CoreIR {
 
 class InstanceGraph;
+
+//Measurements of a pass summed over all of its runs
+struct PassStats {
+  unsigned runs = 0;
+  double wallSeconds = 0;
+  //Process CPU time, so it includes the worker threads of the pass
+  double cpuSeconds = 0;
+  //Growth of the peak resident set size
+  long peakRssDeltaKB = 0;
+  //Number of instances and connections in all the module definitions of the
+  //context before the first run and after the last run
+  size_t instancesBefore = 0;
+  size_t instancesAfter = 0;
+  size_t connectionsBefore = 0;
+  size_t connectionsAfter = 0;
+};
+
 class PassManager {
   Context* c;
   std::vector<Namespace*> nss; 
@@ -19,6 +37,14 @@ class PassManager {
   
   std::vector<std::string> passLog;
   bool verbose = false;
+  bool verifyAll = false;
+  //Module passes skip the modules that did not change (see verifyModified)
+  bool onlyUnverified = false;
+
+  //Pass name to stats, and the names in the order they first ran
+  bool instrumented = false;
+  std::map<std::string,PassStats> passStats;
+  std::vector<std::string> passStatsOrder;
   public:
     explicit PassManager(Context* c);
     ~PassManager();
@@ -31,9 +57,21 @@ class PassManager {
     bool run(std::vector<std::string>& passes, std::vector<std::string> namespaceName={"global"});
     bool isAnalysisCached(std::string);
     void setVerbosity(bool v) { verbose = v;}
+    //After a pass modifies the IR, only the modules that changed are verified
+    //unless this is set
+    void setVerifyAll(bool v) { verifyAll = v;}
     void printLog();
     void printPassChoices();
 
+    //Collects PassStats for every pass that runs. Counting the IR size walks
+    //every module definition so this is off by default.
+    void setInstrumented(bool i) { instrumented = i;}
+    bool isInstrumented() { return instrumented;}
+    const std::map<std::string,PassStats>& getPassStats() { return passStats;}
+    void clearPassStats() { passStats.clear(); passStatsOrder.clear();}
+    void printPassStats(std::ostream& os);
+    void writePassStatsJson(std::ostream& os);
+
     Pass* getAnalysisPass(std::string ID) {
       assert(passMap.count(ID));
       return passMap[ID];
@@ -44,6 +82,7 @@ class PassManager {
 
     friend class Pass;
     bool runPass(Pass* p, std::vector<std::string>&);
+    void verifyModified();
 
     bool runContextPass(Pass* p);
     bool runNamespacePass(Pass* p);
@@ -5,6 +5,7 @@
 
 //TODO need to add a comparison function for RecordParams in order to use map
 #include <unordered_map>
+#include <mutex>
 
 namespace CoreIR {
 
@@ -23,8 +24,10 @@ struct RecordParamsHasher {
 
 
 //This stores Types and VTypes
+//The caches are locked so that types can be created from concurrent passes
 class TypeCache {
   Context* c;
+  std::recursive_mutex mutex;
   BitInType* bitI;
   BitType* bitO;
   BitInOutType* bitIO;
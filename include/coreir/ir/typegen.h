@@ -3,11 +3,13 @@
 
 #include "fwd_declare.h"
 #include "globalvalue.h"
+#include <mutex>
 
 namespace CoreIR {
 
 class TypeGen : public GlobalValue {
   std::map<Values,Type*,ValuesComp> typeCache;
+  std::recursive_mutex typeCacheLock;
   Params params;
   bool flipped;
   
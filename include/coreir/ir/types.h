@@ -25,8 +25,10 @@ class Type {
     DirKind getDir() const {return dir;}
     virtual std::string toString(void) const =0;
     Type* sel(std::string sel);
+    Type* sel(uint i);
     std::vector<std::string> getSelects();
     bool canSel(std::string sel);
+    bool canSel(uint i);
     bool canSel(SelectPath path);
     virtual uint getSize() const=0;
     virtual void print(void) const;
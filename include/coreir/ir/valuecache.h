@@ -2,6 +2,7 @@
 #define COREIR_VALUECACHE_HPP_
 
 #include "fwd_declare.h"
+#include <mutex>
 
 namespace CoreIR {
 
@@ -16,8 +17,10 @@ class BitVectorComp {
 //};
 
 //This stores Values (Constants)
+//The caches are locked so that values can be created from concurrent passes
 class ValueCache {
   Context* c;
+  std::recursive_mutex mutex;
   ConstBool* boolTrue;
   ConstBool* boolFalse;
   std::map<int,ConstInt*> intCache;
@@ -20,14 +20,20 @@ class Wireable : public MetaData {
     std::set<Wireable*> connected; 
     
     //This manages the memory for the selects
-    std::map<std::string,Select*> selects;
-    SelectPath selectpath;
+    std::map<Symbol,Select*> selects;
+    //Cached by getSymbolPath
+    SymbolPath selectpath;
+
+    Select* newSel(Symbol sym, Type* t);
   public :
     Wireable(WireableKind kind, ModuleDef* container, Type* type) : MetaData(), kind(kind),  container(container), type(type) {}
     virtual ~Wireable();
     virtual std::string toString() const=0;
     const std::set<Wireable*>& getConnectedWireables() { return connected;}
-    const std::map<std::string,Select*>& getSelects() { return selects;}
+    //Built on each call, ordered by name
+    std::map<std::string,Select*> getSelects();
+    //Ordered by symbol
+    const std::map<Symbol,Select*>& getSymbolSelects() { return selects;}
     ModuleDef* getContainer() { return container;}
     Context* getContext();
     WireableKind getKind() const { return kind; }
@@ -43,12 +49,15 @@ class Wireable : public MetaData {
     Select* sel(const std::string&);
     Select* sel(uint);
     Select* sel(const SelectPath&);
+    Select* sel(Symbol);
+    Select* sel(const SymbolPath&);
     
     //Ignore These
     Select* sel(std::initializer_list<const char*> path);
     Select* sel(std::initializer_list<std::string> path);
   
     bool canSel(std::string);
+    bool canSel(uint);
     bool canSel(SelectPath);
   
     //Connect this to w
@@ -61,8 +70,10 @@ class Wireable : public MetaData {
 
     // if this wireable is from add3inst.a.b[0], then this will look like
     // {add3inst,a,b,0}
-    SelectPath& getSelectPath();
+    SelectPath getSelectPath();
     ConstSelectPath getConstSelectPath();
+    //Same as getSelectPath but with interned names
+    const SymbolPath& getSymbolPath();
     std::string wireableKind2Str(WireableKind wb);
 
     //TODO turn these into iterators instead
@@ -103,9 +114,14 @@ class Interface : public Wireable {
 };
 
 class Instance : public Wireable {
-  const std::string instname;
+  const Symbol instsym;
+  const std::string& instname;
   Module* moduleRef;
   Values modargs;
+
+  //Intrusive links for the insertion ordered instance list of the container
+  Instance* iterPrev = nullptr;
+  Instance* iterNext = nullptr;
   
   public :
     Instance(ModuleDef* container, std::string instname, Module* moduleRef, Values modargs);
@@ -113,6 +129,7 @@ class Instance : public Wireable {
     std::string toString() const;
     json toJson();
     const std::string& getInstname() const { return instname; }
+    Symbol getInstsym() const { return instsym; }
     const Values& getModArgs() const {return modargs;}
     bool hasModArgs() {return !modargs.empty();}
     
@@ -122,18 +139,20 @@ class Instance : public Wireable {
     //void replace(Generator* generatorRef, Values genargs, Values modargs=Values());
   
   friend class InstanceGraphNode;
+  friend class ModuleDef;
 };
 
 class Select : public Wireable {
   protected :
     Wireable* parent;
-    std::string selStr;
+    const Symbol selsym;
   public :
-    Select(ModuleDef* container, Wireable* parent, std::string selStr, Type* type) : Wireable(WK_Select,container,type), parent(parent), selStr(selStr) {}
+    Select(ModuleDef* container, Wireable* parent, Symbol selsym, Type* type);
     static bool classof(const Wireable* w) {return w->getKind()==WK_Select;}
     std::string toString() const;
     Wireable* getParent() { return parent; }
-    const std::string& getSelStr() { return selStr; }
+    const std::string& getSelStr() const;
+    Symbol getSelsym() const { return selsym; }
 };
 
 }//CoreIR namespace
@@ -9,12 +9,21 @@ namespace Passes {
 
 class CoreIRJson : public NamespacePass {
 
-  std::map<std::string,std::string> nsMap;
+  //Json is only produced (streamed) by writeToStream
+  std::map<std::string,Namespace*> nsMap;
   public :
     static std::string ID;
     CoreIRJson() : NamespacePass(ID,"Creates a json of the coreir",true) {}
     bool runOnNamespace(Namespace* ns) override;
-    void writeToStream(std::ostream& os,std::string topRef="");
+    //compact leaves out all whitespace
+    void writeToStream(std::ostream& os,std::string topRef="",bool compact=false);
+
+    //Documents with a single module (or generator with its generated modules)
+    //or just the typegens of a namespace. These do not need the pass to run.
+    static void writeGlobalValueToStream(std::ostream& os, GlobalValue* gv, bool compact=false);
+    static void writeTypeGensToStream(std::ostream& os, Namespace* ns, bool compact=false);
+    //Just the json of the module itself (type, params and definition)
+    static void writeModuleToStream(std::ostream& os, Module* m, bool compact=false);
 };
 
 }
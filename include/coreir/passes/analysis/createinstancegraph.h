@@ -14,6 +14,10 @@ class CreateInstanceGraph : public ContextPass {
       ig = new InstanceGraph;
     }
     ~CreateInstanceGraph() { delete ig;}
+    void setAnalysisInfo() override {
+      //Once constructed the IR updates the graph
+      setKeptUpToDate();
+    }
     bool runOnContext(Context* c) override;
     void releaseMemory() override;
     InstanceGraph* getInstanceGraph() { return ig;}
@@ -10,6 +10,9 @@ namespace Passes {
 	public :
 		static std::string ID;
 	  VerifyFlatCoreirPrims() : InstanceGraphPass(ID, "Verify all instances have been flattened", true) {}
+		void setAnalysisInfo() override {
+			levelParallel = true;
+		}
 		bool runOnInstanceGraphNode(InstanceGraphNode& node) override;
 	}; /* class VerifyFlatCoreirPrims */
 
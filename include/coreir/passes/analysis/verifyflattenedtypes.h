@@ -10,6 +10,9 @@ class VerifyFlattenedTypes : public InstanceGraphPass {
   public :
     static std::string ID;
     VerifyFlattenedTypes() : InstanceGraphPass(ID,"Verify all modules and instances have flattened types",true) {}
+    void setAnalysisInfo() override {
+      levelParallel = true;
+    }
     bool runOnInstanceGraphNode(InstanceGraphNode& node) override;
 };
 
@@ -2,16 +2,25 @@
 #define VERIFY_HPP_
 
 #include "coreir.h"
+#include <mutex>
 
 namespace CoreIR {
 namespace Passes {
 
 //Verifies that All input connections are driven by exactly one source
 class VerifyInputConnections : public ModulePass {
+  //Errors of each failing module. They are reported (in module order) once
+  //all the modules are checked
+  std::map<std::string,std::vector<Error>> errors;
+  std::mutex errorLock;
   public :
     static std::string ID;
     VerifyInputConnections() : ModulePass(ID,"Verifies no multiple outputs to inputs",true) {}
+    void setAnalysisInfo() override {
+      setModuleParallel();
+    }
     bool runOnModule(Module* m) override;
+    bool finalize() override;
 };
 
 }
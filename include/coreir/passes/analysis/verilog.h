@@ -10,6 +10,8 @@ namespace Passes {
 
 class Verilog : public InstanceGraphPass {
   VerilogNamespace::VModules vmods;
+  //Builds the bodies of all the modules (see VModules::buildAll)
+  std::vector<const VerilogNamespace::VModule*> getModulesToWrite();
   public :
     static std::string ID;
     Verilog() : InstanceGraphPass(ID,"Creates Verilog representation of IR",true) {}
@@ -40,6 +40,7 @@ std::string toConstString(Value* v) {
 }
 
 struct VModule;
+struct CoreIRVModule;
 struct VModules {
   vector<VModule*> mods;
   map<Module*,VModule*> mod2VMod;
@@ -50,8 +51,18 @@ struct VModules {
   map<Generator*,VModule*> gen2VMod;
 
   vector<VModule*> externalVMods;
+
+  //CoreIR modules are only declared by addModule. Their bodies are built by
+  //buildAll once every module has been added.
+  vector<CoreIRVModule*> unbuilt;
   
   void addModule(Module* m);
+  //Bodies only read the other VModules, so they are built concurrently
+  void buildAll(Context* c);
+  VModule* getVModule(Module* m) const {
+    auto it = mod2VMod.find(m);
+    return it==mod2VMod.end() ? nullptr : it->second;
+  }
 
 };
 
@@ -120,9 +131,12 @@ struct VModule {
 
   std::string toString() const;
 
-  std::string toInstanceString(Instance* inst);
+  std::string toInstanceString(Instance* inst) const;
+
+  //Everything about this module that shows up where it is instanced
+  virtual std::string getInstanceKey() const;
 
-  void Type2Ports(Type* t,std::map<std::string,VWire>& ports) {
+  void Type2Ports(Type* t,std::map<std::string,VWire>& ports) const {
 
     for (auto rmap : cast<RecordType>(t)->getRecord()) {
 ports.emplace(rmap.first,VWire(rmap.first,rmap.second));
@@ -157,7 +171,8 @@ class VObjComp {
 
 
 struct CoreIRVModule : VModule {
-  Module* mod;
+  ModuleDef* def;
+  bool built = false;
   //Backwards maps
   std::map<Instance*,VObject*> inst2VObj;
   std::map<string,std::set<VObject*,VObjComp>> sortedVObj;
@@ -174,6 +189,11 @@ struct CoreIRVModule : VModule {
           std::queue<Connection> &worklist);
   
   CoreIRVModule(VModules* vmods, Module* m);
+  //Adds the instances and connections of def
+  void build();
+  //Changes whenever the verilog of this module would change. It only looks at
+  //the definition and the instanced modules so it does not need build.
+  std::string getContentKey() const;
 
 };
 
@@ -227,7 +247,7 @@ struct VInstance : VObject {
   
   virtual void materialize(CoreIRVModule* vmod) override {
     Module* mref = inst->getModuleRef();
-    VModule* vref = vmods->mod2VMod[mref];
+    VModule* vref = vmods->getVModule(mref);
     assert(vref);
     if (this->line > 0) {
       vmod->addComment("Instanced at line " + to_string(this->line));
@@ -362,6 +382,9 @@ struct VerilogVModule : VModule {
       this->inlineable = true;
     }
   }
+  std::string getInstanceKey() const override {
+    return VModule::getInstanceKey() + jver.dump();
+  }
 };
 
 //Need to add 
@@ -45,6 +45,7 @@
 #include "transform/cullgraph.h"
 #include "transform/markdirty.h"
 #include "transform/unresolvedsymbols.h"
+#include "transform/dedupmodules.h"
 
 #include "transform/adddirected.h"
 #include "transform/transform2combview.h"
@@ -101,6 +102,7 @@ namespace CoreIR {
     pm.addPass(new Passes::DeleteUnusedInouts("delete-unused-inouts"));
     pm.addPass(new Passes::Transform2CombView());
     pm.addPass(new Passes::MarkDirty());
+    pm.addPass(new Passes::DedupModules());
   }
 }
 
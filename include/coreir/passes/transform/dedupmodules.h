@@ -0,0 +1,22 @@
+#ifndef COREIR_DEDUPMODULES_HPP_
+#define COREIR_DEDUPMODULES_HPP_
+
+#include "coreir.h"
+
+namespace CoreIR {
+namespace Passes {
+
+//Merges modules with identical structure (see getStructuralKey).
+//Instances of a duplicate are replaced to point at one representative module
+//and duplicates that are not generated are erased from their namespace.
+//Runs to a fixed point so parents of merged modules get merged as well.
+class DedupModules : public ContextPass {
+  public :
+    static std::string ID;
+    DedupModules() : ContextPass(ID,"Merges structurally identical modules") {}
+    bool runOnContext(Context* c) override;
+};
+
+}
+}
+#endif
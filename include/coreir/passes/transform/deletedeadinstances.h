@@ -13,6 +13,9 @@ namespace CoreIR {
     public:
       static std::string ID;
       DeleteDeadInstances() : ModulePass(ID, "Delete all instances with no outputs used") {}
+      void setAnalysisInfo() override {
+        setModuleParallel();
+      }
       bool runOnModule(Module* m) override;
     };
   }
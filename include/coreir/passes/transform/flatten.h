@@ -10,6 +10,10 @@ class Flatten : public InstanceGraphPass {
   public :
     static std::string ID;
     Flatten() : InstanceGraphPass(ID,"Flattens everything!") {}
+    void setAnalysisInfo() override {
+      //Each module inlines its own instances
+      levelParallel = true;
+    }
     bool runOnInstanceGraphNode(InstanceGraphNode& node);
 };
 
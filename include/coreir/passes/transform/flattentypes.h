@@ -11,6 +11,12 @@ class FlattenTypes : public InstanceGraphPass {
     static std::string ID;
     FlattenTypes() : InstanceGraphPass(ID,"Flattens the Type hierarchy to only bits or arrays of bits") {}
     bool runOnInstanceGraphNode(InstanceGraphNode& node) override;
+    void setAnalysisInfo() override {
+      //Only ports and connections change
+      addPreserved("createinstancegraph");
+      addPreserved("createfullinstancemap");
+      addPreserved("verifyflatcoreirprims");
+    }
 };
 
 }
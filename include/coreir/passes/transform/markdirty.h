@@ -9,7 +9,7 @@ namespace Passes {
 class MarkDirty : public ContextPass {
   public :
     static std::string ID;
-    MarkDirty() : ContextPass(ID,"Forces analysis passes to rerun") {}
+    MarkDirty() : ContextPass(ID,"Forces analysis passes to rerun and modules to be saved again") {}
     bool runOnContext(Context* c);
 };
 
@@ -14,6 +14,13 @@ class PackConnections : public ModulePass {
     static std::string ID;
     PackConnections() : ModulePass(ID, "Collapse bitwise connections into packed connections where possible") {}
     bool runOnModule(Module* m) override;
+    void setAnalysisInfo() override {
+      //Only connections change
+      addPreserved("createinstancegraph");
+      addPreserved("createfullinstancemap");
+      addPreserved("verifyflatcoreirprims");
+      addPreserved("verifyflattenedtypes");
+    }
 };
 
 }
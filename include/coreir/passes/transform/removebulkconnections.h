@@ -13,6 +13,14 @@ class RemoveBulkConnections : public ModulePass {
     
     RemoveBulkConnections() : ModulePass(ID,"Removes any bulk connections. Only connections will be bits and arrays of bits") {}
     bool runOnModule(Module* m) override;
+    void setAnalysisInfo() override {
+      setModuleParallel();
+      //Only connections change
+      addPreserved("createinstancegraph");
+      addPreserved("createfullinstancemap");
+      addPreserved("verifyflatcoreirprims");
+      addPreserved("verifyflattenedtypes");
+    }
 };
 
 }
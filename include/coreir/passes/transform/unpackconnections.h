@@ -20,6 +20,14 @@ class UnpackConnections : public ModulePass {
     static std::string ID;
     UnpackConnections() : ModulePass(ID, "Collapse bitwise connections into unpacked connections where possible") {}
     bool runOnModule(Module* m) override;
+    void setAnalysisInfo() override {
+      setModuleParallel();
+      //Only connections change
+      addPreserved("createinstancegraph");
+      addPreserved("createfullinstancemap");
+      addPreserved("verifyflatcoreirprims");
+      addPreserved("verifyflattenedtypes");
+    }
 };
 
 }
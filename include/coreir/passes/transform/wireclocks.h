@@ -13,6 +13,12 @@ class WireClocks : public InstanceGraphPass {
   public :
     WireClocks(std::string name, Type* clockType) : InstanceGraphPass(name, "Add a clock port to an instantiable if any of its instances contain an unwired clocked port. Also wires up the new clock port to the instances."), clockType(clockType) {}
     bool runOnInstanceGraphNode(InstanceGraphNode& node);
+    void setAnalysisInfo() override {
+      //Only ports and connections change
+      addPreserved("createinstancegraph");
+      addPreserved("createfullinstancemap");
+      addPreserved("verifyflatcoreirprims");
+    }
 };
 
 }
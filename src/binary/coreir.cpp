@@ -1,5 +1,6 @@
 #include "coreir.h"
 #include "coreir/tools/cxxopts.h"
+#include "coreir/ir/parallel.h"
 #include <fstream>
 #include <memory>
 #include "passlib.h"
@@ -34,8 +35,8 @@ int main(int argc, char *argv[]) {
   options.add_options()
     ("h,help","help")
     ("v,verbose","Set verbose")
-    ("i,input","input file: '<file1>.json,<file2.json,...'",cxxopts::value<std::string>())
-    ("o,output","output file: <file>.<json|fir|v|py|dot>",cxxopts::value<std::string>())
+    ("i,input","input file: '<file1>.<json|coreirb>,<file2.json,...'",cxxopts::value<std::string>())
+    ("o,output","output file: <file>.<json|coreirb|fir|v|py|dot>",cxxopts::value<std::string>())
     ("p,passes","Run passes in order: '<pass1> <pass1args>;<pass2> <pass2args>;...'",cxxopts::value<std::string>())
     ("e,load_passes","external passes: '<path1.so>,<path2.so>,<path3.so>,...'",cxxopts::value<std::string>())
     ("l,load_libs","external libs: '<libname0>,<path/libname1.so>,<libname2>,...'",cxxopts::value<std::string>())
@@ -45,6 +46,13 @@ int main(int argc, char *argv[]) {
     ("z,inline","inlines verilog primitives")
     ("y,verilator_debug","mark signals with /*veriltor public*/")
     ("s,split","splits output files by name (expects '-o <path>/*.<ext>')")
+    ("compact","write json output without whitespace")
+    ("lazy","only load json module definitions when they are used (always done for coreirb)")
+    ("link","link all the json inputs together (concurrent load, references in any order)")
+    ("j,threads","number of threads to use (default: 1, 0 for all hardware threads)",cxxopts::value<uint>())
+    ("passstats","print the time, memory and IR size of each pass")
+    ("passstats_json","write the time, memory and IR size of each pass as json to <file>",cxxopts::value<std::string>())
+    ("gencache","directory to cache generated module definitions in (default: $COREIR_GENERATOR_CACHE)",cxxopts::value<std::string>())
     ;
   
   //Do the parsing of the arguments
@@ -78,13 +86,26 @@ int main(int argc, char *argv[]) {
     c->getPassManager()->setVerbosity(opts["v"].as<bool>());
   }
 
+  if (opts.count("j")) {
+    uint threads = opts["j"].as<uint>();
+    c->setNumThreads(threads ? threads : getHardwareThreads());
+  }
+
+  if (opts.count("passstats") || opts.count("passstats_json")) {
+    c->getPassManager()->setInstrumented(true);
+  }
+
+  if (opts.count("gencache")) {
+    c->setGeneratorCacheDirectory(opts["gencache"].as<string>());
+  }
+
   ASSERT(opts.count("i"),"No input specified");
   string ilist = opts["i"].as<string>();
   vector<string> infileNames = splitString<vector<string>>(ilist,',');
 
   for (auto infileName : infileNames) {
     string inExt = getExt(infileName);
-    ASSERT(inExt=="json","Input needs to be json");
+    ASSERT(inExt=="json" || inExt=="coreirb","Input needs to be json or coreirb");
   }
 
   const bool split_files = opts.count("s") && opts["s"].as<bool>();
@@ -92,8 +113,11 @@ int main(int argc, char *argv[]) {
   //Load inputs
   Module* top;
   string topRef = "";
-  for (auto infileName : infileNames) {
-    if (!loadFromFile(c,infileName,&top)) {
+  if (opts.count("link")) {
+    for (auto infileName : infileNames) {
+      ASSERT(getExt(infileName)=="json","Only json inputs can be linked");
+    }
+    if (!linkFiles(c,infileNames,&top)) {
       c->die();
     }
     if (top) topRef = top->getRefName();
@@ -102,6 +126,19 @@ int main(int argc, char *argv[]) {
       c->setTop(topRef);
     }
   }
+  else {
+    for (auto infileName : infileNames) {
+      bool loaded = getExt(infileName)=="coreirb" ? loadFromBinaryFile(c,infileName,&top) : loadFromFile(c,infileName,&top,opts.count("lazy")>0);
+      if (!loaded) {
+        c->die();
+      }
+      if (top) topRef = top->getRefName();
+      if (opts.count("t")) {
+        topRef = opts["t"].as<string>();
+        c->setTop(topRef);
+      }
+    }
+  }
   
   vector<string> namespaces;
   if (opts.count("a")) {
@@ -126,19 +163,21 @@ int main(int argc, char *argv[]) {
   std::ostream* sout = &std::cout;
   std::string outExt = "json";
   std::string output_dir = "";
+  std::string outfile = "";
   auto parse_outputs = [&] {
-    std::string outfile = "";
     if (opts.count("o")) {
       outfile = opts["o"].as<string>();
       outExt = getExt(outfile);
       ASSERT(outExt == "json"
+             || outExt == "coreirb"
              || outExt == "txt"
              || outExt == "fir"
              || outExt == "py"
              || outExt == "smt2"
              || outExt == "smv"
              || outExt == "v", "Cannot support out extention: " + outExt);
-      if (!split_files) {
+      //The binary format is written to the file directly
+      if (!split_files && outExt != "coreirb") {
         std::unique_ptr<std::ofstream> fout(new std::ofstream(outfile));
         ASSERT(fout->is_open(),"Cannot open file: " + outfile);
         sout = fout.release();
@@ -167,7 +206,12 @@ int main(int argc, char *argv[]) {
     if (c->hasTop()) {
       topref = c->getTop()->getRefName();
     }
-    jpass->writeToStream(*sout,topref);
+    jpass->writeToStream(*sout,topref,opts.count("compact")>0);
+  }
+  else if (outExt=="coreirb") {
+    if (!saveToBinaryFile(c,outfile,namespaces)) {
+      c->die();
+    }
   }
   else if (outExt=="fir") {
     CoreIRLoadFirrtl_coreir(c);
@@ -230,6 +274,14 @@ int main(int argc, char *argv[]) {
     LOG(INFO) << "NYI";
   }
   LOG(INFO) << "Modified?: " << (modified ? "Yes" : "No");
+  if (opts.count("passstats")) {
+    c->getPassManager()->printPassStats(std::cerr);
+  }
+  if (opts.count("passstats_json")) {
+    std::ofstream fstats(opts["passstats_json"].as<string>());
+    ASSERT(fstats.is_open(),"Cannot open file: " + opts["passstats_json"].as<string>());
+    c->getPassManager()->writePassStatsJson(fstats);
+  }
 
   return 0;
 }
@@ -60,6 +60,12 @@ extern "C" {
   void COREDeleteContext(COREContext* c) {
     deleteContext(rcast<Context*>(c));
   }
+  void COREContextBeginScope(COREContext* context) {
+    rcast<Context*>(context)->beginScope();
+  }
+  void COREContextEndScope(COREContext* context) {
+    rcast<Context*>(context)->endScope();
+  }
 
   COREType* COREContextNamed(COREContext* context, const char* namespace_, const char* type_name) {
       return rcast<COREType*>(rcast<Context*>(context)->Named(std::string(namespace_)+"."+std::string(type_name)));
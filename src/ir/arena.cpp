@@ -0,0 +1,64 @@
+#include "coreir/ir/arena.h"
+#include <cstdlib>
+
+using namespace std;
+
+namespace CoreIR {
+
+namespace {
+inline size_t alignUp(size_t n, size_t align) {
+  return (n + align - 1) & ~(align - 1);
+}
+}
+
+void Arena::newSlab(size_t minSize) {
+  size_t size = nextSlabSize;
+  while (size < minSize) size <<= 1;
+  if (nextSlabSize < maxSlabSize) nextSlabSize <<= 1;
+  void* slab = malloc(size);
+  ASSERT(slab,"Arena could not allocate a slab of " + to_string(size) + " bytes");
+  slabs.push_back(slab);
+  cur = static_cast<char*>(slab);
+  end = cur + size;
+  bytesReserved += size;
+}
+
+void* Arena::allocate(size_t size) {
+  size = alignUp(size ? size : 1,alignment);
+  auto fl = freeLists.find(size);
+  if (fl != freeLists.end() && fl->second) {
+    void* block = fl->second;
+    fl->second = *static_cast<void**>(block);
+    bytesUsed += size;
+    return block;
+  }
+  if (static_cast<size_t>(end - cur) < size) {
+    newSlab(size);
+  }
+  void* block = cur;
+  cur += size;
+  bytesUsed += size;
+  return block;
+}
+
+void Arena::deallocate(void* p, size_t size) {
+  if (!p) return;
+  size = alignUp(size ? size : 1,alignment);
+  void*& head = freeLists[size];
+  *static_cast<void**>(p) = head;
+  head = p;
+  bytesUsed -= size;
+}
+
+void Arena::reset() {
+  for (auto slab : slabs) free(slab);
+  slabs.clear();
+  freeLists.clear();
+  cur = nullptr;
+  end = nullptr;
+  nextSlabSize = minSlabSize;
+  bytesReserved = 0;
+  bytesUsed = 0;
+}
+
+}//CoreIR namespace
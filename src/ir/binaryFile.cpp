@@ -0,0 +1,903 @@
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include "coreir/ir/context.h"
+#include "coreir/ir/namespace.h"
+#include "coreir/ir/types.h"
+#include "coreir/ir/typegen.h"
+#include "coreir/ir/common.h"
+#include "coreir/ir/error.h"
+#include "coreir/ir/generator.h"
+#include "coreir/ir/module.h"
+#include "coreir/ir/moduledef.h"
+#include "coreir/ir/wireable.h"
+#include "coreir/ir/value.h"
+#include "coreir/ir/valuetype.h"
+#include "coreir/ir/dynamic_bit_vector.h"
+#include "coreir/ir/mappedfile.h"
+
+using namespace std;
+
+//Binary (.coreirb) serialization of a Context.
+//
+//All integers are stored in host byte order (checked with a byte order mark).
+//Strings, types and instanced modules are written once into tables and
+//referenced by index everywhere else. The global sections are ordered by the
+//phase in which they are loaded (namespaces, typegens, declarations, then the
+//default args/metadata/generated modules) so loading is a single forward scan.
+//Every module definition is a self contained record in the defs section that
+//is only decoded when Module::getDef is first called on it.
+//
+//  header   : magic[8] version bom top reserved, u64 offset of each section
+//  strings  : count, (offset,length) per string, then the characters
+//  types    : count, types in post order (children before parents)
+//  modrefs  : count, modules referenced by instances
+//  namespaces, typegens, decls, attrs, defs
+
+namespace CoreIR {
+
+namespace {
+
+const char magic[8] = {'C','O','R','E','I','R','B','\0'};
+const uint32_t version = 1;
+const uint32_t byteOrderMark = 0x01020304;
+const uint32_t none = 0xFFFFFFFF;
+//Connection paths: head index of the interface, and flag for array selects
+const uint32_t selfIdx = 0xFFFFFFFF;
+const uint32_t indexFlag = 0x80000000;
+
+enum Section {S_Strings,S_Types,S_ModRefs,S_Namespaces,S_TypeGens,S_Decls,S_Attrs,S_Defs,S_Count};
+enum TypeTag {TT_Bit,TT_BitIn,TT_BitInOut,TT_Array,TT_Record,TT_Named};
+const size_t headerSize = sizeof(magic) + 4*sizeof(uint32_t) + S_Count*sizeof(uint64_t);
+
+#define ASSERTTHROW(cond,msg) \
+  do { \
+    if (!(cond)) { \
+      throw std::runtime_error(msg); \
+    } \
+  } while (0)
+
+class ByteWriter {
+  string buf;
+  public :
+    template<typename T>
+    void put(T v) { buf.append(reinterpret_cast<const char*>(&v),sizeof(T)); }
+    void u8(uint8_t v) { put(v); }
+    void u32(uint32_t v) { put(v); }
+    void u64(uint64_t v) { put(v); }
+    void bytes(const string& s) { buf.append(s); }
+    size_t size() const { return buf.size(); }
+    const string& str() const { return buf; }
+};
+
+class ByteReader {
+  const char* p;
+  const char* end;
+  public :
+    ByteReader(const char* p, const char* end) : p(p), end(end) {}
+    template<typename T>
+    T get() {
+      ASSERTTHROW(end - p >= (ptrdiff_t) sizeof(T),"Unexpected end of binary file");
+      T v;
+      memcpy(&v,p,sizeof(T));
+      p += sizeof(T);
+      return v;
+    }
+    uint8_t u8() { return get<uint8_t>(); }
+    uint32_t u32() { return get<uint32_t>(); }
+    uint64_t u64() { return get<uint64_t>(); }
+    const char* pos() const { return p; }
+};
+
+class BinaryWriter {
+  unordered_map<string,uint32_t> stringIdx;
+  vector<const string*> strings;
+  unordered_map<Type*,uint32_t> typeIdx;
+  ByteWriter types;
+  unordered_map<Module*,uint32_t> modrefIdx;
+  ByteWriter modrefs;
+  public :
+    ByteWriter sections[S_Count];
+
+    uint32_t str(const string& s) {
+      auto it = stringIdx.find(s);
+      if (it != stringIdx.end()) return it->second;
+      uint32_t idx = strings.size();
+      auto res = stringIdx.emplace(s,idx);
+      strings.push_back(&res.first->first);
+      return idx;
+    }
+
+    uint32_t type(Type* t) {
+      auto it = typeIdx.find(t);
+      if (it != typeIdx.end()) return it->second;
+      ByteWriter b;
+      switch(t->getKind()) {
+        case Type::TK_Bit : b.u8(TT_Bit); break;
+        case Type::TK_BitIn : b.u8(TT_BitIn); break;
+        case Type::TK_BitInOut : b.u8(TT_BitInOut); break;
+        case Type::TK_Array : {
+          auto at = cast<ArrayType>(t);
+          uint32_t elem = type(at->getElemType());
+          b.u8(TT_Array);
+          b.u32(at->getLen());
+          b.u32(elem);
+          break;
+        }
+        case Type::TK_Record : {
+          auto rt = cast<RecordType>(t);
+          vector<pair<uint32_t,uint32_t>> fields;
+          for (auto& field : rt->getFields()) {
+            fields.push_back({str(field),type(rt->getRecord().at(field))});
+          }
+          b.u8(TT_Record);
+          b.u32(fields.size());
+          for (auto& f : fields) {
+            b.u32(f.first);
+            b.u32(f.second);
+          }
+          break;
+        }
+        case Type::TK_Named : {
+          auto nt = cast<NamedType>(t);
+          b.u8(TT_Named);
+          b.u32(str(nt->getRefName()));
+          break;
+        }
+        default : ASSERT(0,"Cannot save type " + t->toString());
+      }
+      uint32_t idx = typeIdx.size();
+      typeIdx[t] = idx;
+      types.bytes(b.str());
+      return idx;
+    }
+
+    void valueType(ByteWriter& b, ValueType* vt) {
+      b.u8(vt->getKind());
+      if (auto bvt = dyn_cast<BitVectorType>(vt)) {
+        b.u32(bvt->getWidth());
+      }
+    }
+
+    void params(ByteWriter& b, const Params& ps) {
+      b.u32(ps.size());
+      for (auto& p : ps) {
+        b.u32(str(p.first));
+        valueType(b,p.second);
+      }
+    }
+
+    void module(ByteWriter& b, Module* m) {
+      if (m->isGenerated()) {
+        b.u8(1);
+        b.u32(str(m->getGenerator()->getRefName()));
+        values(b,m->getGenArgs());
+      }
+      else {
+        b.u8(0);
+        b.u32(str(m->getRefName()));
+      }
+    }
+
+    void value(ByteWriter& b, Value* v) {
+      valueType(b,v->getValueType());
+      if (auto a = dyn_cast<Arg>(v)) {
+        b.u8(1);
+        b.u32(str(a->getField()));
+        return;
+      }
+      b.u8(0);
+      Const* con = cast<Const>(v);
+      if (auto cb = dyn_cast<ConstBool>(con)) b.u8(cb->get());
+      else if (auto ci = dyn_cast<ConstInt>(con)) b.u32(ci->get());
+      else if (auto cbv = dyn_cast<ConstBitVector>(con)) b.u32(str(cbv->get().hex_string()));
+      else if (auto cs = dyn_cast<ConstString>(con)) b.u32(str(cs->get()));
+      else if (auto ct = dyn_cast<ConstCoreIRType>(con)) b.u32(type(ct->get()));
+      else if (auto cm = dyn_cast<ConstModule>(con)) module(b,cm->get());
+      else if (auto cj = dyn_cast<ConstJson>(con)) b.u32(str(toString(cj->get())));
+      else ASSERT(0,"Cannot save value " + v->toString());
+    }
+
+    void values(ByteWriter& b, const Values& vs) {
+      b.u32(vs.size());
+      for (auto& v : vs) {
+        b.u32(str(v.first));
+        value(b,v.second);
+      }
+    }
+
+    void metadata(ByteWriter& b, MetaData* md) {
+      b.u32(md->hasMetaData() ? str(toString(md->getMetaData())) : none);
+    }
+
+    uint32_t modref(Module* m) {
+      auto it = modrefIdx.find(m);
+      if (it != modrefIdx.end()) return it->second;
+      ByteWriter b;
+      module(b,m);
+      modrefs.bytes(b.str());
+      uint32_t idx = modrefIdx.size();
+      modrefIdx[m] = idx;
+      return idx;
+    }
+
+    void path(ByteWriter& b, Wireable* w, const unordered_map<Instance*,uint32_t>& instIdx) {
+      vector<uint32_t> elems;
+      while (auto s = dyn_cast<Select>(w)) {
+        Wireable* parent = s->getParent();
+        if (isa<ArrayType>(parent->getType())) {
+          elems.push_back(indexFlag | (uint32_t) stoul(s->getSelStr()));
+        }
+        else {
+          elems.push_back(str(s->getSelStr()));
+        }
+        w = parent;
+      }
+      b.u32(isa<Instance>(w) ? instIdx.at(cast<Instance>(w)) : selfIdx);
+      b.u32(elems.size());
+      for (auto it = elems.rbegin(); it != elems.rend(); ++it) b.u32(*it);
+    }
+
+    //Writes the def of m into the defs section and the reference to it into b
+    void def(ByteWriter& b, Module* m) {
+      if (!m->hasDef()) {
+        b.u8(0);
+        return;
+      }
+      b.u8(1);
+      ByteWriter& d = sections[S_Defs];
+      b.u64(d.size());
+      ModuleDef* mdef = m->getDef();
+      unordered_map<Instance*,uint32_t> instIdx;
+      d.u32(mdef->getInstances().size());
+      for (auto inst = mdef->getInstancesIterBegin(); inst != mdef->getInstancesIterEnd(); inst = mdef->getInstancesIterNext(inst)) {
+        uint32_t idx = instIdx.size();
+        instIdx[inst] = idx;
+        d.u32(str(inst->getInstname()));
+        d.u32(modref(inst->getModuleRef()));
+        values(d,inst->getModArgs());
+        metadata(d,inst);
+      }
+      auto cons = mdef->getSortedConnections();
+      d.u32(cons.size());
+      for (auto& con : cons) {
+        path(d,con.first,instIdx);
+        path(d,con.second,instIdx);
+        if (mdef->hasMetaData(con.first,con.second)) {
+          d.u32(str(toString(mdef->getMetaData(con.first,con.second))));
+        }
+        else {
+          d.u32(none);
+        }
+      }
+    }
+
+    void addNamespace(Namespace* ns) {
+      sections[S_Namespaces].u32(str(ns->getName()));
+    }
+
+    void addTypeGen(TypeGen* tg) {
+      ByteWriter& b = sections[S_TypeGens];
+      b.u32(str(tg->getNamespace()->getName()));
+      b.u32(str(tg->getName()));
+      params(b,tg->getParams());
+      auto& cached = tg->getCached();
+      b.u8(cached.empty() ? 0 : 1);
+      if (!cached.empty()) {
+        b.u32(cached.size());
+        for (auto& vt : cached) {
+          values(b,vt.first);
+          b.u32(type(vt.second));
+        }
+      }
+    }
+
+    void addModule(Module* m) {
+      ByteWriter& b = sections[S_Decls];
+      b.u32(str(m->getNamespace()->getName()));
+      b.u32(str(m->getName()));
+      b.u32(type(m->getType()));
+      params(b,m->getModParams());
+      ByteWriter& a = sections[S_Attrs];
+      values(a,m->getDefaultModArgs());
+      metadata(a,m);
+      def(a,m);
+    }
+
+    void addGenerator(Generator* g) {
+      ByteWriter& b = sections[S_Decls];
+      b.u32(str(g->getNamespace()->getName()));
+      b.u32(str(g->getName()));
+      b.u32(str(g->getTypeGen()->getRefName()));
+      params(b,g->getGenParams());
+      ByteWriter& a = sections[S_Attrs];
+      values(a,g->getDefaultGenArgs());
+      metadata(a,g);
+      auto genmods = g->getGeneratedModules();
+      a.u32(genmods.size());
+      for (auto& gm : genmods) {
+        Module* m = gm.second;
+        values(a,m->getGenArgs());
+        a.u32(type(m->getType()));
+        metadata(a,m);
+        def(a,m);
+      }
+    }
+
+    void write(std::ostream& os, Module* top) {
+      uint32_t topIdx = top ? modref(top) : none;
+
+      //Tables are only complete once everything else has been encoded
+      ByteWriter& s = sections[S_Strings];
+      s.u32(strings.size());
+      uint32_t offset = 0;
+      for (auto sp : strings) {
+        s.u32(offset);
+        s.u32(sp->size());
+        offset += sp->size();
+      }
+      for (auto sp : strings) s.bytes(*sp);
+      ByteWriter& t = sections[S_Types];
+      t.u32(typeIdx.size());
+      t.bytes(types.str());
+      ByteWriter& r = sections[S_ModRefs];
+      r.u32(modrefIdx.size());
+      r.bytes(modrefs.str());
+
+      ByteWriter h;
+      h.bytes(string(magic,sizeof(magic)));
+      h.u32(version);
+      h.u32(byteOrderMark);
+      h.u32(topIdx);
+      h.u32(0);
+      uint64_t pos = headerSize;
+      for (uint i=0; i<S_Count; ++i) {
+        h.u64(pos);
+        pos += sections[i].size();
+      }
+      assert(h.size()==headerSize);
+      os.write(h.str().data(),h.size());
+      for (uint i=0; i<S_Count; ++i) {
+        os.write(sections[i].str().data(),sections[i].size());
+      }
+    }
+};
+
+//Reading side. Shared by every lazy definition loaded from the same file,
+//which keeps the file mapped until the last of them is gone.
+class BinaryFile {
+  Context* c;
+  string filename;
+  MappedFile file;
+  const char* sections[S_Count+1];
+  const char* stringEntries = nullptr;
+  const char* stringChars = nullptr;
+  uint32_t numStrings = 0;
+  vector<Type*> types;
+  vector<const char*> modrefs;
+
+  public :
+    uint32_t top = none;
+
+    BinaryFile(Context* c, const string& filename) : c(c), filename(filename), file(filename) {}
+    bool isOpen() const { return file.isOpen(); }
+
+    ByteReader section(Section s) {
+      return ByteReader(sections[s],sections[s+1]);
+    }
+
+    void open() {
+      ByteReader h(file.begin(),file.end());
+      ASSERTTHROW(file.getSize() >= headerSize && memcmp(file.begin(),magic,sizeof(magic))==0,"Not a coreir binary file");
+      for (uint i=0; i<sizeof(magic); ++i) h.u8();
+      uint32_t fileVersion = h.u32();
+      ASSERTTHROW(fileVersion==version,"Unsupported coreir binary version " + to_string(fileVersion) + " (expected " + to_string(version) + ")");
+      ASSERTTHROW(h.u32()==byteOrderMark,"coreir binary file was written with a different byte order");
+      top = h.u32();
+      h.u32();
+      for (uint i=0; i<S_Count; ++i) {
+        uint64_t offset = h.u64();
+        ASSERTTHROW(offset >= headerSize && offset <= file.getSize(),"Corrupt coreir binary file");
+        sections[i] = file.begin() + offset;
+        ASSERTTHROW(i==0 || sections[i] >= sections[i-1],"Corrupt coreir binary file");
+      }
+      sections[S_Count] = file.end();
+
+      ByteReader s = section(S_Strings);
+      numStrings = s.u32();
+      stringEntries = s.pos();
+      ASSERTTHROW((uint64_t) numStrings*8 <= (uint64_t) (sections[S_Types] - stringEntries),"Corrupt string table");
+      stringChars = stringEntries + (uint64_t) numStrings*8;
+
+      ByteReader t = section(S_Types);
+      uint32_t numTypes = t.u32();
+      types.reserve(numTypes);
+      for (uint32_t i=0; i<numTypes; ++i) types.push_back(readTypeEntry(t));
+
+      //Only the positions of the modrefs are kept. They are resolved by name
+      //when a def is loaded so that they see the current state of the context
+      ByteReader r = section(S_ModRefs);
+      uint32_t numModRefs = r.u32();
+      modrefs.reserve(numModRefs);
+      for (uint32_t i=0; i<numModRefs; ++i) {
+        modrefs.push_back(r.pos());
+        skipModule(r);
+      }
+    }
+
+    string str(uint32_t idx) {
+      ASSERTTHROW(idx < numStrings,"Bad string index " + to_string(idx));
+      uint32_t entry[2];
+      memcpy(entry,stringEntries + (uint64_t) idx*8,sizeof(entry));
+      ASSERTTHROW((uint64_t) entry[0] + entry[1] <= (uint64_t) (sections[S_Types] - stringChars),"Corrupt string table");
+      return string(stringChars + entry[0],entry[1]);
+    }
+    string str(ByteReader& b) { return str(b.u32()); }
+
+    Type* type(uint32_t idx) {
+      ASSERTTHROW(idx < types.size(),"Bad type index " + to_string(idx));
+      return types[idx];
+    }
+    Type* type(ByteReader& b) { return type(b.u32()); }
+
+    Type* readTypeEntry(ByteReader& b) {
+      uint8_t tag = b.u8();
+      switch(tag) {
+        case TT_Bit : return c->Bit();
+        case TT_BitIn : return c->BitIn();
+        case TT_BitInOut : return c->BitInOut();
+        case TT_Array : {
+          uint32_t len = b.u32();
+          return c->Array(len,type(b));
+        }
+        case TT_Record : {
+          RecordParams rparams;
+          uint32_t n = b.u32();
+          for (uint32_t i=0; i<n; ++i) {
+            string field = str(b);
+            rparams.push_back({field,type(b)});
+          }
+          return c->Record(rparams);
+        }
+        case TT_Named : return c->Named(str(b));
+        default : ASSERTTHROW(0,"Bad type tag " + to_string(tag));
+      }
+      return nullptr;
+    }
+
+    ValueType* valueType(ByteReader& b) {
+      uint8_t kind = b.u8();
+      switch(kind) {
+        case ValueType::VTK_Bool : return c->Bool();
+        case ValueType::VTK_Int : return c->Int();
+        case ValueType::VTK_BitVector : return c->BitVector(b.u32());
+        case ValueType::VTK_String : return c->String();
+        case ValueType::VTK_CoreIRType : return CoreIRType::make(c);
+        case ValueType::VTK_Module : return ModuleType::make(c);
+        case ValueType::VTK_Json : return JsonType::make(c);
+        case ValueType::VTK_Any : return AnyType::make(c);
+        default : ASSERTTHROW(0,"Bad value type " + to_string(kind));
+      }
+      return nullptr;
+    }
+
+    Params params(ByteReader& b) {
+      Params ps;
+      uint32_t n = b.u32();
+      for (uint32_t i=0; i<n; ++i) {
+        string name = str(b);
+        ps[name] = valueType(b);
+      }
+      return ps;
+    }
+
+    Module* module(ByteReader& b) {
+      bool isGen = b.u8();
+      string ref = str(b);
+      if (isGen) {
+        ASSERTTHROW(c->hasGenerator(ref),"Missing Generator Symbol: " + ref);
+        Generator* g = c->getGenerator(ref);
+        return g->getModule(values(b));
+      }
+      ASSERTTHROW(c->hasModule(ref),"Missing Module Symbol: " + ref);
+      return c->getModule(ref);
+    }
+
+    void skipModule(ByteReader& b) {
+      bool isGen = b.u8();
+      b.u32();
+      if (isGen) skipValues(b);
+    }
+
+    //Arg values are resolved in argModule
+    Value* value(ByteReader& b, Module* argModule) {
+      ValueType* vt = valueType(b);
+      if (b.u8()) {
+        string field = str(b);
+        ASSERTTHROW(argModule,"Can only use 'Arg' reference in modargs");
+        return argModule->getArg(field);
+      }
+      switch(vt->getKind()) {
+        case ValueType::VTK_Bool : return Const::make(c,(bool) b.u8());
+        case ValueType::VTK_Int : return Const::make(c,(int) b.u32());
+        case ValueType::VTK_BitVector : return Const::make(c,BitVector(str(b)));
+        case ValueType::VTK_String : return Const::make(c,str(b));
+        case ValueType::VTK_CoreIRType : return Const::make(c,type(b));
+        case ValueType::VTK_Module : return Const::make(c,module(b));
+        case ValueType::VTK_Json : return Const::make(c,json::parse(str(b)));
+        default : ASSERTTHROW(0,"Cannot have a Const of type" + vt->toString());
+      }
+      return nullptr;
+    }
+
+    void skipValues(ByteReader& b) {
+      uint32_t n = b.u32();
+      for (uint32_t i=0; i<n; ++i) {
+        b.u32();
+        uint8_t kind = b.u8();
+        if (kind==ValueType::VTK_BitVector) b.u32();
+        if (b.u8()) {
+          b.u32();
+          continue;
+        }
+        switch(kind) {
+          case ValueType::VTK_Bool : b.u8(); break;
+          case ValueType::VTK_Module : skipModule(b); break;
+          default : b.u32();
+        }
+      }
+    }
+
+    Values values(ByteReader& b, Module* argModule=nullptr) {
+      Values vs;
+      uint32_t n = b.u32();
+      for (uint32_t i=0; i<n; ++i) {
+        string name = str(b);
+        vs[name] = value(b,argModule);
+      }
+      return vs;
+    }
+
+    json metadata(ByteReader& b) {
+      uint32_t idx = b.u32();
+      if (idx==none) return json();
+      return json::parse(str(idx));
+    }
+
+    Module* modref(uint32_t idx) {
+      ASSERTTHROW(idx < modrefs.size(),"Bad module index " + to_string(idx));
+      ByteReader b(modrefs[idx],sections[S_Namespaces]);
+      return module(b);
+    }
+
+    Module* getTop() {
+      return top==none ? nullptr : modref(top);
+    }
+
+    Wireable* path(ByteReader& b, ModuleDef* mdef, const vector<Instance*>& insts) {
+      uint32_t head = b.u32();
+      Wireable* w;
+      if (head==selfIdx) {
+        w = mdef->getInterface();
+      }
+      else {
+        ASSERTTHROW(head < insts.size(),"Bad instance index " + to_string(head));
+        w = insts[head];
+      }
+      uint32_t len = b.u32();
+      for (uint32_t i=0; i<len; ++i) {
+        uint32_t elem = b.u32();
+        if (elem & indexFlag) {
+          uint32_t idx = elem & ~indexFlag;
+          ASSERTTHROW(w->canSel(idx),"Cannot select " + to_string(idx) + " from " + w->toString());
+          w = w->sel(idx);
+        }
+        else {
+          string selstr = str(elem);
+          ASSERTTHROW(w->canSel(selstr),"Cannot select " + selstr + " from " + w->toString());
+          w = w->sel(selstr);
+        }
+      }
+      return w;
+    }
+
+    void checkDefOffset(uint64_t offset) {
+      ASSERTTHROW(offset < (uint64_t) (sections[S_Count] - sections[S_Defs]),"Bad definition offset");
+    }
+
+    void loadDef(Module* m, uint64_t offset) {
+      checkDefOffset(offset);
+      ByteReader b(sections[S_Defs] + offset,sections[S_Count]);
+      ModuleDef* mdef = m->newModuleDef();
+      uint32_t numInsts = b.u32();
+      mdef->reserve(numInsts,0);
+      vector<Instance*> insts;
+      insts.reserve(numInsts);
+      //Most defs instance a few distinct modules many times
+      unordered_map<uint32_t,Module*> mods;
+      for (uint32_t i=0; i<numInsts; ++i) {
+        string instname = str(b);
+        uint32_t ref = b.u32();
+        auto it = mods.find(ref);
+        Module* modRef = it != mods.end() ? it->second : (mods[ref] = modref(ref));
+        Values modargs = values(b,m);
+        Instance* inst = mdef->addInstance(instname,modRef,modargs);
+        json md = metadata(b);
+        if (!md.is_null()) inst->setMetaData(md);
+        insts.push_back(inst);
+      }
+      uint32_t numCons = b.u32();
+      vector<Connection> cons;
+      cons.reserve(numCons);
+      vector<pair<size_t,json>> conMetaData;
+      for (uint32_t i=0; i<numCons; ++i) {
+        Wireable* a = path(b,mdef,insts);
+        Wireable* w = path(b,mdef,insts);
+        cons.push_back({a,w});
+        json md = metadata(b);
+        if (!md.is_null()) conMetaData.push_back({i,md});
+      }
+      mdef->reserve(0,numCons);
+      mdef->connectBulk(cons);
+      for (auto& cm : conMetaData) {
+        mdef->getMetaData(cons[cm.first].first,cons[cm.first].second) = cm.second;
+      }
+      m->setDef(mdef);
+    }
+
+    //For lazy definitions, which have no caller to return an error to. A
+    //module cannot be left without the def it claims, so the error is fatal
+    void loadDefOrDie(Module* m, uint64_t offset) {
+      try {
+        loadDef(m,offset);
+      } catch(std::exception& exc) {
+        Error e;
+        e.message("In file: " + filename);
+        e.message("Could not load definition of " + m->getRefName());
+        e.message(exc.what());
+        e.fatal();
+        c->error(e);
+      }
+    }
+};
+
+//Defs that are built as soon as everything is declared
+typedef vector<std::pair<Module*,uint64_t>> DefQueue;
+
+//Attaches the def record (if any) to m, or queues it when not lazy
+void attachDef(shared_ptr<BinaryFile> bf, ByteReader& b, Module* m, DefQueue* defqueue) {
+  bool hasDef = b.u8();
+  if (!hasDef) return;
+  uint64_t offset = b.u64();
+  bf->checkDefOffset(offset);
+  if (!m) return;
+  if (defqueue) {
+    defqueue->push_back({m,offset});
+    return;
+  }
+  m->setDefLoader([bf,offset](Module* m) {
+    bf->loadDefOrDie(m,offset);
+  });
+}
+
+}
+
+bool loadFromBinaryFile(Context* c, string filename, Module** top, bool lazy) {
+  shared_ptr<BinaryFile> bf = make_shared<BinaryFile>(c,filename);
+  if (!bf->isOpen()) {
+    Error e;
+    e.message("Cannot open file " + filename);
+    c->error(e);
+    return false;
+  }
+  //In lazy mode each def is only built when it is first requested
+  DefQueue eagerDefs;
+  DefQueue* defqueue = lazy ? nullptr : &eagerDefs;
+  try {
+    bf->open();
+
+    ByteReader bns = bf->section(S_Namespaces);
+    uint32_t numNamespaces = bns.u32();
+    for (uint32_t i=0; i<numNamespaces; ++i) {
+      string nsname = bf->str(bns);
+      if (!c->hasNamespace(nsname)) {
+        c->newNamespace(nsname);
+      }
+    }
+
+    ByteReader btg = bf->section(S_TypeGens);
+    uint32_t numTypeGens = btg.u32();
+    for (uint32_t i=0; i<numTypeGens; ++i) {
+      Namespace* ns = c->getNamespace(bf->str(btg));
+      string name = bf->str(btg);
+      Params tgparams = bf->params(btg);
+      TypeGen* tg = ns->hasTypeGen(name) ? ns->getTypeGen(name) : nullptr;
+      bool sparse = btg.u8();
+      if (!sparse) {
+        if (!tg) {
+          tg = TypeGenImplicit::make(ns,name,tgparams);
+          ns->addTypeGen(tg);
+        }
+        continue;
+      }
+      vector<std::pair<Values,Type*>> typeList;
+      uint32_t n = btg.u32();
+      for (uint32_t j=0; j<n; ++j) {
+        Values vals = bf->values(btg);
+        typeList.push_back({vals,bf->type(btg)});
+      }
+      if (tg) { //If already exists, just check for consistency
+        for (auto vtpair : typeList) {
+          ASSERTTHROW(tg->getType(vtpair.first)==vtpair.second,"Typegens are inconsistent... " + tg->toString());
+        }
+      }
+      else {
+        tg = TypeGenSparse::make(ns,name,tgparams,typeList);
+        ns->addTypeGen(tg);
+      }
+    }
+
+    //Declarations. Existing symbols are skipped (nullptr) like in loadFromFile
+    ByteReader bd = bf->section(S_Decls);
+    vector<Module*> modules;
+    uint32_t numModules = bd.u32();
+    for (uint32_t i=0; i<numModules; ++i) {
+      Namespace* ns = c->getNamespace(bf->str(bd));
+      string name = bf->str(bd);
+      Type* t = bf->type(bd);
+      Params modparams = bf->params(bd);
+      modules.push_back(ns->hasModule(name) ? nullptr : ns->newModuleDecl(name,t,modparams));
+    }
+    vector<Generator*> generators;
+    uint32_t numGenerators = bd.u32();
+    for (uint32_t i=0; i<numGenerators; ++i) {
+      Namespace* ns = c->getNamespace(bf->str(bd));
+      string name = bf->str(bd);
+      string typeGenName = bf->str(bd);
+      Params genparams = bf->params(bd);
+      if (ns->hasGenerator(name)) {
+        generators.push_back(nullptr);
+        continue;
+      }
+      ASSERTTHROW(c->hasTypeGen(typeGenName),"Missing typegen symbol " + typeGenName + " for generator " + name);
+      generators.push_back(ns->newGeneratorDecl(name,c->getTypeGen(typeGenName),genparams));
+    }
+
+    //Everything that can refer to other modules
+    ByteReader ba = bf->section(S_Attrs);
+    for (auto m : modules) {
+      if (!m) {
+        bf->skipValues(ba);
+        ba.u32();
+        attachDef(bf,ba,m,defqueue);
+        continue;
+      }
+      Values defaultModArgs = bf->values(ba,m);
+      if (!defaultModArgs.empty()) m->addDefaultModArgs(defaultModArgs);
+      json md = bf->metadata(ba);
+      if (!md.is_null()) m->setMetaData(md);
+      attachDef(bf,ba,m,defqueue);
+    }
+    for (auto g : generators) {
+      if (!g) {
+        bf->skipValues(ba);
+        ba.u32();
+        uint32_t numGenMods = ba.u32();
+        for (uint32_t j=0; j<numGenMods; ++j) {
+          bf->skipValues(ba);
+          ba.u32();
+          ba.u32();
+          attachDef(bf,ba,nullptr,defqueue);
+        }
+        continue;
+      }
+      Values defaultGenArgs = bf->values(ba);
+      if (!defaultGenArgs.empty()) g->addDefaultGenArgs(defaultGenArgs);
+      json md = bf->metadata(ba);
+      if (!md.is_null()) g->setMetaData(md);
+      uint32_t numGenMods = ba.u32();
+      for (uint32_t j=0; j<numGenMods; ++j) {
+        Values genargs = bf->values(ba);
+        Type* t = bf->type(ba);
+        //This will verify the correct type if typegen can generate the type
+        Module* m = g->getModule(genargs,t);
+        json gmd = bf->metadata(ba);
+        if (!gmd.is_null()) m->setMetaData(gmd);
+        //Generated modules which are already defined (by running the generator) keep that def
+        attachDef(bf,ba,m->hasDef() ? nullptr : m,defqueue);
+        }
+    }
+
+    for (auto& mdef : eagerDefs) {
+      bf->loadDef(mdef.first,mdef.second);
+    }
+
+    Module* topMod = bf->getTop();
+    if (topMod) {
+      c->setTop(topMod);
+    }
+    if (top) {
+      *top = topMod;
+    }
+  } catch(std::exception& exc) {
+    Error e;
+    e.message("In file: " + filename);
+    e.message(exc.what());
+    c->error(e);
+    return false;
+  }
+  return true;
+}
+
+bool saveToBinaryFile(Context* c, string filename, const vector<string>& namespaces) {
+  BinaryWriter w;
+  vector<Namespace*> nss;
+  for (auto& nsname : namespaces) {
+    ASSERT(c->hasNamespace(nsname),"Missing namespace " + nsname);
+    nss.push_back(c->getNamespace(nsname));
+  }
+  uint32_t numModules = 0, numGenerators = 0;
+  for (auto ns : nss) {
+    numModules += ns->getModules(false).size();
+    numGenerators += ns->getGenerators().size();
+  }
+  uint32_t numTypeGens = 0;
+  for (auto ns : nss) numTypeGens += ns->getTypeGens().size();
+
+  w.sections[S_Namespaces].u32(nss.size());
+  w.sections[S_TypeGens].u32(numTypeGens);
+  w.sections[S_Decls].u32(numModules);
+  for (auto ns : nss) {
+    w.addNamespace(ns);
+    for (auto& tg : ns->getTypeGens()) w.addTypeGen(tg.second);
+    for (auto& m : ns->getModules(false)) w.addModule(m.second);
+  }
+  w.sections[S_Decls].u32(numGenerators);
+  for (auto ns : nss) {
+    for (auto& g : ns->getGenerators()) w.addGenerator(g.second);
+  }
+
+  //Written next to the destination and moved in place so that a file which
+  //is still mapped by lazy definitions is never modified
+  string tmpname = filename + ".tmp";
+  {
+    std::ofstream file(tmpname,std::ios::binary);
+    if (!file.is_open()) {
+      Error e;
+      e.message("Cannot open file " + tmpname);
+      e.fatal();
+      c->error(e);
+      return false;
+    }
+    w.write(file,c->hasTop() ? c->getTop() : nullptr);
+    if (!file.good()) {
+      Error e;
+      e.message("Could not write " + tmpname);
+      e.fatal();
+      c->error(e);
+      return false;
+    }
+  }
+  if (rename(tmpname.c_str(),filename.c_str()) != 0) {
+    Error e;
+    e.message("Cannot move " + tmpname + " to " + filename);
+    e.fatal();
+    c->error(e);
+    return false;
+  }
+  return true;
+}
+
+bool saveToBinaryFile(Context* c, string filename, bool nocoreir) {
+  vector<string> nss;
+  for (auto nspair : c->getNamespaces()) {
+    if (!nocoreir || (nspair.first!="coreir" && nspair.first!="corebit")) {
+      nss.push_back(nspair.first);
+    }
+  }
+  return saveToBinaryFile(c,filename,nss);
+}
+
+#undef ASSERTTHROW
+
+}//CoreIR namespace
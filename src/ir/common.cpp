@@ -61,6 +61,15 @@ Connection connectionCtor(Wireable* a, Wireable* b) {
   }
 }
 
+Wireable* selCorresponding(Wireable* w, const unordered_map<Wireable*,Wireable*>& topMap) {
+  if (auto s = dyn_cast<Select>(w)) {
+    return selCorresponding(s->getParent(),topMap)->sel(s->getSelsym());
+  }
+  auto it = topMap.find(w);
+  ASSERT(it != topMap.end(),"No corresponding wireable for " + w->toString());
+  return it->second;
+}
+
 string toString(Params genparams, bool multi) {
   string ret = "(";
   vector<string> plist;
@@ -129,6 +138,14 @@ inline bool syntaxWN(char c) {
 }
 }
 
+bool isValidName(const std::string& str) {
+  if (str.empty() || !syntaxW(str[0])) return false;
+  for (uint i=1; i<str.length(); ++i) {
+    if (!syntaxWN(str[i])) return false;
+  }
+  return true;
+}
+
 static std::string regex_str("^[a-zA-Z_\\-\\$][a-zA-Z0-9_\\-\\$]*");
 void checkStringSyntax(std::string& str) {
   //static regex reg(regex_str, std::regex_constants::basic);
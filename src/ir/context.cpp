@@ -1,4 +1,6 @@
 #include "coreir/ir/context.h"
+#include <cstdlib>
+#include <functional>
 #include "coreir/ir/typecache.h"
 #include "coreir/ir/valuecache.h"
 #include "coreir/ir/passmanager.h"
@@ -14,6 +16,10 @@
 #include "coreir/ir/moduledef.h"
 #include "coreir/ir/common.h"
 #include "coreir/ir/coreirlib.h"
+#include "coreir/ir/interner.h"
+#include "coreir/ir/arena.h"
+#include "coreir/ir/parallel.h"
+#include "coreir/ir/instancegraph.h"
 
 using namespace std;
 
@@ -25,7 +31,11 @@ namespace CoreIR {
 #include "headers/mantle.hpp"
 
 
-Context::Context() : maxErrors(8) {
+Context::Context() : maxErrors(8), numThreads(1) {
+  interner = new StringInterner();
+  if (const char* dir = getenv("COREIR_GENERATOR_CACHE")) {
+    generatorCacheDirectory = dir;
+  }
   libmanager = new CoreIRLibrary(this);
   global = newNamespace("global");
   Namespace* pt = newNamespace("_");
@@ -59,11 +69,26 @@ Context::Context() : maxErrors(8) {
 
 }
 
+//Arena of an open scope plus the maps created in it, whose destructors
+//have to run before the arena is dropped
+struct Context::Scope {
+  Arena arena;
+  std::vector<std::function<void()>> destroys;
+  ~Scope() {
+    for (auto& destroy : destroys) destroy();
+  }
+};
+
 // Order of this matters
 Context::~Context() {
+  //Detached first so that deleting the modules does not update it one
+  //instance at a time
+  if (instanceGraph) instanceGraph->releaseMemory();
+  delete threadPool;
   delete pm;
   for (auto it : recordParamsList) delete it;
   for (auto it : paramsList) delete it;
+  for (auto it : valuesList) delete it;
   for (auto it : connectionPtrArrays) free(it);
   for (auto it : connectionArrays) free(it);
   for (auto it : wireableArrays) free(it);
@@ -74,11 +99,26 @@ Context::~Context() {
   for (auto it : directedInstancePtrArrays) free(it);
   for (auto it : valuePtrArrays) free(it);
   for (auto it : valueTypePtrArrays) free(it);
+  for (auto it : scopes) delete it;
 
   delete typecache;
   for (auto it : namespaces) delete it.second;
   delete valuecache;
   delete libmanager;
+  delete interner;
+}
+
+void Context::setNumThreads(uint n) {
+  numThreads = n ? n : 1;
+  if (threadPool && threadPool->getNumThreads() != numThreads) {
+    delete threadPool;
+    threadPool = nullptr;
+  }
+}
+
+ThreadPool* Context::getThreadPool() {
+  if (!threadPool) threadPool = new ThreadPool(numThreads);
+  return threadPool;
 }
 
 std::map<std::string,Namespace*> Context::getNamespaces() {
@@ -98,8 +138,13 @@ void Context::print() {
 }
 
 void Context::error(Error& e) { 
-  errors.push_back(e.msg);
-  if (e.isfatal || errors.size() >= maxErrors) die();
+  bool fatal;
+  {
+    std::lock_guard<std::mutex> lock(errorLock);
+    errors.push_back(e.msg);
+    fatal = e.isfatal || errors.size() >= maxErrors;
+  }
+  if (fatal) die();
 }
 void Context::printerrors() { 
   for (auto err : errors) cout << "ERROR: " << err << endl << endl;
@@ -322,88 +367,93 @@ TypeGen* Context::getTypeGen(string nameref) {
   return this->getNamespace(split[0])->getTypeGen(split[1]);
 }
 
+template<typename T>
+T* Context::newMap(vector<T*>& list) {
+  if (!scopes.empty()) {
+    Scope* scope = scopes.back();
+    T* map = scope->arena.create<T>();
+    scope->destroys.push_back([scope,map]() {scope->arena.destroy(map);});
+    return map;
+  }
+  T* map = new T();
+  list.push_back(map);
+  return map;
+}
+
 RecordParams* Context::newRecordParams() {
-  RecordParams* record_param = new RecordParams();
-  recordParamsList.push_back(record_param);
-  return record_param;
+  return newMap(recordParamsList);
 }
 
 Params* Context::newParams() {
-  Params* params = new Params();
-  paramsList.push_back(params);
-  return params;
+  return newMap(paramsList);
 }
 
 Values* Context::newValues() {
-  Values* vals = new Values();
-  valuesList.push_back(vals);
-  return vals;
+  return newMap(valuesList);
+}
+
+template<typename T>
+T* Context::newArray(vector<T*>& list, int size) {
+  if (!scopes.empty()) {
+    return static_cast<T*>(scopes.back()->arena.allocate(sizeof(T) * size));
+  }
+  T* arr = (T*) malloc(sizeof(T) * size);
+  list.push_back(arr);
+  return arr;
 }
 
 Value** Context::newValueArray(int size) {
-    Value** arr = (Value**) malloc(sizeof(Value*) * size);
-    valuePtrArrays.push_back(arr);
-    return arr;
+  return newArray(valuePtrArrays,size);
 }
 
 ValueType** Context::newValueTypeArray(int size) {
-    ValueType** arr = (ValueType**) malloc(sizeof(ValueType*) * size);
-    valueTypePtrArrays.push_back(arr);
-    return arr;
+  return newArray(valueTypePtrArrays,size);
 }
 
 Type** Context::newTypeArray(int size) {
-    Type** arr = (Type**) malloc(sizeof(Type*) * size);
-    typePtrArrays.push_back(arr);
-    return arr;
+  return newArray(typePtrArrays,size);
 }
 
 Connection* Context::newConnectionArray(int size) {
-  Connection* arr = (Connection*) malloc(sizeof(Connection) * size);
-  connectionArrays.push_back(arr);
-  return arr;
+  return newArray(connectionArrays,size);
 }
 
 Connection** Context::newConnectionPtrArray(int size) {
-  Connection** arr = (Connection**) malloc(sizeof(Connection*) * size);
-  connectionPtrArrays.push_back(arr);
-  return arr;
+  return newArray(connectionPtrArrays,size);
 }
 
 const char** Context::newConstStringArray(int size) {
-    const char** arr = (const char**) malloc(sizeof(const char*) * size);
-    constStringArrays.push_back(arr);
-    return arr;
+  return newArray(constStringArrays,size);
 }
 
 char** Context::newStringArray(int size) {
-    char** arr = (char**) malloc(sizeof(char*) * size);
-    stringArrays.push_back(arr);
-    return arr;
+  return newArray(stringArrays,size);
 }
 
 char* Context::newStringBuffer(int size) {
-    char* arr = (char*) malloc(sizeof(char) * size);
-    stringBuffers.push_back(arr);
-    return arr;
+  return newArray(stringBuffers,size);
 }
 
 Wireable** Context::newWireableArray(int size) {
-  Wireable** arr = (Wireable**) malloc(sizeof(Wireable*) * size);
-  wireableArrays.push_back(arr);
-  return arr;
+  return newArray(wireableArrays,size);
 }
 
 DirectedConnection** Context::newDirectedConnectionPtrArray(int size) {
-    DirectedConnection** arr = (DirectedConnection**) malloc(sizeof(DirectedConnection*) * size);
-    directedConnectionPtrArrays.push_back(arr);
-    return arr;
+  return newArray(directedConnectionPtrArrays,size);
 }
 
 DirectedInstance** Context::newDirectedInstancePtrArray(int size) {
-    DirectedInstance** arr = (DirectedInstance**) malloc(sizeof(DirectedInstance*) * size);
-    directedInstancePtrArrays.push_back(arr);
-    return arr;
+  return newArray(directedInstancePtrArrays,size);
+}
+
+void Context::beginScope() {
+  scopes.push_back(new Scope());
+}
+
+void Context::endScope() {
+  ASSERT(!scopes.empty(),"endScope called without a matching beginScope");
+  delete scopes.back();
+  scopes.pop_back();
 }
 
 
@@ -0,0 +1,271 @@
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cerrno>
+#include <set>
+#include <sys/stat.h>
+#include "coreir/ir/json.h"
+#include "coreir/ir/context.h"
+#include "coreir/ir/namespace.h"
+#include "coreir/ir/common.h"
+#include "coreir/ir/error.h"
+#include "coreir/ir/generator.h"
+#include "coreir/ir/module.h"
+#include "coreir/passes/analysis/coreirjson.h"
+
+using namespace std;
+using json = nlohmann::json;
+typedef map<string,json> jsonmap;
+
+//Directory version of a coreir json file. Each piece is a regular coreir json
+//file of its own namespace so that changing one module only rewrites its file.
+//
+//  index.json                   : top, and per namespace the names of the
+//                                 modules, the generators (with the number of
+//                                 generated modules) and if it has typegens
+//  <ns>/typegens.json
+//  <ns>/generators/<name>.json  : generator and all of its generated modules
+//  <ns>/modules/<name>.json
+
+namespace CoreIR {
+
+namespace {
+
+#define ASSERTTHROW(cond,msg) \
+  do { \
+    if (!(cond)) { \
+      throw std::runtime_error(msg); \
+    } \
+  } while (0)
+
+bool fileExists(const string& path) {
+  struct stat st;
+  return stat(path.c_str(),&st)==0;
+}
+
+string readFile(const string& path) {
+  std::ifstream file(path);
+  ASSERTTHROW(file.is_open(),"Cannot open file " + path);
+  return string((std::istreambuf_iterator<char>(file)),std::istreambuf_iterator<char>());
+}
+
+void makeDir(const string& path) {
+  if (mkdir(path.c_str(),0777)!=0) {
+    ASSERTTHROW(errno==EEXIST,"Cannot create directory " + path);
+  }
+}
+
+//Written next to the destination and moved in place so that a file which is
+//still mapped by lazy definitions is never modified
+void writeFile(const string& path, std::function<void(std::ostream&)> write) {
+  string tmpname = path + ".tmp";
+  {
+    std::ofstream file(tmpname);
+    ASSERTTHROW(file.is_open(),"Cannot open file " + tmpname);
+    write(file);
+    ASSERTTHROW(file.good(),"Could not write " + tmpname);
+  }
+  ASSERTTHROW(rename(tmpname.c_str(),path.c_str())==0,"Cannot move " + tmpname + " to " + path);
+}
+
+string typeGensPath(const string& dirname, const string& nsname) {
+  return dirname + "/" + nsname + "/typegens.json";
+}
+string generatorPath(const string& dirname, const string& nsname, const string& name) {
+  return dirname + "/" + nsname + "/generators/" + name + ".json";
+}
+string modulePath(const string& dirname, const string& nsname, const string& name) {
+  return dirname + "/" + nsname + "/modules/" + name + ".json";
+}
+
+//All the files that an index refers to
+set<string> indexFiles(const string& dirname, const json& jindex) {
+  set<string> files;
+  for (auto& jnsmap : jindex.at("namespaces").get<jsonmap>()) {
+    const string& nsname = jnsmap.first;
+    const json& jns = jnsmap.second;
+    if (jns.at("typegens").get<bool>()) {
+      files.insert(typeGensPath(dirname,nsname));
+    }
+    for (auto& jgen : jns.at("generators").get<jsonmap>()) {
+      files.insert(generatorPath(dirname,nsname,jgen.first));
+    }
+    for (auto& jmod : jns.at("modules")) {
+      files.insert(modulePath(dirname,nsname,jmod.get<string>()));
+    }
+  }
+  return files;
+}
+
+}//anonymous namespace
+
+bool saveToDirectory(Context* c, string dirname, bool nocoreir, bool incremental) {
+  string indexname = dirname + "/index.json";
+  try {
+    //What the directory held after it was last saved
+    json jold;
+    if (fileExists(indexname)) {
+      jold = json::parse(readFile(indexname));
+    }
+    else {
+      makeDir(dirname);
+    }
+    //The dirty flags are only relative to the directory they were cleared for
+    incremental = incremental && !jold.is_null() && c->getSyncedDirectory()==dirname;
+
+    vector<Namespace*> nss;
+    for (auto nspair : c->getNamespaces()) {
+      if (!nocoreir || (nspair.first!="coreir" && nspair.first!="corebit")) {
+        nss.push_back(nspair.second);
+      }
+    }
+
+    json jindex;
+    if (c->hasTop()) {
+      jindex["top"] = c->getTop()->getRefName();
+    }
+    jindex["namespaces"] = json::object();
+    for (auto ns : nss) {
+      string nsname = ns->getName();
+      makeDir(dirname + "/" + nsname);
+      makeDir(dirname + "/" + nsname + "/generators");
+      makeDir(dirname + "/" + nsname + "/modules");
+      json jns;
+
+      //Typegens are small and have no dirty flag, so they are compared instead
+      jns["typegens"] = !ns->getTypeGens().empty();
+      if (!ns->getTypeGens().empty()) {
+        string path = typeGensPath(dirname,nsname);
+        std::ostringstream os;
+        Passes::CoreIRJson::writeTypeGensToStream(os,ns);
+        if (!incremental || !fileExists(path) || readFile(path)!=os.str()) {
+          writeFile(path,[&os](std::ostream& file) { file << os.str(); });
+        }
+      }
+
+      //A generator is rewritten when any generated module changed or when
+      //generated modules were erased
+      jns["generators"] = json::object();
+      for (auto& gpair : ns->getGenerators()) {
+        Generator* g = gpair.second;
+        string path = generatorPath(dirname,nsname,gpair.first);
+        auto genmods = g->getGeneratedModules();
+        jns["generators"][gpair.first] = genmods.size();
+        bool dirty = !incremental || !fileExists(path);
+        if (!dirty) {
+          auto jgens = jold.at("namespaces").find(nsname);
+          dirty = jgens==jold.at("namespaces").end() || jgens->at("generators").count(gpair.first)==0
+            || jgens->at("generators").at(gpair.first).get<size_t>()!=genmods.size();
+        }
+        for (auto& mpair : genmods) dirty |= mpair.second->isDirty();
+        if (dirty) {
+          writeFile(path,[g](std::ostream& file) { Passes::CoreIRJson::writeGlobalValueToStream(file,g); });
+        }
+      }
+
+      jns["modules"] = json::array();
+      for (auto& mpair : ns->getModules(false)) {
+        Module* m = mpair.second;
+        string path = modulePath(dirname,nsname,mpair.first);
+        jns["modules"].push_back(mpair.first);
+        if (incremental && !m->isDirty() && fileExists(path)) continue;
+        writeFile(path,[m](std::ostream& file) { Passes::CoreIRJson::writeGlobalValueToStream(file,m); });
+      }
+      jindex["namespaces"][nsname] = jns;
+    }
+
+    //Remove the files of everything that no longer exists
+    if (!jold.is_null()) {
+      set<string> files = indexFiles(dirname,jindex);
+      for (auto& path : indexFiles(dirname,jold)) {
+        if (!files.count(path)) std::remove(path.c_str());
+      }
+    }
+    writeFile(indexname,[&jindex](std::ostream& file) { file << jindex.dump(2) << endl; });
+  } catch(std::exception& exc) {
+    Error e;
+    e.message("In directory: " + dirname);
+    e.message(exc.what());
+    c->error(e);
+    return false;
+  }
+
+  //Everything in the saved namespaces now matches the directory
+  for (auto nspair : c->getNamespaces()) {
+    if (!nocoreir || (nspair.first!="coreir" && nspair.first!="corebit")) {
+      for (auto& mpair : nspair.second->getModules()) mpair.second->clearDirty();
+    }
+  }
+  c->setSyncedDirectory(dirname);
+  return true;
+}
+
+bool loadFromDirectory(Context* c, string dirname, Module** top, bool lazy) {
+  vector<Module*> loaded;
+  json jindex;
+  try {
+    jindex = json::parse(readFile(dirname + "/index.json"));
+    //Definitions refer to modules in other files, so each file is loaded
+    //lazily and definitions are only built once everything is declared.
+    //Typegens come before the generators that use them.
+    auto jnamespaces = jindex.at("namespaces").get<jsonmap>();
+    vector<string> files;
+    for (auto& jnsmap : jnamespaces) {
+      if (jnsmap.second.at("typegens").get<bool>()) {
+        files.push_back(typeGensPath(dirname,jnsmap.first));
+      }
+    }
+    for (auto& jnsmap : jnamespaces) {
+      for (auto& jgen : jnsmap.second.at("generators").get<jsonmap>()) {
+        files.push_back(generatorPath(dirname,jnsmap.first,jgen.first));
+      }
+    }
+    for (auto& jnsmap : jnamespaces) {
+      for (auto& jmod : jnsmap.second.at("modules")) {
+        files.push_back(modulePath(dirname,jnsmap.first,jmod.get<string>()));
+      }
+    }
+    for (auto& file : files) {
+      if (!loadFromFile(c,file,nullptr,true)) return false;
+    }
+
+    for (auto& jnsmap : jnamespaces) {
+      Namespace* ns = c->getNamespace(jnsmap.first);
+      for (auto& jgen : jnsmap.second.at("generators").get<jsonmap>()) {
+        for (auto& mpair : ns->getGenerator(jgen.first)->getGeneratedModules()) {
+          loaded.push_back(mpair.second);
+        }
+      }
+      for (auto& jmod : jnsmap.second.at("modules")) {
+        loaded.push_back(ns->getModule(jmod.get<string>()));
+      }
+    }
+  } catch(std::exception& exc) {
+    Error e;
+    e.message("In directory: " + dirname);
+    e.message(exc.what());
+    c->error(e);
+    return false;
+  }
+
+  if (!lazy) {
+    for (auto m : loaded) {
+      if (m->hasLazyDef()) m->getDef();
+    }
+  }
+  for (auto m : loaded) m->clearDirty();
+  c->setSyncedDirectory(dirname);
+
+  if (top && jindex.count("top")) {
+    *top = c->getModule(jindex.at("top").get<string>());
+    c->setTop(*top);
+  }
+  else if (top) {
+    *top = nullptr;
+  }
+  return true;
+}
+
+#undef ASSERTTHROW
+
+}//CoreIR namespace
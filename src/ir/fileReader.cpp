@@ -1,4 +1,6 @@
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 #include "coreir/ir/json.h"
 #include "coreir/ir/context.h"
 #include "coreir/ir/namespace.h"
@@ -12,6 +14,9 @@
 #include "coreir/ir/wireable.h"
 #include "coreir/ir/value.h"
 #include "coreir/ir/dynamic_bit_vector.h"
+#include "coreir/ir/mappedfile.h"
+#include "coreir/ir/parallel.h"
+#include "coreir/ir/generatorcache.h"
 
 using namespace std;
 
@@ -57,256 +62,648 @@ void checkJson(json j, set<string> optsRequired, set<string> optsOptional=set<st
   }
 }
 
-bool loadFromFile(Context* c, string filename,Module** top) {
-  std::fstream file;
-  file.open(filename);
-  if (!file.is_open()) {
-    Error e;
-    e.message("Cannot open file " + filename);
-    c->error(e);
-    return false;
+namespace {
+
+//Extent of a single json value within the file
+struct JsonSlice {
+  const char* b = nullptr;
+  const char* e = nullptr;
+  JsonSlice() {}
+  JsonSlice(const char* b, const char* e) : b(b), e(e) {}
+  bool empty() const { return b==e; }
+  json parse() const { return json::parse(b,e); }
+};
+
+//The skimmer only finds the extents of values (matching brackets and strings)
+//without building anything, so only the slices that are needed get parsed
+//into a json DOM, one small piece at a time.
+void skipWs(const char*& p, const char* end) {
+  while (p != end && (*p==' ' || *p=='\n' || *p=='\r' || *p=='\t')) ++p;
+}
+
+void skipString(const char*& p, const char* end) {
+  ASSERTTHROW(p != end && *p=='"',"Expected a json string");
+  for (++p; p != end; ++p) {
+    if (*p=='\\') {
+      if (++p == end) break;
+    }
+    else if (*p=='"') {
+      ++p;
+      return;
+    }
   }
-  json j;
+  throw std::runtime_error("Unterminated json string");
+}
 
-  try {
-    file >> j;
-    //There are the following dependencies moduleDefs->(all modules/generaors)->typegens->(all Types)->namespaces
-    //Therefore first load all namespaces
-    //Then load all namedtypes (No namedtypegens, only simple named types)
-    //Then Load all typegens
-    //Then Load all Modules and Generators
-    //Then Load all ModuleDefs
-
-    vector<std::pair<Namespace*,json>> nsqueue;
-    checkJson(j,{"namespaces"},{"top"});
-    for (auto jnsmap : j.at("namespaces").get<jsonmap>() ) {
-      string nsname = jnsmap.first;
-      checkJson(jnsmap.second,set<string>(),{"namedtypes","typegens","modules","generators"});
-      Namespace* ns;
-      if (c->hasNamespace(nsname) ) {
-        ns = c->getNamespace(nsname);
+JsonSlice skipValue(const char*& p, const char* end) {
+  skipWs(p,end);
+  ASSERTTHROW(p != end,"Unexpected end of json");
+  const char* b = p;
+  if (*p=='{' || *p=='[') {
+    //Closing brackets still expected, innermost last
+    string expected;
+    while (p != end) {
+      char ch = *p;
+      if (ch=='"') {
+        skipString(p,end);
+        continue;
       }
-      else {
-        ns = c->newNamespace(nsname);
+      ++p;
+      if (ch=='{') expected.push_back('}');
+      else if (ch=='[') expected.push_back(']');
+      else if (ch=='}' || ch==']') {
+        ASSERTTHROW(ch==expected.back(),string("Mismatched '") + ch + "' in json");
+        expected.pop_back();
+        if (expected.empty()) return JsonSlice(b,p);
       }
-      nsqueue.push_back({ns,jnsmap.second});
     }
+    throw std::runtime_error("Unexpected end of json");
+  }
+  if (*p=='"') {
+    skipString(p,end);
+    return JsonSlice(b,p);
+  }
+  while (p != end && !strchr(",:}] \n\r\t",*p)) ++p;
+  ASSERTTHROW(p != b,string("Unexpected character '") + *p + "' in json");
+  return JsonSlice(b,p);
+}
 
-    //create all namedtypes
-    for (auto jnsmap : j.at("namespaces").get<jsonmap>() ) {
-      string nsname = jnsmap.first;
-      json jns = jnsmap.second;
-      Namespace* ns = c->getNamespace(nsname);
-      
-      //TODO test out weird cases like Named(libA,Named(libB,Named(libA)))
-      if (jns.count("namedtypes")) {
-        for (auto jntype : jns.at("namedtypes").get<jsonmap>()) {
-          checkJson(jntype.second,{"flippedname","rawtype"});
-          string name = jntype.first;
-          string nameFlip = jntype.second.at("flippedname");
-          Type* raw = json2Type(c,jntype.second.at("rawtype"));
-          if (ns->hasNamedType(name)) {
-            //Verify it also has nameflip
-            NamedType* namedtype = ns->getNamedType(name);
-            ASSERT(raw==namedtype->getRaw(),"Wrong named type");
-            ASSERT(c->Flip(namedtype) == ns->getNamedType(nameFlip),"Missing the flip");
-          }
-          else {
-            ns->newNamedType(name,nameFlip,raw);
-          }
+string getString(JsonSlice s) {
+  ASSERTTHROW(!s.empty() && *s.b=='"',"Expected a json string");
+  if (std::find(s.b,s.e,'\\') == s.e) {
+    return string(s.b+1,s.e-1);
+  }
+  return s.parse().get<string>();
+}
+
+void forEachMember(JsonSlice s, std::function<void(const string&,JsonSlice)> f) {
+  const char* p = s.b;
+  skipWs(p,s.e);
+  ASSERTTHROW(p != s.e && *p=='{',"Expected a json object");
+  ++p;
+  skipWs(p,s.e);
+  if (p != s.e && *p=='}') return;
+  while (true) {
+    skipWs(p,s.e);
+    const char* kb = p;
+    skipString(p,s.e);
+    string key = getString(JsonSlice(kb,p));
+    skipWs(p,s.e);
+    ASSERTTHROW(p != s.e && *p==':',"Expected ':' after json key " + key);
+    ++p;
+    f(key,skipValue(p,s.e));
+    skipWs(p,s.e);
+    ASSERTTHROW(p != s.e,"Unexpected end of json");
+    if (*p=='}') return;
+    ASSERTTHROW(*p==',',"Expected ',' or '}' in json object");
+    ++p;
+  }
+}
+
+void forEachElement(JsonSlice s, std::function<void(JsonSlice)> f) {
+  const char* p = s.b;
+  skipWs(p,s.e);
+  ASSERTTHROW(p != s.e && *p=='[',"Expected a json array");
+  ++p;
+  skipWs(p,s.e);
+  if (p != s.e && *p==']') return;
+  while (true) {
+    f(skipValue(p,s.e));
+    skipWs(p,s.e);
+    ASSERTTHROW(p != s.e,"Unexpected end of json");
+    if (*p==']') return;
+    ASSERTTHROW(*p==',',"Expected ',' or ']' in json array");
+    ++p;
+  }
+}
+
+//Like checkJson, but on a skimmed object. Returns the slice of every member.
+map<string,JsonSlice> skimObject(JsonSlice s, set<string> optsRequired, set<string> optsOptional=set<string>()) {
+  map<string,JsonSlice> members;
+  forEachMember(s,[&](const string& key, JsonSlice val) {
+    ASSERTTHROW(optsRequired.count(key) || optsOptional.count(key),"Cannot put \"" + key + "\" here in json file");
+    members[key] = val;
+  });
+  for (auto req : optsRequired) {
+    ASSERTTHROW(members.count(req), "Missing " + req + " in json file");
+  }
+  return members;
+}
+
+//Declares a module (or checks the type of a generated one) from its skimmed members
+struct ModuleJson {
+  Module* m;
+  JsonSlice instances;
+  JsonSlice connections;
+};
+
+//A module definition parsed out of the file but not yet built in the context.
+//Parsing only reads the file, so different modules can be parsed concurrently.
+struct ParsedDef {
+  struct Inst {
+    string name;
+    json jinst;
+  };
+  struct Conn {
+    SelectPath a;
+    SelectPath b;
+    json metadata;
+  };
+  vector<Inst> instances;
+  vector<Conn> connections;
+};
+
+void parseModuleDef(const ModuleJson& mj, ParsedDef& pd) {
+  if (!mj.instances.empty()) {
+    //Like a json object, a repeated instance name keeps the last value
+    map<string,JsonSlice> jinstances;
+    forEachMember(mj.instances,[&](const string& instname, JsonSlice jinstslice) {
+      jinstances[instname] = jinstslice;
+    });
+    pd.instances.reserve(jinstances.size());
+    for (auto& jinstmap : jinstances) {
+      json jinst = jinstmap.second.parse();
+      checkJson(jinst,set<string>(),{"modref","genref","genargs","modargs","metadata",});
+      pd.instances.push_back({jinstmap.first,std::move(jinst)});
+    }
+  }
+
+  if (!mj.connections.empty()) {
+    forEachElement(mj.connections,[&](JsonSlice jconslice) {
+      vector<JsonSlice> jcon;
+      forEachElement(jconslice,[&](JsonSlice v) { jcon.push_back(v); });
+      ASSERTTHROW(jcon.size()==2 || jcon.size()==3,"Connection invalid");
+      pd.connections.push_back({
+        splitString<SelectPath>(getString(jcon[0]),'.'),
+        splitString<SelectPath>(getString(jcon[1]),'.'),
+        jcon.size()==3 ? jcon[2].parse() : json()
+      });
+    });
+  }
+}
+
+//Checks the layout of a definition the way parseModuleDef reads it, but
+//without parsing the values. Used for lazy definitions, so that a malformed
+//one is reported when the file is loaded rather than when it is requested.
+void skimModuleDef(const ModuleJson& mj) {
+  if (!mj.instances.empty()) {
+    forEachMember(mj.instances,[](const string& instname, JsonSlice jinst) {
+      skimObject(jinst,set<string>(),{"modref","genref","genargs","modargs","metadata"});
+    });
+  }
+  if (!mj.connections.empty()) {
+    forEachElement(mj.connections,[](JsonSlice jcon) {
+      uint n = 0;
+      forEachElement(jcon,[&](JsonSlice v) {
+        if (n++ < 2) getString(v);
+      });
+      ASSERTTHROW(n==2 || n==3,"Connection invalid");
+    });
+  }
+}
+
+//Like ModuleDef::sel, but throws if path does not exist
+Wireable* selPath(ModuleDef* mdef, const SelectPath& path) {
+  ASSERTTHROW(!path.empty(),"Empty select path");
+  Wireable* w;
+  if (path[0]=="self") {
+    w = mdef->getInterface();
+  }
+  else {
+    auto it = mdef->getInstances().find(path[0]);
+    ASSERTTHROW(it != mdef->getInstances().end(),"Cannot find instance " + path[0]);
+    w = it->second;
+  }
+  for (auto sel = std::next(path.begin()); sel != path.end(); ++sel) {
+    ASSERTTHROW(w->canSel(*sel),"Cannot select " + *sel + " from " + w->toString());
+    w = w->sel(*sel);
+  }
+  return w;
+}
+
+//Throws instead of asserting on anything in pd that ModuleDef would reject,
+//so that a bad definition never takes down the process
+void buildModuleDef(Context* c, Module* m, ParsedDef& pd) {
+  ModuleDef* mdef = m->newModuleDef();
+  mdef->reserve(pd.instances.size(),pd.connections.size());
+  for (auto& pinst : pd.instances) {
+    const string& instname = pinst.name;
+    json& jinst = pinst.jinst;
+    ASSERTTHROW(isValidName(instname) && instname!="self",instname + " is not a valid instance name");
+    // This function can throw an error
+    Instance* inst;
+    if (jinst.count("modref")) {
+      ASSERTTHROW(!jinst.count("genref") && !jinst.count("genargs"),"Instance " + instname + " has both a modref and a genref");
+      Module* modRef = getModSymbol(c,jinst.at("modref").get<string>());
+      Values modargs;
+      if (jinst.count("modargs")) {
+        modargs = json2Values(c,jinst.at("modargs"),modRef);
+      }
+      mergeValues(modargs,modRef->getDefaultModArgs());
+      ASSERTTHROW(doValuesMatchParams(modargs,modRef->getModParams()),"Bad modargs " + toString(modargs) + " for instance " + instname);
+      inst = mdef->addInstance(instname,modRef,modargs);
+    }
+    else if (jinst.count("genargs") && jinst.count("genref")) { // This is a generator
+      auto gref = getRef(jinst.at("genref").get<string>());
+      Generator* genRef = getGenSymbol(c,gref[0],gref[1]);
+      Values genargs = json2Values(c,jinst.at("genargs"));
+      mergeValues(genargs,genRef->getDefaultGenArgs());
+      ASSERTTHROW(doValuesMatchParams(genargs,genRef->getGenParams()),"Bad genargs " + toString(genargs) + " for instance " + instname);
+      Module* modRef = genRef->getModule(genargs);
+      Values modargs;
+      if (jinst.count("modargs")) {
+        modargs = json2Values(c,jinst.at("modargs"));
+      }
+      mergeValues(modargs,modRef->getDefaultModArgs());
+      ASSERTTHROW(doValuesMatchParams(modargs,modRef->getModParams()),"Bad modargs " + toString(modargs) + " for instance " + instname);
+      inst = mdef->addInstance(instname,modRef,modargs);
+    }
+    else {
+      ASSERTTHROW(0,"Bad Instance. Need (modref || (genref && genargs)) " + instname);
+    }
+    if (jinst.count("metadata")) {
+      inst->setMetaData(jinst["metadata"]);
+    }
+  }
+
+  //Connections
+  for (auto& pcon : pd.connections) {
+    Wireable* a = selPath(mdef,pcon.a);
+    Wireable* b = selPath(mdef,pcon.b);
+    ASSERTTHROW(a->getType()==c->Flip(b->getType()),"Cannot wire together " + a->toString() + " : " + a->getType()->toString() + " and " + b->toString() + " : " + b->getType()->toString());
+    ASSERTTHROW(!a->getConnectedWireables().count(b),"Duplicate connection " + a->toString() + " <=> " + b->toString());
+    mdef->connect(a,b);
+    if (!pcon.metadata.is_null()) {
+      mdef->getMetaData(a,b) = std::move(pcon.metadata);
+    }
+  }
+  
+  //Add Def back in
+  m->setDef(mdef);
+}
+
+//Top level of a file, skimmed for the extents of the namespaces
+struct FileJson {
+  map<string,JsonSlice> jtop;
+  map<string,map<string,JsonSlice>> jnamespaces;
+};
+
+//Skims the whole file once for its structure. Unbalanced or truncated json
+//is reported before the context is modified, but errors inside a type or
+//definition are only found when it is declared or built. Only reads the file.
+void skimFile(const MappedFile& file, FileJson& fj) {
+  const char* p = file.begin();
+  JsonSlice jfile = skipValue(p,file.end());
+  skipWs(p,file.end());
+  ASSERTTHROW(p==file.end(),"Unexpected trailing characters after json");
+  fj.jtop = skimObject(jfile,{"namespaces"},{"top"});
+  //Namespaces are loaded in name order
+  forEachMember(fj.jtop.at("namespaces"),[&](const string& nsname, JsonSlice jns) {
+    fj.jnamespaces[nsname] = skimObject(jns,set<string>(),{"namedtypes","typegens","modules","generators"});
+  });
+}
+
+//State shared by all the files that are linked together
+struct Linker {
+  struct Def {
+    string filename;
+    ModuleJson mj;
+  };
+  //Where the definition of each module comes from
+  map<Module*,Def> defs;
+  //Modules that were already defined before linking. They keep their
+  //definition, which is checked against the file once everything is declared
+  vector<Module*> predefined;
+  vector<string> problems;
+};
+
+bool sameDef(const ModuleJson& a, const ModuleJson& b) {
+  auto text = [](JsonSlice s) { return string(s.b,s.e); };
+  return text(a.instances)==text(b.instances) && text(a.connections)==text(b.connections);
+}
+
+//True if the definition m already has is the one in pd. Needs every symbol
+//pd refers to, and throws if one is missing.
+bool sameDef(Context* c, Module* m, const ParsedDef& pd) {
+  ModuleDef* def = m->getDef();
+  if (def->getInstances().size() != pd.instances.size()) return false;
+  for (auto& pinst : pd.instances) {
+    auto it = def->getInstances().find(pinst.name);
+    if (it==def->getInstances().end()) return false;
+    Instance* inst = it->second;
+    Module* modRef = inst->getModuleRef();
+    const json& jinst = pinst.jinst;
+    Values modargs;
+    if (jinst.count("modref")) {
+      if (modRef->isGenerated() || modRef->getRefName() != jinst.at("modref").get<string>()) return false;
+      if (jinst.count("modargs")) modargs = json2Values(c,jinst.at("modargs"),modRef);
+    }
+    else {
+      if (!modRef->isGenerated() || !jinst.count("genref") || !jinst.count("genargs")) return false;
+      if (modRef->getGenerator()->getRefName() != jinst.at("genref").get<string>()) return false;
+      Values genargs = json2Values(c,jinst.at("genargs"));
+      mergeValues(genargs,modRef->getGenerator()->getDefaultGenArgs());
+      if (toString(genargs) != toString(modRef->getGenArgs())) return false;
+      if (jinst.count("modargs")) modargs = json2Values(c,jinst.at("modargs"));
+    }
+    mergeValues(modargs,modRef->getDefaultModArgs());
+    if (toString(modargs) != toString(inst->getModArgs())) return false;
+  }
+  //Connections are unordered and either end can come first
+  auto key = [](string a, string b) { return a < b ? make_pair(a,b) : make_pair(b,a); };
+  set<pair<string,string>> cons, pcons;
+  for (auto& con : def->getConnections()) {
+    cons.insert(key(toString(con.first->getSelectPath()),toString(con.second->getSelectPath())));
+  }
+  for (auto& pcon : pd.connections) {
+    pcons.insert(key(toString(pcon.a),toString(pcon.b)));
+  }
+  return cons==pcons;
+}
+
+//Declares everything in the file and queues the modules that have
+//definitions. A single file skips symbols that already exist. When linking,
+//existing symbols are checked and may still get their definition from this
+//file, and conflicting definitions are recorded as problems.
+void declareFile(Context* c, const string& filename, FileJson& fj, vector<ModuleJson>& modqueue, Linker* linker=nullptr) {
+  //There are the following dependencies moduleDefs->(all modules/generaors)->typegens->(all Types)->namespaces
+  //Therefore first load all namespaces
+  //Then load all namedtypes (No namedtypegens, only simple named types)
+  //Then Load all typegens
+  //Then Load all Modules and Generators
+  //Then Load all ModuleDefs
+  auto& jnamespaces = fj.jnamespaces;
+  for (auto& jnsmap : jnamespaces) {
+    string nsname = jnsmap.first;
+    if (!c->hasNamespace(nsname) ) {
+      c->newNamespace(nsname);
+    }
+  }
+
+  //create all namedtypes
+  for (auto& jnsmap : jnamespaces) {
+    Namespace* ns = c->getNamespace(jnsmap.first);
+    auto& jns = jnsmap.second;
+    
+    //TODO test out weird cases like Named(libA,Named(libB,Named(libA)))
+    if (jns.count("namedtypes")) {
+      for (auto jntype : jns.at("namedtypes").parse().get<jsonmap>()) {
+        checkJson(jntype.second,{"flippedname","rawtype"});
+        string name = jntype.first;
+        string nameFlip = jntype.second.at("flippedname");
+        Type* raw = json2Type(c,jntype.second.at("rawtype"));
+        if (ns->hasNamedType(name)) {
+          //Verify it also has nameflip
+          NamedType* namedtype = ns->getNamedType(name);
+          ASSERT(raw==namedtype->getRaw(),"Wrong named type");
+          ASSERT(c->Flip(namedtype) == ns->getNamedType(nameFlip),"Missing the flip");
+        }
+        else {
+          ns->newNamedType(name,nameFlip,raw);
         }
       }
     }
+  }
 
-    //create all typegens
-    for (auto jnsmap : j.at("namespaces").get<jsonmap>() ) {
-      string nsname = jnsmap.first;
-      json jns = jnsmap.second;
-      Namespace* ns = c->getNamespace(nsname);
-      
-      //TODO this is a little sketch because if there is a symbol conflict, I just make sure they are consistent
-      //Really, it is possible that I want to concat multiple typegen lists together, ore handle duplicate symbols a different way
-      if (jns.count("typegens")) {
-        for (auto jtgpair : jns.at("typegens").get<jsonmap>()) {
-          string name = jtgpair.first;
-          //Get the typegen if it already exists
-          TypeGen* tg = ns->hasTypeGen(name) ? ns->getTypeGen(name) : nullptr;
-
-          jsonvector jtg = jtgpair.second.get<jsonvector>();
-          Params tgparams = json2Params(c,jtg[0]);
-          string tgkind = jtg[1].get<string>();
-          if (tgkind == "implicit") {
-            ASSERTTHROW(jtg.size()==2,"Bad implicit typegen format" + toString(jtg));
-            if (!tg) {
-              tg = TypeGenImplicit::make(ns,name,tgparams);
-              ns->addTypeGen(tg);
-            }
+  //create all typegens
+  for (auto& jnsmap : jnamespaces) {
+    Namespace* ns = c->getNamespace(jnsmap.first);
+    auto& jns = jnsmap.second;
+    
+    //TODO this is a little sketch because if there is a symbol conflict, I just make sure they are consistent
+    //Really, it is possible that I want to concat multiple typegen lists together, ore handle duplicate symbols a different way
+    if (jns.count("typegens")) {
+      for (auto jtgpair : jns.at("typegens").parse().get<jsonmap>()) {
+        string name = jtgpair.first;
+        //Get the typegen if it already exists
+        TypeGen* tg = ns->hasTypeGen(name) ? ns->getTypeGen(name) : nullptr;
+
+        jsonvector jtg = jtgpair.second.get<jsonvector>();
+        Params tgparams = json2Params(c,jtg[0]);
+        string tgkind = jtg[1].get<string>();
+        if (tgkind == "implicit") {
+          ASSERTTHROW(jtg.size()==2,"Bad implicit typegen format" + toString(jtg));
+          if (!tg) {
+            tg = TypeGenImplicit::make(ns,name,tgparams);
+            ns->addTypeGen(tg);
           }
-          else if (tgkind == "sparse") {
-            vector<std::pair<Values,Type*>> typeList;
-            //First just get the list of Values->Types
-            for (auto jvaltypes : jtg[2].get<jsonvector>()) {
-              jsonvector jvaltype = jvaltypes.get<jsonvector>();
-              ASSERTTHROW(jvaltype.size()==2,"Bad sparse typegen format" + toString(jtg[2]));
-              Values jvals = json2Values(c,jvaltype[0]);
-              Type* t = json2Type(c,jvaltype[1]);
-              typeList.push_back({jvals,t});
-            }
-            if (tg) { //If already exists, just check for consistency
-              for (auto vtpair : typeList) {
-                ASSERTTHROW(tg->getType(vtpair.first)==vtpair.second,"Typegens are inconsistent... " + tg->toString());
-              }
-            }
-            else {
-              tg = TypeGenSparse::make(ns,name,tgparams,typeList);
-              ns->addTypeGen(tg);
+        }
+        else if (tgkind == "sparse") {
+          vector<std::pair<Values,Type*>> typeList;
+          //First just get the list of Values->Types
+          for (auto jvaltypes : jtg[2].get<jsonvector>()) {
+            jsonvector jvaltype = jvaltypes.get<jsonvector>();
+            ASSERTTHROW(jvaltype.size()==2,"Bad sparse typegen format" + toString(jtg[2]));
+            Values jvals = json2Values(c,jvaltype[0]);
+            Type* t = json2Type(c,jvaltype[1]);
+            typeList.push_back({jvals,t});
+          }
+          if (tg) { //If already exists, just check for consistency
+            for (auto vtpair : typeList) {
+              ASSERTTHROW(tg->getType(vtpair.first)==vtpair.second,"Typegens are inconsistent... " + tg->toString());
             }
           }
           else {
-            ASSERTTHROW(0,"NYI typegenkind="+tgkind);
+            tg = TypeGenSparse::make(ns,name,tgparams,typeList);
+            ns->addTypeGen(tg);
           }
         }
+        else {
+          ASSERTTHROW(0,"NYI typegenkind="+tgkind);
+        }
       }
     }
-    
-    //Saves module declaration and the json representing the module
-    vector<std::pair<Module*,json>> modqueue;
-    for (auto nsq : nsqueue) {
-      Namespace* ns = nsq.first;
-      json jns = nsq.second;
-      //Load Modules
-      if (jns.count("modules")) {
-        for (auto jmodmap : jns.at("modules").get<jsonmap>()) {
-          //Figure out type;
-          string jmodname = jmodmap.first;
-          //TODO for now if it already exists, just skip
-          if (ns->hasModule(jmodname)) {
-            //TODO confirm that is has the same everything like genparams 
-            continue;
-          }
-          
-          json jmod = jmodmap.second;
-          checkJson(jmod,{"type"},{"modparams","defaultmodargs","instances","connections","metadata"});
-          Type* t = json2Type(c,jmod.at("type"));
-          Params modparams;
-          if (jmod.count("modparams")) {
-            modparams = json2Params(c,jmod.at("modparams"));
-          }
-          Module* m = ns->newModuleDecl(jmodname,t,modparams);
-          if (jmod.count("defaultmodargs")) {
-            m->addDefaultModArgs(json2Values(c,jmod.at("defaultmodargs")));
-          }
-          if (jmod.count("metadata")) {
-            m->setMetaData(jmod["metadata"]);
-          }
-          modqueue.push_back({m,jmod});
+  }
+  
+  //Saves module declaration and where its definition is in the file
+  auto queueDef = [&](Module* m, map<string,JsonSlice>& jmod) {
+    if (!jmod.count("instances") && !jmod.count("connections")) return;
+    ModuleJson mj = {m,jmod["instances"],jmod["connections"]};
+    if (linker) {
+      auto prev = linker->defs.find(m);
+      if (prev!=linker->defs.end()) {
+        //The same definition in several files is the same symbol
+        if (!sameDef(prev->second.mj,mj)) {
+          linker->problems.push_back("Duplicate definition of " + m->getRefName() + (m->isGenerated() ? toString(m->getGenArgs()) : "") + " in " + prev->second.filename + " and " + filename);
         }
+        return;
+      }
+      linker->defs[m] = {filename,mj};
+      if (m->hasDef()) {
+        linker->predefined.push_back(m);
+        return;
       }
-      if (jns.count("generators")) {
-        for (auto jgenmap : jns.at("generators").get<jsonmap>()) {
-          string genname = jgenmap.first;
-          if (ns->hasGenerator(genname)) {
-            //TODO confirm that it has the same everything like genparams and modparams
+    }
+    modqueue.push_back(mj);
+  };
+  for (auto& jnsmap : jnamespaces) {
+    Namespace* ns = c->getNamespace(jnsmap.first);
+    auto& jns = jnsmap.second;
+    //Load Modules
+    if (jns.count("modules")) {
+      map<string,JsonSlice> jmodules;
+      forEachMember(jns.at("modules"),[&](const string& jmodname, JsonSlice jmod) {
+        jmodules[jmodname] = jmod;
+      });
+      for (auto& jmodmap : jmodules) {
+        //Figure out type;
+        string jmodname = jmodmap.first;
+        //TODO for now if it already exists, just skip
+        if (ns->hasModule(jmodname) && !linker) {
+          //TODO confirm that is has the same everything like genparams 
+          continue;
+        }
+        
+        auto jmod = skimObject(jmodmap.second,{"type"},{"modparams","defaultmodargs","instances","connections","metadata"});
+        Type* t = json2Type(c,jmod.at("type").parse());
+        if (ns->hasModule(jmodname)) {
+          Module* m = ns->getModule(jmodname);
+          if (m->getType()!=t) {
+            linker->problems.push_back("Conflicting declarations of " + m->getRefName() + " in " + filename);
             continue;
           }
+          queueDef(m,jmod);
+          continue;
+        }
+        Params modparams;
+        if (jmod.count("modparams")) {
+          modparams = json2Params(c,jmod.at("modparams").parse());
+        }
+        Module* m = ns->newModuleDecl(jmodname,t,modparams);
+        if (jmod.count("defaultmodargs")) {
+          m->addDefaultModArgs(json2Values(c,jmod.at("defaultmodargs").parse()));
+        }
+        if (jmod.count("metadata")) {
+          m->setMetaData(jmod.at("metadata").parse());
+        }
+        queueDef(m,jmod);
+      }
+    }
+    if (jns.count("generators")) {
+      map<string,JsonSlice> jgenerators;
+      forEachMember(jns.at("generators"),[&](const string& genname, JsonSlice jgen) {
+        jgenerators[genname] = jgen;
+      });
+      for (auto& jgenmap : jgenerators) {
+        string genname = jgenmap.first;
+        if (ns->hasGenerator(genname) && !linker) {
+          //TODO confirm that it has the same everything like genparams and modparams
+          continue;
+        }
 
-          json jgen = jgenmap.second;
-          checkJson(jgen,{"typegen","genparams"},{"modules","defaultgenargs","metadata"});
-          Params genparams = json2Params(c,jgen.at("genparams"));
+        auto jgen = skimObject(jgenmap.second,{"typegen","genparams"},{"modules","defaultgenargs","metadata"});
+        Generator* g;
+        //When linking, the generated modules of every file are kept
+        if (ns->hasGenerator(genname)) {
+          g = ns->getGenerator(genname);
+        }
+        else {
+          Params genparams = json2Params(c,jgen.at("genparams").parse());
           
-          string typeGenName = jgen.at("typegen").get<string>();
-          ASSERTTHROW(c->hasTypeGen(typeGenName),"Missing typegen symbol " + typeGenName + " for generator " + jgenmap.first);
+          string typeGenName = getString(jgen.at("typegen"));
+          ASSERTTHROW(c->hasTypeGen(typeGenName),"Missing typegen symbol " + typeGenName + " for generator " + genname);
           TypeGen* tg = c->getTypeGen(typeGenName);
-          vector<std::pair<Values,json>> genmodvalues;
           //Verify that this is consistent with all the types
           //TODO deal with module parameter generation
-          Generator* g = ns->newGeneratorDecl(genname,tg,genparams);
+          g = ns->newGeneratorDecl(genname,tg,genparams);
           if (jgen.count("defaultgenargs")) {
-            g->addDefaultGenArgs(json2Values(c,jgen.at("defaultgenargs")));
+            g->addDefaultGenArgs(json2Values(c,jgen.at("defaultgenargs").parse()));
           }
           if (jgen.count("metadata")) {
-            g->setMetaData(jgen["metadata"]);
-          }
-          if (jgen.count("modules")) {
-            for (auto jgenmod : jgen.at("modules").get<jsonvector>()) {
-              jsonvector jvalmod = jgenmod.get<jsonvector>();
-              ASSERTTHROW(jvalmod.size()==2,"Bad generated module" + toString(jgenmod));
-              Values genargs = json2Values(c,jvalmod[0]);
-              json jmod = jvalmod[1];
-              checkJson(jmod,{"type"},{"modparams","defaultmodargs","instances","connections","metadata"});
-              Type* type = json2Type(c,jmod.at("type"));
-              //This will verify the correct type if typegen can generate the type
-              Module* m = g->getModule(genargs,type);
-              modqueue.push_back({m,jmod}); //Populate the generated module cache
-            }
+            g->setMetaData(jgen.at("metadata").parse());
           }
         }
+        if (jgen.count("modules")) {
+          forEachElement(jgen.at("modules"),[&](JsonSlice jgenmod) {
+            vector<JsonSlice> jvalmod;
+            forEachElement(jgenmod,[&](JsonSlice v) { jvalmod.push_back(v); });
+            ASSERTTHROW(jvalmod.size()==2,"Bad generated module" + string(jgenmod.b,jgenmod.e));
+            Values genargs = json2Values(c,jvalmod[0].parse());
+            auto jmod = skimObject(jvalmod[1],{"type"},{"modparams","defaultmodargs","instances","connections","metadata"});
+            Type* type = json2Type(c,jmod.at("type").parse());
+            //This will verify the correct type if typegen can generate the type
+            Module* m = g->getModule(genargs,type);
+            queueDef(m,jmod); //Populate the generated module cache
+          });
+        }
       }
     }
-    //Now do all the ModuleDefinitions
-    for (auto mq : modqueue) {
-      Module* m = mq.first;
-      json jmod = mq.second;
-      if (!jmod.count("instances") && !jmod.count("connections")) {
-        continue;
-      }
-      ModuleDef* mdef = m->newModuleDef();
-      if (jmod.count("instances")) {
-        for (auto jinstmap : jmod.at("instances").get<jsonmap>()) {
-          string instname = jinstmap.first;
-          json jinst = jinstmap.second;
-          checkJson(jinst,set<string>(),{"modref","genref","genargs","modargs","metadata",});
-          // This function can throw an error
-          Instance* inst;
-          if (jinst.count("modref")) {
-            assert(jinst.count("genref")==0);
-            assert(jinst.count("genargs")==0);
-            Module* modRef = getModSymbol(c,jinst.at("modref").get<string>());
-            Values modargs;
-            if (jinst.count("modargs")) {
-              modargs = json2Values(c,jinst.at("modargs"),modRef);
-            }
-            inst = mdef->addInstance(instname,modRef,modargs);
-          }
-          else if (jinst.count("genargs") && jinst.count("genref")) { // This is a generator
-            auto gref = getRef(jinst.at("genref").get<string>());
-            Generator* genRef = getGenSymbol(c,gref[0],gref[1]);
-            Values genargs = json2Values(c,jinst.at("genargs"));
-            Values modargs;
-            if (jinst.count("modargs")) {
-              modargs = json2Values(c,jinst.at("modargs"));
-            }
-            inst = mdef->addInstance(instname,genRef,genargs,modargs);
-          }
-          else {
-            ASSERTTHROW(0,"Bad Instance. Need (modref || (genref && genargs)) " + instname);
-          }
-          if (jinst.count("metadata")) {
-            inst->setMetaData(jinst["metadata"]);
-          }
-        } // End Instances
-      }
+  }
+}
 
-      //Connections
-      if (jmod.count("connections")) {
-        for (auto jcon : jmod.at("connections").get<vector<jsonvector>>()) {
-          ASSERTTHROW(jcon.size()==2 || jcon.size()==3,"Connection invalid");
-          Wireable* a = mdef->sel(jcon[0].get<string>());
-          Wireable* b = mdef->sel(jcon[1].get<string>());
-          mdef->connect(a,b);
-          if (jcon.size()==3) {
-            mdef->getMetaData(a,b) = jcon[2];
+//Definitions are parsed in parallel a batch at a time and then built in
+//the context in file order. Building touches the shared caches of the
+//context so it stays on this thread.
+void buildModuleDefs(Context* c, vector<ModuleJson>& modqueue) {
+  uint numThreads = c->getNumThreads();
+  size_t batchSize = numThreads==1 ? 1 : 8*numThreads;
+  vector<ParsedDef> parsed;
+  for (size_t b=0; b<modqueue.size(); b+=batchSize) {
+    size_t n = std::min(batchSize,modqueue.size()-b);
+    parsed.assign(n,ParsedDef());
+    parallelFor(c,n,[&](size_t i) {
+      parseModuleDef(modqueue[b+i],parsed[i]);
+    });
+    for (size_t i=0; i<n; ++i) {
+      buildModuleDef(c,modqueue[b+i].m,parsed[i]);
+    }
+  }
+}
+
+}
+
+bool loadFromFile(Context* c, string filename,Module** top, bool lazy) {
+  //Shared with the lazy definitions, which keep the file mapped
+  shared_ptr<MappedFile> mapped = make_shared<MappedFile>(filename);
+  MappedFile& file = *mapped;
+  if (!file.isOpen()) {
+    Error e;
+    e.message("Cannot open file " + filename);
+    c->error(e);
+    return false;
+  }
+  if (!lazy) file.adviseSequential();
+
+  //The file is never parsed as a whole. It is skimmed for the extents of the
+  //namespaces and modules, and each piece is parsed on its own when it is
+  //loaded, so the peak memory is bounded by the largest single piece.
+  try {
+    FileJson fj;
+    skimFile(file,fj);
+    vector<ModuleJson> modqueue;
+    declareFile(c,filename,fj,modqueue);
+
+    //Now do all the ModuleDefinitions
+    //In lazy mode the extent of each definition in the file is its index. It
+    //is only parsed and built when the definition is first requested
+    if (lazy) {
+      for (auto& mq : modqueue) {
+        if (mq.m->hasDef()) continue;
+        skimModuleDef(mq);
+        mq.m->setDefLoader([mapped,mq,filename](Module* m) {
+          //There is no caller to return an error to, and the module cannot
+          //be left without the def it claims, so the error is fatal
+          try {
+            ParsedDef pd;
+            parseModuleDef(mq,pd);
+            buildModuleDef(m->getContext(),m,pd);
+          } catch(std::exception& exc) {
+            Error e;
+            e.message("In file: " + filename);
+            e.message("Could not load definition of " + m->getRefName());
+            e.message(exc.what());
+            e.fatal();
+            m->getContext()->error(e);
           }
-        }
+        });
       }
-      
-      //Add Def back in
-      m->setDef(mdef);
-    } //End Module loop
+      modqueue.clear();
+    }
+    buildModuleDefs(c,modqueue);
 
     //If top exists return it
-    if (top && j.count("top")) {
-      *top = getModSymbol(c,j["top"].get<string>());
+    if (top && fj.jtop.count("top")) {
+      *top = getModSymbol(c,getString(fj.jtop.at("top")));
       c->setTop(*top);
     }
     else if (top) {
@@ -323,6 +720,173 @@ bool loadFromFile(Context* c, string filename,Module** top) {
   return true;
 }
 
+bool linkFiles(Context* c, const vector<string>& filenames, Module** top) {
+  //The files are mapped and skimmed concurrently. Nothing here touches the
+  //context.
+  size_t n = filenames.size();
+  vector<unique_ptr<MappedFile>> files;
+  for (auto& filename : filenames) files.emplace_back(new MappedFile(filename));
+  vector<FileJson> fjs(n);
+  vector<string> errors(n);
+  parallelFor(c,n,[&](size_t i) {
+    if (!files[i]->isOpen()) {
+      errors[i] = "Cannot open file " + filenames[i];
+      return;
+    }
+    files[i]->adviseSequential();
+    try {
+      skimFile(*files[i],fjs[i]);
+    } catch(std::exception& exc) {
+      errors[i] = "In file: " + filenames[i] + ": " + exc.what();
+    }
+  });
+  Error e;
+  bool failed = false;
+  for (auto& error : errors) {
+    if (error.empty()) continue;
+    e.message(error);
+    failed = true;
+  }
+  if (failed) {
+    c->error(e);
+    return false;
+  }
+
+  Linker linker;
+  vector<ModuleJson> modqueue;
+  vector<ParsedDef> parsed;
+  string topRef;
+  string topFile;
+  size_t fi = 0;
+  try {
+    //Everything is declared before any definition so that references can go
+    //to any file
+    for (; fi<n; ++fi) {
+      declareFile(c,filenames[fi],fjs[fi],modqueue,&linker);
+      if (fjs[fi].jtop.count("top")) {
+        string ref = getString(fjs[fi].jtop.at("top"));
+        if (!topRef.empty() && ref != topRef) {
+          linker.problems.push_back("Conflicting tops " + topRef + " in " + topFile + " and " + ref + " in " + filenames[fi]);
+        }
+        else {
+          topRef = ref;
+          topFile = filenames[fi];
+        }
+      }
+    }
+
+    //Every definition is parsed concurrently, then all the references are
+    //resolved against the declared symbols at once so that every missing
+    //symbol is reported instead of only the first one
+    parsed.resize(modqueue.size());
+    parallelFor(c,modqueue.size(),[&](size_t i) {
+      parseModuleDef(modqueue[i],parsed[i]);
+    });
+  } catch(std::exception& exc) {
+    e.message("In file: " + (fi<n ? filenames[fi] : string("")));
+    e.message(exc.what());
+    c->error(e);
+    return false;
+  }
+  auto hasModule = [c](const string& ref) {
+    auto p = splitString<vector<string>>(ref,'.');
+    return p.size()==2 && c->hasNamespace(p[0]) && c->getNamespace(p[0])->hasModule(p[1]);
+  };
+  map<string,vector<string>> missing;
+  for (size_t i=0; i<modqueue.size(); ++i) {
+    Module* m = modqueue[i].m;
+    for (auto& pinst : parsed[i].instances) {
+      const json& jinst = pinst.jinst;
+      bool found = false;
+      string ref;
+      if (jinst.count("modref")) {
+        ref = jinst.at("modref").get<string>();
+        found = hasModule(ref);
+      }
+      else if (jinst.count("genref")) {
+        ref = jinst.at("genref").get<string>();
+        auto p = splitString<vector<string>>(ref,'.');
+        found = p.size()==2 && c->hasNamespace(p[0]) && c->getNamespace(p[0])->hasGenerator(p[1]);
+      }
+      else {
+        found = true; //Reported when it is built
+      }
+      if (!found) {
+        missing[ref].push_back(m->getRefName() + " (" + linker.defs.at(m).filename + ")");
+      }
+    }
+  }
+  for (auto& mpair : missing) {
+    linker.problems.push_back("Missing symbol " + mpair.first + " used by " + join(mpair.second.begin(),mpair.second.end(),string(", ")));
+  }
+  if (!topRef.empty() && !hasModule(topRef)) {
+    linker.problems.push_back("Missing top " + topRef);
+  }
+  for (auto m : linker.predefined) {
+    auto& def = linker.defs.at(m);
+    bool same;
+    try {
+      ParsedDef pd;
+      parseModuleDef(def.mj,pd);
+      same = sameDef(c,m,pd);
+    } catch(std::exception& exc) {
+      same = false;
+    }
+    if (!same) {
+      linker.problems.push_back("Duplicate definition of " + m->getRefName() + (m->isGenerated() ? toString(m->getGenArgs()) : "") + " in " + def.filename + " differs from the one it already has");
+    }
+  }
+  if (!linker.problems.empty()) {
+    e.message("Cannot link " + join(filenames.begin(),filenames.end(),string(",")));
+    for (auto& problem : linker.problems) e.message(problem);
+    c->error(e);
+    return false;
+  }
+
+  size_t di = 0;
+  try {
+    for (; di<modqueue.size(); ++di) {
+      buildModuleDef(c,modqueue[di].m,parsed[di]);
+    }
+  } catch(std::exception& exc) {
+    e.message("In file: " + linker.defs.at(modqueue[di].m).filename);
+    e.message(exc.what());
+    c->error(e);
+    return false;
+  }
+
+  if (top && !topRef.empty()) {
+    *top = c->getModule(topRef);
+    c->setTop(*top);
+  }
+  else if (top) {
+    *top = nullptr;
+  }
+  return true;
+}
+
+bool loadFromGeneratorCache(Module* m) {
+  MappedFile file(getGeneratorCacheFile(m));
+  if (!file.isOpen()) return false;
+  try {
+    const char* p = file.begin();
+    JsonSlice jfile = skipValue(p,file.end());
+    auto jentry = skimObject(jfile,{"key","module"});
+    //Different keys can share a file name
+    if (getString(jentry.at("key"))!=getGeneratorCacheKey(m)) return false;
+    auto jmod = skimObject(jentry.at("module"),{"type"},{"modparams","defaultmodargs","instances","connections","metadata"});
+    if (json2Type(m->getContext(),jmod.at("type").parse())!=m->getType()) return false;
+    json metadata = jmod.count("metadata") ? jmod.at("metadata").parse() : json();
+    ParsedDef pd;
+    parseModuleDef({m,jmod["instances"],jmod["connections"]},pd);
+    buildModuleDef(m->getContext(),m,pd);
+    if (!metadata.is_null()) m->setMetaData(metadata);
+  } catch(std::exception& exc) {
+    return false;
+  }
+  return true;
+}
+
 Module* getModSymbol(Context* c, string ref) {
   auto mref = getRef(ref);
   return getModSymbol(c,mref[0],mref[1]);
@@ -350,7 +914,7 @@ Generator* getGenSymbol(Context* c, string nsname, string iname) {
 
 ValueType* json2ValueType(Context* c,json j) {
   if (j.type() == json::value_t::array) {
-    ASSERT(j[0].get<string>()=="BitVector","Bad string for ValueType");
+    ASSERTTHROW(j.size()==2 && j[0].get<string>()=="BitVector","Bad string for ValueType");
     return c->BitVector(j[1].get<int>());
   }
   string vs = j.get<string>();
@@ -376,7 +940,7 @@ ValueType* json2ValueType(Context* c,json j) {
     return AnyType::make(c);
   }
   else {
-    ASSERT(0,vs + " is not a ValueType");
+    throw std::runtime_error(vs + " is not a ValueType");
   }
 }
 
@@ -391,22 +955,22 @@ Params json2Params(Context* c,json j) {
 
 Value* json2Value(Context* c, json j,Module* m) {
   auto jlist = j.get<jsonvector>();
+  ASSERTTHROW(jlist.size()==2 || jlist.size()==3,"Invalid Value " + toString(j));
   ValueType* vtype = json2ValueType(c,jlist[0]);
   if (jlist.size()==3) {
     //Arg
-    ASSERT(jlist[1].get<string>()=="Arg","Value with json array of size=3 must be an Arg");
-    ASSERT(m,"Can only use 'Arg' reference in modargs");
+    ASSERTTHROW(jlist[1].get<string>()=="Arg","Value with json array of size=3 must be an Arg");
+    ASSERTTHROW(m,"Can only use 'Arg' reference in modargs");
     return m->getArg(jlist[2].get<string>());
   }
   json jval = jlist[1];
-  ASSERT(jlist.size()==2,"NYI");
   switch(vtype->getKind()) {
     case ValueType::VTK_Bool : return Const::make(c,jval.get<bool>());
     case ValueType::VTK_Int : return Const::make(c,jval.get<int>());
     case ValueType::VTK_BitVector : {
       ASSERTTHROW(jval.is_string(),toString(jval) + " needs to be a bitvector string <N>'h<value>");
       auto bv = BitVector(jval.get<string>());
-      assert(bv.bitLength() == cast<BitVectorType>(vtype)->getWidth());
+      ASSERTTHROW(bv.bitLength() == cast<BitVectorType>(vtype)->getWidth(),toString(jval) + " does not have width " + to_string(cast<BitVectorType>(vtype)->getWidth()));
       return Const::make(c,bv);                                 
     }
     case ValueType::VTK_String : return Const::make(c,jval.get<string>());
@@ -416,15 +980,16 @@ Value* json2Value(Context* c, json j,Module* m) {
       if (jval.type() == json::value_t::array) { //This is a generated module
         vector<json> jgenmod = jval.get<vector<json>>();
         ASSERTTHROW(jgenmod.size()==2,"Badly constructed module");
-        mod = c->getGenerator(jgenmod[0].get<string>())->getModule(json2Values(c,jgenmod[1],m));
+        auto gref = getRef(jgenmod[0].get<string>());
+        mod = getGenSymbol(c,gref[0],gref[1])->getModule(json2Values(c,jgenmod[1],m));
       }
       else {
-        mod = c->getModule(jval.get<string>());
+        mod = getModSymbol(c,jval.get<string>());
       }
       return Const::make(c,mod);
     }
     case ValueType::VTK_Json : return Const::make(c,jval);
-    default : ASSERT(0,"Cannot have a Const of type" + vtype->toString());
+    default : throw std::runtime_error("Cannot have a Const of type" + vtype->toString());
   }
 }
 
@@ -456,17 +1021,20 @@ Type* json2Type(Context* c, json jt) {
   }
   else if (jt.type() == json::value_t::array) {
     jsonvector args = jt.get<jsonvector>();
+    ASSERTTHROW(!args.empty(),"Error parsing Type");
     string kind = args[0].get<string>();
     if (kind == "Array") {
+      ASSERTTHROW(args.size()==3,"Invalid Array Type field" + toString(jt));
       uint n = args[1].get<uint>();
       Type* t = json2Type(c,args[2]);
       return c->Array(n,t);
     }
     else if (kind == "Record") {
+      ASSERTTHROW(args.size()==2,"Invalid Record Type field" + toString(jt));
       RecordParams rparams;
       for (auto it : args[1].get<jsonvector>()) {
         jsonvector field = it.get<jsonvector>();
-        ASSERT(field.size()==2, "Invalid Record field" + toString(it));
+        ASSERTTHROW(field.size()==2, "Invalid Record field" + toString(it));
         rparams.push_back({field[0].get<string>(),json2Type(c,field[1])});
       }
       return c->Record(rparams);
@@ -476,11 +1044,11 @@ Type* json2Type(Context* c, json jt) {
       vector<string> info = getRef(args[1].get<string>());
       std::string nsname = info[0];
       std::string name   = info[1];
+      ASSERTTHROW(c->hasNamespace(nsname) && c->getNamespace(nsname)->hasNamedType(name),"Missing Named type " + nsname + "." + name);
       return c->Named(nsname+"."+name);
     }
     else {
-      cout << "ERROR NYI!: " << args[0].get<string>() << endl;
-      coreir_unreachable();
+      throw std::runtime_error(kind + " is not a type!");
     }
   }
   else throw std::runtime_error("Error parsing Type");
@@ -139,7 +139,7 @@ bool saveToFile(Namespace* ns, string filename,Module* top) {
 
 }
 
-bool saveToFile(Context* c, string filename, bool nocoreir) {
+bool saveToFile(Context* c, string filename, bool nocoreir, bool compact) {
   ASSERT(endsWith(filename, ".json"),filename + "Needs to be a json file");
   std::ofstream file(filename);
   if (!file.is_open()) {
@@ -166,7 +166,7 @@ bool saveToFile(Context* c, string filename, bool nocoreir) {
   if (c->hasTop()) {
     topRef = c->getTop()->getRefName();
   }
-  jpass->writeToStream(file,topRef);
+  jpass->writeToStream(file,topRef,compact);
   return true;
 }
 
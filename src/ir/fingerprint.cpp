@@ -0,0 +1,82 @@
+#include "coreir/ir/fingerprint.h"
+#include "coreir/ir/common.h"
+#include "coreir/ir/module.h"
+#include "coreir/ir/moduledef.h"
+#include "coreir/ir/wireable.h"
+#include "coreir/ir/types.h"
+#include "coreir/ir/value.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace CoreIR {
+
+namespace {
+//How an instance refers to its module
+string moduleRefKey(Module* m) {
+  string ret = m->getRefName();
+  if (m->isGenerated()) {
+    ret += toString(m->getGenArgs());
+  }
+  return ret;
+}
+}
+
+string getStructuralKey(Module* m) {
+  std::ostringstream key;
+  key << "type:" << m->getType()->toString() << "\n";
+  key << "params:" << toString(m->getModParams()) << "\n";
+  key << "defaults:" << toString(m->getDefaultModArgs()) << "\n";
+  if (m->hasMetaData()) {
+    key << "metadata:" << m->getMetaData().dump() << "\n";
+  }
+  if (!m->hasDef()) {
+    key << "decl:" << moduleRefKey(m) << "\n";
+    return key.str();
+  }
+
+  ModuleDef* def = m->getDef();
+  //Instances are sorted by name
+  for (auto ipair : def->getInstances()) {
+    Instance* inst = ipair.second;
+    key << "inst:" << ipair.first << " " << moduleRefKey(inst->getModuleRef()) << toString(inst->getModArgs());
+    if (inst->hasMetaData()) {
+      key << inst->getMetaData().dump();
+    }
+    key << "\n";
+  }
+
+  //Connections are stored unordered so sort them by their select paths
+  vector<string> cons;
+  cons.reserve(def->getConnections().size());
+  for (auto con : def->getConnections()) {
+    string a = toString(con.first->getSelectPath());
+    string b = toString(con.second->getSelectPath());
+    if (b < a) std::swap(a,b);
+    string c = a + "=" + b;
+    if (def->hasMetaData(con.first,con.second)) {
+      c += def->getMetaData(con.first,con.second).dump();
+    }
+    cons.push_back(c);
+  }
+  std::sort(cons.begin(),cons.end());
+  for (auto& c : cons) {
+    key << "con:" << c << "\n";
+  }
+  return key.str();
+}
+
+uint64_t getFingerprint(Module* m) {
+  return hashString(getStructuralKey(m));
+}
+
+uint64_t hashString(const string& s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char ch : s) {
+    h ^= ch;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+}//CoreIR namespace
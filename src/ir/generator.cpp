@@ -10,6 +10,7 @@
 #include "coreir/ir/directedview.h"
 #include "coreir/ir/valuetype.h"
 #include "coreir/ir/value.h"
+#include "coreir/ir/instancegraph.h"
 
 using namespace std;
 
@@ -37,6 +38,7 @@ Generator::~Generator() {
 //This is the tough one
 Module* Generator::getModule(Values genargs) {
   mergeValues(genargs,defaultGenArgs);
+  std::lock_guard<std::recursive_mutex> lock(genCacheLock);
   if (genCache.count(genargs)) {
     return genCache[genargs];
   }
@@ -55,6 +57,7 @@ Module* Generator::getModule(Values genargs) {
      m = new Module(ns,modname,type,Params(),this,genargs);
   }
   genCache[genargs] = m;
+  if (InstanceGraph* ig = getContext()->getInstanceGraph()) ig->addModule(m);
   
   //TODO I am not sure what the default behavior should be
   //for not having a def
@@ -69,6 +72,7 @@ Module* Generator::getModule(Values genargs) {
 
 Module* Generator::getModule(Values genargs, Type* type) {
   mergeValues(genargs,defaultGenArgs);
+  std::lock_guard<std::recursive_mutex> lock(genCacheLock);
   if (genCache.count(genargs)) {
     return genCache[genargs];
   }
@@ -88,6 +92,7 @@ Module* Generator::getModule(Values genargs, Type* type) {
      m = new Module(ns,modname,type,Params(),this,genargs);
   }
   genCache[genargs] = m;
+  if (InstanceGraph* ig = getContext()->getInstanceGraph()) ig->addModule(m);
   
   //TODO I am not sure what the default behavior should be
   //for not having a def
@@ -0,0 +1,57 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "coreir/ir/generatorcache.h"
+#include "coreir/ir/json.h"
+#include "coreir/ir/context.h"
+#include "coreir/ir/common.h"
+#include "coreir/ir/generator.h"
+#include "coreir/ir/module.h"
+#include "coreir/ir/fingerprint.h"
+#include "coreir/passes/analysis/coreirjson.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+namespace CoreIR {
+
+string getGeneratorCacheKey(Module* m) {
+  Generator* g = m->getGenerator();
+  return g->getRefName() + "\n" + g->getVersion() + "\n" + toString(m->getGenArgs());
+}
+
+string getGeneratorCacheFile(Module* m) {
+  std::ostringstream name;
+  name << m->getContext()->getGeneratorCacheDirectory() << "/" << m->getGenerator()->getName() << "_";
+  name << std::hex << std::setw(16) << std::setfill('0') << hashString(getGeneratorCacheKey(m)) << ".json";
+  return name.str();
+}
+
+//Entries are written next to their destination and moved in place, so that
+//processes sharing the directory only ever see complete entries
+void saveToGeneratorCache(Module* m) {
+  string dirname = m->getContext()->getGeneratorCacheDirectory();
+  mkdir(dirname.c_str(),0777);
+  string filename = getGeneratorCacheFile(m);
+  string tmpname = filename + ".tmp" + to_string(getpid());
+  {
+    std::ofstream file(tmpname);
+    if (!file.is_open()) return;
+    file << "{\"key\":" << json(getGeneratorCacheKey(m)).dump() << ",\"module\":";
+    Passes::CoreIRJson::writeModuleToStream(file,m,true);
+    file << "}" << endl;
+    if (!file.good()) {
+      file.close();
+      std::remove(tmpname.c_str());
+      return;
+    }
+  }
+  if (rename(tmpname.c_str(),filename.c_str())!=0) {
+    std::remove(tmpname.c_str());
+  }
+}
+
+}//CoreIR namespace
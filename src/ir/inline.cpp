@@ -1,4 +1,5 @@
 #include "coreir/ir/casting/casting.h"
+#include "coreir/ir/common.h"
 #include "coreir/ir/context.h"
 #include "coreir/ir/wireable.h"
 #include "coreir/ir/generator.h"
@@ -183,14 +184,18 @@ bool inlineInstance(Instance* inst) {
   }
 
   //I will be inlining defInline into def
-  //Making a copy because i want to modify it first without modifying all of the other instnaces of modInline
-  ModuleDef* defInline = modInline->getDef()->copy();
-
-  //Add a passthrough Module to quarentine 'self'
-  addPassthrough(defInline->getInterface(),"_insidePT");
+  //defInline is only read. Instead of copying it and quarentining its 'self'
+  //with a passthrough, the passthrough is created directly in def and every
+  //connection to 'self' is redirected to its 'out' port.
+  ModuleDef* defInline = modInline->getDef();
   
   string inlinePrefix = inst->getInstname() + "$";
 
+  //Add a passthrough Module to quarentine 'self'
+  Instance* insidePT = def->addInstance(inlinePrefix + "_insidePT",c->getGenerator("_.passthrough"),{{"type",Const::make(c,defInline->getInterface()->getType())}});
+  unordered_map<Wireable*,Wireable*> inlineMap;
+  inlineMap[defInline->getInterface()] = insidePT->sel("out");
+
   //First add all the instances of defInline into def with a new name
   for (auto instpair : defInline->getInstances()) {
     string iname = inlinePrefix + instpair.first;
@@ -202,21 +207,15 @@ bool inlineInstance(Instance* inst) {
         modargs[vpair.first] = instModArgs[varg->getField()];
       }
     }
-    def->addInstance(iname,instpair.second->getModuleRef(),modargs);
+    inlineMap[instpair.second] = def->addInstance(iname,instpair.second->getModuleRef(),modargs);
   }
   
-  //Now add all the easy connections (that do not touch the boundary)
+  //Now add all the connections. The ones touching the boundary land on the passthrough
   for (auto cons : defInline->getConnections()) {
-    SelectPath pA = cons.first->getSelectPath();
-    SelectPath pB = cons.second->getSelectPath();
-    
-    //Easy case: when neither are connect to self
-    if (pA[0] != "self" && pB[0] != "self") {
-      //Create the correct names and connect
-      pA[0] = inlinePrefix + pA[0];
-      pB[0] = inlinePrefix + pB[0];
-      def->connect(pA,pB);
-    }
+    def->connect(
+      selCorresponding(cons.first,inlineMap),
+      selCorresponding(cons.second,inlineMap)
+    );
   }
   
   //Create t3e Passthrough to quarentene the instance itself
@@ -231,7 +230,7 @@ bool inlineInstance(Instance* inst) {
   //Now inline both of the passthroughs
   inlineInstance(outsidePT);
   
-  inlineInstance(cast<Instance>(def->sel(inlinePrefix + "_insidePT")));
+  inlineInstance(insidePT);
 
   //typecheck the module
   // WARNING: Temporarily removed to check performance impact in _stereo.json
@@ -241,7 +240,7 @@ bool inlineInstance(Instance* inst) {
     //for each entry in instances symbtable
     //prepend instname to key
     //determine where new instance is pointing to
-    if (mref->getMetaData().get<map<string,json>>().count("symtable")) {
+    if (mref->hasMetaData("symtable")) {
       json jisym = mref->getMetaData()["symtable"];
       for (auto p : jisym.get<map<string,json>>()) {
         string newkey = instname + "$" + p.first;
@@ -258,7 +257,7 @@ bool inlineInstance(Instance* inst) {
       }
     }
    
-    if (def->getModule()->getMetaData().get<map<string,json>>().count("symtable")) {
+    if (def->getModule()->hasMetaData("symtable")) {
       json jmerge = def->getModule()->getMetaData()["symtable"];
       for (auto pair : jsym.get<map<string,json>>()) {
         bool check = jmerge.get<map<string,json>>().count(pair.first)==0;
@@ -1,4 +1,5 @@
 #include "coreir/ir/instancegraph.h"
+#include <algorithm>
 
 using namespace std;
 using namespace CoreIR;
@@ -7,14 +8,52 @@ bool InstanceGraph::ModuleCmp::operator()(const Module* l, const Module* r) cons
   return l->getLongName() < r->getLongName();
 }
 
+bool InstanceGraphNode::InstanceCmp::operator()(Instance* l, Instance* r) const {
+  Module* lm = l->getContainer()->getModule();
+  Module* rm = r->getContainer()->getModule();
+  if (lm != rm) return lm->getLongName() < rm->getLongName();
+  return l->getInstname() < r->getInstname();
+}
+
+InstanceGraphNode::InstanceList InstanceGraphNode::getInstanceList() {
+  std::lock_guard<std::recursive_mutex> guard(ig->lock);
+  InstanceList ret;
+  for (auto& ppair : parents) {
+    ret.insert(ret.end(),ppair.second.begin(),ppair.second.end());
+  }
+  std::sort(ret.begin(),ret.end(),InstanceCmp());
+  return ret;
+}
+
 void InstanceGraph::releaseMemory() {
+  if (c && c->getInstanceGraph()==this) c->setInstanceGraph(nullptr);
+  c = nullptr;
+  for (auto npair : nodes) delete npair.second;
+  nodes.clear();
   nodeMap.clear();
-  for (auto ign : sortedNodes) delete ign;
+  instanced.clear();
   sortedNodes.clear();
+  levels.clear();
   onlyTopNodes.clear();
+  sorted = false;
+  sortedTop = nullptr;
+}
+
+std::list<InstanceGraphNode*> InstanceGraph::getSortedNodes() {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  updateOrder();
+  return sortedNodes;
+}
+
+std::vector<std::vector<InstanceGraphNode*>> InstanceGraph::getLevels() {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  updateOrder();
+  return levels;
 }
 
 bool InstanceGraph::validOnlyTop(InstanceGraphNode* node) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  updateOrder();
   return onlyTopNodes.count(node->getModule()) > 0;
 }
 
@@ -24,64 +63,207 @@ void InstanceGraph::sortVisit(InstanceGraphNode* node) {
   }
   ASSERT(node->mark!=1,"SOMEHOW not a DAG");
   node->mark = 1;
-  for (auto nextnode : node->ignList) {
-    sortVisit(nextnode);
+  for (auto ppair : node->parents) {
+    sortVisit(getNode(ppair.first));
   }
   node->mark = 2;
   sortedNodes.push_front(node);
 }
 
 namespace {
-  void recurse(Module* m, std::set<Module*,InstanceGraph::ModuleCmp>& onlyTopNodes) {
-    if (onlyTopNodes.count(m)) {
+  void recurse(InstanceGraphNode* node, std::set<Module*,InstanceGraph::ModuleCmp>& onlyTopNodes, const std::map<InstanceGraphNode*,std::vector<InstanceGraphNode*>>& children) {
+    if (onlyTopNodes.count(node->getModule())) {
       return;
     }
-    onlyTopNodes.insert(m);
-    if (!m->hasDef()) {
-      return;
-    }
-    for (auto ipair : m->getDef()->getInstances()) {
-      Module* imod = ipair.second->getModuleRef();
-      recurse(imod,onlyTopNodes);
+    onlyTopNodes.insert(node->getModule());
+    auto it = children.find(node);
+    if (it == children.end()) return;
+    for (auto child : it->second) {
+      recurse(child,onlyTopNodes,children);
     }
   }
 }
 
-void InstanceGraph::construct(Context* c) {
-
-  //Contains all external nodes referenced
+InstanceGraphNode* InstanceGraph::getNode(Module* m) {
+  auto it = nodes.find(m);
+  ASSERT(it != nodes.end(),"missing: " + m->toString());
+  return it->second;
+}
 
-  if (c->hasTop()) {
-    //Only do this on dependent nodes
-    recurse(c->getTop(),onlyTopNodes);
-  }
-  
+void InstanceGraph::construct(Context* c) {
+  //Modules created while the definitions are loaded are added by the updates
+  this->c = c;
+  c->setInstanceGraph(this);
   for (auto nsmap : c->getNamespaces()) {
     for (auto imap : nsmap.second->getModules()) {
-      nodeMap[imap.second] = new InstanceGraphNode(imap.second,false);
+      addModule(imap.second);
     }
   }
 
   //populate all the nodes with pointers to the instances
-  map<Module*,InstanceGraphNode*,InstanceGraph::ModuleCmp> nodeMap2;
-  for (auto nodemap : nodeMap) {
-    nodeMap2.insert(nodemap);
-  }
+  map<Module*,InstanceGraphNode*,InstanceGraph::ModuleCmp> nodeMap2 = nodeMap;
   for (auto nodemap : nodeMap2) {
     Module* m = nodemap.first;
     if (!m->hasDef()) continue;
-    ModuleDef* mdef = cast<Module>(nodemap.first)->getDef();
-    for (auto instmap : mdef->getInstances()) {
-      Module* icheck = instmap.second->getModuleRef();
-      ASSERT(nodeMap.count(icheck),"missing: " + icheck->toString());
-      InstanceGraphNode* node = nodeMap[icheck];
-      node->addInstance(instmap.second,nodemap.second);
+    for (auto instmap : m->getDef()->getInstances()) {
+      addInstance(instmap.second);
     }
   }
+}
+
+void InstanceGraph::updateOrder() {
+  if (!c) return;
+  Module* top = c->hasTop() ? c->getTop() : nullptr;
+  if (!sorted || top != sortedTop) sort();
+}
+
+void InstanceGraph::sort() {
+  //Like construct, every definition is loaded
+  map<Module*,InstanceGraphNode*,InstanceGraph::ModuleCmp> nodeMap2 = nodeMap;
+  for (auto nodemap : nodeMap2) {
+    if (nodemap.first->hasLazyDef()) nodemap.first->getDef();
+  }
 
+  sortedNodes.clear();
+  levels.clear();
+  onlyTopNodes.clear();
+  for (auto nodemap : nodeMap) {
+    nodemap.second->mark = 0;
+    nodemap.second->level = 0;
+  }
   for (auto imap : nodeMap) {
     sortVisit(imap.second);
   }
+
+  //Instanced modules are sorted before the modules that instance them
+  for (auto node : sortedNodes) {
+    for (auto ppair : node->parents) {
+      InstanceGraphNode* parent = getNode(ppair.first);
+      parent->level = std::max(parent->level,node->level+1);
+    }
+  }
+  for (auto node : sortedNodes) {
+    if (node->level >= (int) levels.size()) levels.resize(node->level+1);
+    levels[node->level].push_back(node);
+  }
+
+  if (c->hasTop()) {
+    //Only do this on dependent nodes
+    map<InstanceGraphNode*,vector<InstanceGraphNode*>> children;
+    for (auto node : sortedNodes) {
+      for (auto ppair : node->parents) {
+        children[getNode(ppair.first)].push_back(node);
+      }
+    }
+    recurse(getNode(c->getTop()),onlyTopNodes,children);
+  }
+  sorted = true;
+  sortedTop = c->hasTop() ? c->getTop() : nullptr;
+}
+
+namespace {
+  //Like Context::getNamespaces, modules of the hidden namespace (like
+  //_.passthrough) are only in the graph while they are instanced
+  bool isHidden(Module* m) {
+    return m->getNamespace()->getName()=="_";
+  }
+}
+
+InstanceGraphNode* InstanceGraph::addNode(Module* m) {
+  auto it = nodes.find(m);
+  if (it != nodes.end()) return it->second;
+  InstanceGraphNode* node = new InstanceGraphNode(m,this,false);
+  nodes[m] = node;
+  nodeMap[m] = node;
+  sorted = false;
+  return node;
+}
+
+void InstanceGraph::addModule(Module* m) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  if (!isHidden(m)) addNode(m);
+}
+
+//The instances of m are expected to be removed already
+void InstanceGraph::eraseModule(Module* m) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  //Unless m was detached
+  auto iit = instanced.find(m);
+  if (iit != instanced.end()) {
+    for (auto node : iit->second) node->parents.erase(m);
+    instanced.erase(iit);
+    sorted = false;
+  }
+  auto it = nodes.find(m);
+  if (it == nodes.end()) return;
+  nodeMap.erase(m);
+  delete it->second;
+  nodes.erase(it);
+  sorted = false;
+}
+
+void InstanceGraph::addInstance(Instance* i) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  InstanceGraphNode* node = addNode(i->getModuleRef());
+  Module* parent = i->getContainer()->getModule();
+  auto& insts = node->parents[parent];
+  if (!insts.insert(i).second) return;
+  //A new edge
+  if (insts.size() == 1) {
+    instanced[parent].insert(node);
+    sorted = false;
+  }
+}
+
+void InstanceGraph::removeInstance(Instance* i) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  auto it = nodes.find(i->getModuleRef());
+  if (it == nodes.end()) return;
+  InstanceGraphNode* node = it->second;
+  Module* parent = i->getContainer()->getModule();
+  auto pit = node->parents.find(parent);
+  if (pit == node->parents.end() || !pit->second.erase(i)) return;
+  if (pit->second.empty()) {
+    node->parents.erase(pit);
+    instanced[parent].erase(node);
+    sorted = false;
+  }
+  if (node->parents.empty() && isHidden(node->getModule())) {
+    eraseModule(node->getModule());
+  }
+}
+
+void InstanceGraph::detachModule(Module* m) {
+  m->graphDetached = true;
+}
+
+void InstanceGraph::attachModule(Module* m) {
+  m->graphDetached = false;
+  if (m->graphStale.exchange(false)) resync(m);
+}
+
+//The instances recorded for m may have been deleted since, so they are
+//dropped by module instead of one at a time
+void InstanceGraph::resync(Module* m) {
+  std::lock_guard<std::recursive_mutex> guard(lock);
+  bool wasSorted = sorted;
+  std::unordered_set<InstanceGraphNode*> before;
+  auto iit = instanced.find(m);
+  if (iit != instanced.end()) {
+    before = std::move(iit->second);
+    instanced.erase(iit);
+  }
+  for (auto node : before) node->parents.erase(m);
+  if (m->hasDef()) {
+    for (auto ipair : m->getDef()->getInstances()) addInstance(ipair.second);
+  }
+  for (auto node : before) {
+    if (node->parents.empty() && isHidden(node->getModule())) {
+      eraseModule(node->getModule());
+    }
+  }
+  iit = instanced.find(m);
+  sorted = wasSorted && before == (iit == instanced.end() ? std::unordered_set<InstanceGraphNode*>() : iit->second);
 }
 
 
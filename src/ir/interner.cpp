@@ -0,0 +1,90 @@
+#include "coreir/ir/interner.h"
+
+using namespace std;
+
+namespace CoreIR {
+
+StringInterner::StringInterner() {
+  for (auto& chunk : chunks) chunk.store(nullptr,std::memory_order_relaxed);
+  Table* t = new Table{(1u << firstChunkBits)-1,new std::atomic<uint32_t>[1u << firstChunkBits]};
+  for (uint32_t i=0; i<=t->mask; ++i) t->slots[i].store(0,std::memory_order_relaxed);
+  tables.push_back(t);
+  table.store(t,std::memory_order_release);
+}
+
+StringInterner::~StringInterner() {
+  for (auto& chunk : chunks) delete[] chunk.load(std::memory_order_relaxed);
+  for (auto t : tables) {
+    delete[] t->slots;
+    delete t;
+  }
+}
+
+bool StringInterner::find(const string& s, size_t hash, Symbol& sym) const {
+  Table* t = table.load(std::memory_order_acquire);
+  for (uint32_t i = hash & t->mask; ; i = (i+1) & t->mask) {
+    uint32_t slot = t->slots[i].load(std::memory_order_acquire);
+    if (slot == 0) return false;
+    if (at(slot-1) == s) {
+      sym = Symbol(slot-1);
+      return true;
+    }
+  }
+}
+
+void StringInterner::insert(Table* t, uint32_t id, size_t hash) {
+  uint32_t i = hash & t->mask;
+  while (t->slots[i].load(std::memory_order_relaxed) != 0) i = (i+1) & t->mask;
+  t->slots[i].store(id+1,std::memory_order_release);
+}
+
+Symbol StringInterner::intern(const string& s) {
+  size_t hash = std::hash<string>()(s);
+  Symbol sym;
+  if (find(s,hash,sym)) return sym;
+  std::lock_guard<std::mutex> lock(mutex);
+  //Someone else may have added it in the meantime
+  if (find(s,hash,sym)) return sym;
+
+  uint32_t id = count.load(std::memory_order_relaxed);
+  uint32_t n = id + (1u << firstChunkBits);
+  uint32_t k = 31 - __builtin_clz(n) - firstChunkBits;
+  ASSERT(k < maxChunks,"Too many interned strings");
+  if (!chunks[k].load(std::memory_order_relaxed)) {
+    chunks[k].store(new string[1u << (firstChunkBits+k)],std::memory_order_release);
+  }
+  chunks[k].load(std::memory_order_relaxed)[n - (1u << (firstChunkBits+k))] = s;
+  count.store(id+1,std::memory_order_release);
+
+  Table* t = table.load(std::memory_order_relaxed);
+  if (2*(uint64_t)(id+1) > (uint64_t) t->mask+1) {
+    uint32_t size = 2*(t->mask+1);
+    Table* bigger = new Table{size-1,new std::atomic<uint32_t>[size]};
+    for (uint32_t i=0; i<size; ++i) bigger->slots[i].store(0,std::memory_order_relaxed);
+    for (uint32_t i=0; i<id; ++i) insert(bigger,i,std::hash<string>()(at(i)));
+    tables.push_back(bigger);
+    t = bigger;
+  }
+  insert(t,id,hash);
+  table.store(t,std::memory_order_release);
+  return Symbol(id);
+}
+
+SymbolPath StringInterner::toSymbolPath(const SelectPath& path) {
+  SymbolPath ret;
+  ret.reserve(path.size());
+  for (auto& s : path) {
+    ret.push_back(intern(s));
+  }
+  return ret;
+}
+
+SelectPath StringInterner::toSelectPath(const SymbolPath& path) const {
+  SelectPath ret;
+  for (auto sym : path) {
+    ret.push_back(getString(sym));
+  }
+  return ret;
+}
+
+}//CoreIR namespace
@@ -0,0 +1,34 @@
+#include "coreir/ir/mappedfile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace CoreIR {
+
+MappedFile::MappedFile(const string& filename) {
+  int fd = open(filename.c_str(),O_RDONLY);
+  if (fd < 0) return;
+  opened = true;
+  struct stat st;
+  if (fstat(fd,&st)==0 && st.st_size > 0) {
+    void* p = mmap(nullptr,st.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    if (p != MAP_FAILED) {
+      data = static_cast<const char*>(p);
+      size = st.st_size;
+    }
+  }
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data) munmap(const_cast<char*>(data),size);
+}
+
+void MappedFile::adviseSequential() {
+  if (data) madvise(const_cast<char*>(data),size,MADV_SEQUENTIAL);
+}
+
+}//CoreIR namespace
@@ -10,6 +10,8 @@
 #include "coreir/ir/directedview.h"
 #include "coreir/ir/valuetype.h"
 #include "coreir/ir/value.h"
+#include "coreir/ir/generatorcache.h"
+#include "coreir/ir/instancegraph.h"
 
 using namespace std;
 
@@ -59,7 +61,12 @@ DirectedModule* Module::newDirectedModule() {
 }
 
 Module::~Module() {
-  
+  if (InstanceGraph* ig = getContext()->getInstanceGraph()) {
+    if (def) {
+      for (auto ipair : def->getInstances()) ig->removeInstance(ipair.second);
+    }
+    ig->eraseModule(this);
+  }
   for (auto md : mdefList) delete md;
   delete directedModule;
 }
@@ -68,9 +75,32 @@ Module::~Module() {
 
 ModuleDef* Module::getDef() const {
   //ASSERT(hasDef(),"Missing def:" + this->toString());
+  if (lazyDef) {
+    //Other threads wait for the one running the loader
+    std::lock_guard<std::recursive_mutex> lock(defLock);
+    //Released first so a loader that asks for the def cannot recurse
+    if (defLoader) {
+      auto loader = std::move(defLoader);
+      defLoader = nullptr;
+      //Materializing the definition does not change the module
+      bool wasDirty = dirty;
+      bool wasUnverified = unverified;
+      loader(const_cast<Module*>(this));
+      const_cast<Module*>(this)->dirty = wasDirty;
+      const_cast<Module*>(this)->unverified = wasUnverified;
+      ASSERT(def,"Lazy definition of " + this->getRefName() + " was not loaded");
+      lazyDef = false;
+    }
+  }
   return def;
 }
 
+void Module::setDefLoader(std::function<void(Module*)> loader) {
+  ASSERT(!def,"Module " + this->getRefName() + " already has a definition");
+  defLoader = loader;
+  lazyDef = bool(loader);
+}
+
 ModuleDef* Module::newModuleDef() {
   
   ModuleDef* md = new ModuleDef(this);
@@ -84,6 +114,7 @@ void Module::addDefaultModArgs(Values defaultModArgs) {
     ASSERT(modparams.count(argmap.first),"Cannot set default module arg. Param " + argmap.first + " Does not exist!");
     this->defaultModArgs[argmap.first] = argmap.second;
   }
+  this->markDirty();
 }
 
 void Module::setDef(ModuleDef* def, bool validate) {
@@ -93,7 +124,25 @@ void Module::setDef(ModuleDef* def, bool validate) {
       this->getContext()->die();
     }
   }
+  else if (def->commitBulk()) {
+    cout << "Error Validating def" << endl;
+    this->getContext()->die();
+  }
+  InstanceGraph* ig = this->getContext()->getInstanceGraph();
+  if (ig && graphDetached) {
+    graphStale = true;
+    ig = nullptr;
+  }
+  if (ig && this->def) {
+    for (auto ipair : this->def->getInstances()) ig->removeInstance(ipair.second);
+  }
   this->def = def;
+  this->defLoader = nullptr;
+  lazyDef = false;
+  this->markDirty();
+  if (ig && def) {
+    for (auto ipair : def->getInstances()) ig->addInstance(ipair.second);
+  }
   //Directed View is not valid anymore
   if (this->directedModule) {
     delete this->directedModule;
@@ -109,15 +158,19 @@ bool Module::runGenerator() {
   if (!g->hasDef()) return false;
   if (this->hasDef()) return false;
   
+  //Versioned generators can reuse the definition built by an earlier run
+  bool cached = g->getVersion()!="" && getContext()->getGeneratorCacheDirectory()!="";
+  if (cached && loadFromGeneratorCache(this)) return true;
   ModuleDef* mdef = this->newModuleDef();
   g->getDef()->createModuleDef(mdef,genargs); 
   this->setDef(mdef);
+  if (cached) saveToGeneratorCache(this);
   return true;
 }
 
 void Module::print(void) const {
   cout << toString() << endl;
-  if(def) def->print();
+  if(hasDef()) getDef()->print();
 
 }
 
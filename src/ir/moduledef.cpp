@@ -6,6 +6,8 @@
 #include "coreir/ir/types.h"
 #include "coreir/ir/error.h"
 #include "coreir/ir/value.h"
+#include "coreir/ir/interner.h"
+#include "coreir/ir/instancegraph.h"
 #include <iterator>
 
 
@@ -14,13 +16,35 @@ using namespace std;
 namespace CoreIR {
 
 ModuleDef::ModuleDef(Module* module) : module(module), instancesIterFirst(nullptr), instancesIterLast(nullptr) {
-  interface = new Interface(this,cast<RecordType>(module->getType()->getFlipped()));
+  interface = newWireable<Interface>(this,cast<RecordType>(module->getType()->getFlipped()));
 }
 
 ModuleDef::~ModuleDef() {
   //Delete interface, instances, cache
-  delete interface;
-  for(auto inst : instances) delete inst.second;
+  //The arena releases all of the slabs afterwards
+  freeWireable(interface);
+  for(auto inst : instances) freeWireable(inst.second);
+}
+
+InstanceGraph* ModuleDef::getInstanceGraph() {
+  InstanceGraph* ig = getContext()->getInstanceGraph();
+  if (!ig || module->def!=this) return nullptr;
+  if (module->graphDetached) {
+    module->graphStale = true;
+    return nullptr;
+  }
+  return ig;
+}
+
+void ModuleDef::freeWireable(Wireable* w) {
+  size_t size = 0;
+  switch(w->getKind()) {
+    case Wireable::WK_Interface: size = sizeof(Interface); break;
+    case Wireable::WK_Instance: size = sizeof(Instance); break;
+    case Wireable::WK_Select: size = sizeof(Select); break;
+  }
+  w->~Wireable();
+  arena.deallocate(w,size);
 }
 
 //
@@ -65,7 +89,7 @@ RecordType* ModuleDef::getType() {return module->getType();}
                                Wireable* const cpy,
                                std::map<Wireable*, Wireable*>& origToCopies) {
     origToCopies[original] = cpy;
-    for (auto sel : original->getSelects()) {
+    for (auto sel : original->getSymbolSelects()) {
       addCorrespondingSelects(sel.second, cpy->sel(sel.first), origToCopies);
     }
   }
@@ -74,19 +98,25 @@ ModuleDef* ModuleDef::copy() {
   Module* m = this->getModule();
   ModuleDef* def = m->newModuleDef();
 
-  map<Wireable*, Wireable*> oldWireablesToCopies;
+  unordered_map<Wireable*, Wireable*> oldWireablesToCopies;
+  oldWireablesToCopies[this->getInterface()] = def->getInterface();
+  def->reserve(instances.size(),connections.size());
   
   for (auto inst : this->getInstances()) {
-    def->addInstance(inst.second);
+    oldWireablesToCopies[inst.second] = def->addInstance(inst.second);
   }
 
+  //Map the wireables directly instead of going through string paths
+  //The connections were already type checked in this def
+  vector<Connection> cons;
+  cons.reserve(connections.size());
   for (auto con: this->getConnections()) {
-
-    const SelectPath& a = con.first->getSelectPath();
-    const SelectPath& b = con.second->getSelectPath();
-    def->connect(a,b);
-
+    cons.emplace_back(
+      selCorresponding(con.first,oldWireablesToCopies),
+      selCorresponding(con.second,oldWireablesToCopies)
+    );
   }
+  def->connectBulk(cons);
 
   return def;
 }
@@ -131,6 +161,22 @@ Wireable* ModuleDef::sel(const SelectPath& path) {
   }
   return cur;
 }
+Wireable* ModuleDef::sel(Symbol s) {
+  auto it = instanceSyms.find(s);
+  if (it != instanceSyms.end()) return it->second;
+  const string& name = getContext()->getInterner()->getString(s);
+  ASSERT(name=="self","Cannot find instance " + name);
+  return interface;
+}
+
+Wireable* ModuleDef::sel(const SymbolPath& path) {
+  Wireable* cur = this->sel(path[0]);
+  for (auto it = std::next(path.begin()); it != path.end(); ++it) {
+    cur = cur->sel(*it);
+  }
+  return cur;
+}
+
 Wireable* ModuleDef::sel(std::initializer_list<const char*> path) {
   return sel(SelectPath(path.begin(),path.end()));
 }
@@ -139,53 +185,40 @@ Wireable* ModuleDef::sel(std::initializer_list<std::string> path) {
 }
 
 void ModuleDef::appendInstanceToIter(Instance* instance) {
-    if (instancesIterFirst == nullptr) {
-        assert(this->instancesIterLast == nullptr);
-        // Sets `instance` to the current first and last pointer of the
-        // iterator and sets the prev and next pointers to be null
-        this->instancesIterFirst = instance;
-        this->instancesIterLast = instance;
-        this->instancesIterNextMap[instance] = nullptr;
-        this->instancesIterPrevMap[instance] = nullptr;
-    } else {
-        assert(this->instancesIterLast != nullptr);
-        Instance* currLast = this->instancesIterLast;
-        // Updates the current last instance's next to point to the new instance,
-        assert(this->instancesIterNextMap[currLast] == nullptr);  // current last shouldn't have a next
-        this->instancesIterNextMap[currLast] = instance;
-        // Sets the new instance's prev to point the current last instance,
-        this->instancesIterPrevMap[instance] = currLast;
-        // Sets the new instance's next to be null
-        this->instancesIterNextMap[instance] = nullptr;
-        // Sets the current last instance to be the new instance
-        this->instancesIterLast = instance;
-    }
+  assert(!instance->iterPrev && !instance->iterNext);
+  if (instancesIterFirst == nullptr) {
+    assert(this->instancesIterLast == nullptr);
+    this->instancesIterFirst = instance;
+  } else {
+    assert(this->instancesIterLast->iterNext == nullptr);  // current last shouldn't have a next
+    this->instancesIterLast->iterNext = instance;
+    instance->iterPrev = this->instancesIterLast;
+  }
+  this->instancesIterLast = instance;
 }
 
 void ModuleDef::removeInstanceFromIter(Instance* instance) {
-    assert(this->instancesIterNextMap.count(instance) == 1);
-    assert(this->instancesIterPrevMap.count(instance) == 1);
-    // Because we set prev and next to be nullptr for the first and last, we
-    // can assume the prev and next exist or are null
-    Instance *next = this->instancesIterNextMap[instance];
-    Instance *prev = this->instancesIterPrevMap[instance];
-    // Update pointers to skip instance
-    this->instancesIterNextMap[prev] = next;
-    this->instancesIterPrevMap[next] = prev;
-    if (instance == this->instancesIterLast) {
-        // The new last is this instance's prev
-        this->instancesIterLast = prev;
-    }
-    if (instance == this->instancesIterFirst) {
-        // The new first is the this instance's next
-        this->instancesIterFirst = next;
-    }
+  Instance* next = instance->iterNext;
+  Instance* prev = instance->iterPrev;
+  // Update pointers to skip instance
+  if (prev) prev->iterNext = next;
+  else {
+    assert(instance == this->instancesIterFirst);
+    this->instancesIterFirst = next;
+  }
+  if (next) next->iterPrev = prev;
+  else {
+    assert(instance == this->instancesIterLast);
+    this->instancesIterLast = prev;
+  }
+  instance->iterPrev = nullptr;
+  instance->iterNext = nullptr;
 }
 
 Instance* ModuleDef::getInstancesIterNext(Instance* instance) {
-    ASSERT(instance, "Cannot get next of IterEnd");
-    ASSERT(this->instancesIterNextMap.count(instance) == 1, "DEBUG ME: instance not in iter"); // TODO: Should be an error?
-    return this->instancesIterNextMap[instance];
+  ASSERT(instance, "Cannot get next of IterEnd");
+  ASSERT(instance->getContainer() == this, "DEBUG ME: instance not in iter");
+  return instance->iterNext;
 }
 
 
@@ -193,20 +226,26 @@ Instance* ModuleDef::getInstancesIterNext(Instance* instance) {
 Instance* ModuleDef::addInstance(string instname,Generator* gen, Values genargs,Values modargs) {
   ASSERT(instances.count(instname)==0,instname + " already an instance");
 
-  Instance* inst = new Instance(this,instname,gen->getModule(genargs),modargs);
+  Instance* inst = newWireable<Instance>(this,instname,gen->getModule(genargs),modargs);
   instances[instname] = inst;
+  instanceSyms[inst->getInstsym()] = inst;
 
   appendInstanceToIter(inst);
+  module->markDirty();
+  if (InstanceGraph* ig = getInstanceGraph()) ig->addInstance(inst);
 
   return inst;
 }
 
 Instance* ModuleDef::addInstance(string instname,Module* m,Values modargs) {
   ASSERT(instances.count(instname)==0,instname + " already an instance");
-  Instance* inst = new Instance(this,instname,m,modargs);
+  Instance* inst = newWireable<Instance>(this,instname,m,modargs);
   instances[instname] = inst;
+  instanceSyms[inst->getInstsym()] = inst;
   
   appendInstanceToIter(inst);
+  module->markDirty();
+  if (InstanceGraph* ig = getInstanceGraph()) ig->addInstance(inst);
   
   return inst;
 }
@@ -258,16 +297,13 @@ void ModuleDef::connect(Wireable* a, Wireable* b) {
   //checkWiring(a,b);
   
   Connection connect = connectionCtor(a,b);
-  if (!connections.count(connect)) {
-    
-    //Update 'a' and 'b'
-    a->addConnectedWireable(b);
-    b->addConnectedWireable(a);
-    connections.insert(connect);
-  }
-  else {
-    ASSERT(0,"Trying to add following connection twice! " + toString(connect));
-  }
+  bool inserted = connections.insert(connect).second;
+  ASSERT(inserted,"Trying to add following connection twice! " + toString(connect));
+  
+  //Update 'a' and 'b'
+  a->addConnectedWireable(b);
+  b->addConnectedWireable(a);
+  module->markDirty();
 }
 
 void ModuleDef::connect(const SelectPath& pathA, const SelectPath& pathB) {
@@ -283,16 +319,66 @@ void ModuleDef::connect(std::initializer_list<const char*> pA, std::initializer_
 void ModuleDef::connect(std::initializer_list<std::string> pA, std::initializer_list<string> pB) {
   connect(SelectPath(pA.begin(),pA.end()),SelectPath(pB.begin(),pB.end()));
 }
+void ModuleDef::reserve(size_t numInstances, size_t numConnections) {
+  instanceSyms.reserve(instanceSyms.size() + numInstances);
+  connections.reserve(connections.size() + numConnections);
+}
+
+vector<Instance*> ModuleDef::addInstances(const vector<InstanceDecl>& decls) {
+  instanceSyms.reserve(instanceSyms.size() + decls.size());
+  InstanceGraph* ig = getInstanceGraph();
+  vector<Instance*> ret;
+  ret.reserve(decls.size());
+  for (auto& decl : decls) {
+    ASSERT(instances.count(decl.name)==0,decl.name + " already an instance");
+    Instance* inst = newWireable<Instance>(this,decl.name,decl.modref,decl.modargs);
+    instances[decl.name] = inst;
+    instanceSyms[inst->getInstsym()] = inst;
+    appendInstanceToIter(inst);
+    if (ig) ig->addInstance(inst);
+    ret.push_back(inst);
+  }
+  module->markDirty();
+  return ret;
+}
+
+void ModuleDef::connectBulk(const vector<Connection>& cons) {
+  connections.reserve(connections.size() + cons.size());
+  uncheckedConnections.insert(uncheckedConnections.end(),cons.begin(),cons.end());
+  for (auto& con : cons) {
+    Wireable* a = con.first;
+    Wireable* b = con.second;
+    ASSERT(a->getContainer()==this && b->getContainer()==this,"connections can only occur within the same module: " + toString(con));
+    Connection connect = connectionCtor(a,b);
+    bool inserted = connections.insert(connect).second;
+    ASSERT(inserted,"Trying to add following connection twice! " + toString(connect));
+    a->addConnectedWireable(b);
+    b->addConnectedWireable(a);
+  }
+  module->markDirty();
+}
+
+bool ModuleDef::commitBulk() {
+  bool err = false;
+  for (auto& con : uncheckedConnections) {
+    //Skip the ones disconnected since
+    if (!connections.count(connectionCtor(con.first,con.second))) continue;
+    err |= checkTypes(con.first,con.second);
+  }
+  uncheckedConnections.clear();
+  return err;
+}
+
 bool ModuleDef::hasConnection(Wireable* a, Wireable* b) {
   Connection con = connectionCtor(a,b);
   return connections.count(con) > 0;
 }
 
 Connection ModuleDef::getConnection(Wireable* a, Wireable* b) {
-  Connection con = connectionCtor(a,b);
-  ASSERT(connections.count(con)>0,"Could not find connection!");
+  auto it = connections.find(connectionCtor(a,b));
+  ASSERT(it != connections.end(),"Could not find connection!");
   
-  return *connections.find(con);
+  return *it;
 }
 
 //This will remove all connections from a specific wireable
@@ -322,34 +408,35 @@ void ModuleDef::disconnect(Connection fstCon) {
   //  cout << "Contains reverse connection ? " << connections.count({con.second, con.first}) << endl;
   //}
 
-  ASSERT(connections.count(con),"Cannot delete connection that is not connected! " + toString(con));
+  //Delete connection from list
+  bool erased = connections.erase(con) > 0;
+  ASSERT(erased,"Cannot delete connection that is not connected! " + toString(con));
   
   //remove references
   con.first->removeConnectedWireable(con.second);
   con.second->removeConnectedWireable(con.first);
 
-  //Delete connection from list
-  connections.erase(con);
   //If it has metadata, remove that as well
-  if (connMetaData.count(con)>0) {
-    delete connMetaData[con];
+  if (!connMetaData.empty()) {
     connMetaData.erase(con);
   }
+  module->markDirty();
 }
 
 json& ModuleDef::getMetaData(Wireable* a, Wireable* b) {
   Connection conn = connectionCtor(a,b);
   ASSERT(connections.count(conn),"Cannot access metadata to something not connected: " + toString(conn));
-  if (connMetaData.count(conn) == 0) {
-    connMetaData.emplace(conn,new MetaData());
+  auto it = connMetaData.find(conn);
+  if (it == connMetaData.end()) {
+    it = connMetaData.emplace(conn,json(json::value_t::object)).first;
   }
-  return connMetaData[conn]->getMetaData();
-
+  return it->second;
 }
 
 bool ModuleDef::hasMetaData(Wireable* a, Wireable* b) {
-  Connection conn = connectionCtor(a,b);
-  return connMetaData.count(conn) > 0;
+  if (connMetaData.empty()) return false;
+  auto it = connMetaData.find(connectionCtor(a,b));
+  return it != connMetaData.end() && !it->second.empty();
 }
 
 
@@ -362,14 +449,15 @@ void ModuleDef::removeInstance(string iname) {
   //First verify that instance exists
   ASSERT(instances.count(iname), "Instance " + iname + " does not exist");
   Instance* inst = instances.at(iname);
+  if (InstanceGraph* ig = getInstanceGraph()) ig->removeInstance(inst);
   
   //First remove all the connections from this instance
   inst->disconnectAll();
 
   //remove the wireable (WILL free pointer)
   vector<string> sels;
-  for (auto selmap : inst->getSelects()) {
-    sels.push_back(selmap.first);
+  for (auto selmap : inst->getSymbolSelects()) {
+    sels.push_back(selmap.second->getSelStr());
   }
   for (auto sel : sels) {
     inst->removeSel(sel);
@@ -377,10 +465,12 @@ void ModuleDef::removeInstance(string iname) {
 
   //Now remove this instance
   instances.erase(iname);
+  instanceSyms.erase(inst->getInstsym());
   
   removeInstanceFromIter(inst);
 
-  delete inst;
+  freeWireable(inst);
+  module->markDirty();
 }
 
 } //coreir namespace
@@ -50,7 +50,7 @@ bool checkInputConnected(Wireable* w, Error* e) {
     return true;
   }
   bool err = false;
-  for (auto it : w->getSelects()) {
+  for (auto it : w->getSymbolSelects()) {
     err |= checkInputConnected(it.second,e);
   }
   return err;
@@ -72,13 +72,13 @@ bool checkInputOutputs(Wireable* w, Error* e) {
     return true;
   }
   else if (numwires==0 ) {
-    for ( auto it : w->getSelects()) {
+    for ( auto it : w->getSymbolSelects()) {
       err |= checkInputOutputs(it.second,e);
     }
   }
   else if (numwires==1) {
     // Check if any children is an input and connected
-    for ( auto it : w->getSelects()) {
+    for ( auto it : w->getSymbolSelects()) {
       if(checkInputConnected(it.second,e)) {
         err = true;
         for (auto other : w->getConnectedWireables() )
@@ -103,6 +103,8 @@ bool ModuleDef::validate() {
   for (auto connection : mdef->getConnections() ) {
     err |= checkTypes(connection.first,connection.second);
   }
+  //Which includes the ones made in bulk
+  mdef->uncheckedConnections.clear();
   
   //Check if an input is connected to multiple outputs
   vector<Wireable*> work;
@@ -7,6 +7,7 @@
 #include "coreir/ir/module.h"
 #include "coreir/ir/generator.h"
 #include "coreir/ir/error.h"
+#include "coreir/ir/instancegraph.h"
 
 using namespace std;
 
@@ -101,6 +102,7 @@ Module* Namespace::newModuleDecl(string name, Type* t, Params configparams) {
   ASSERT(isa<RecordType>(t),"Module type needs to be a record but is: " + t->toString());
   Module* m = new Module(this,name,t, configparams);
   moduleList[name] = m;
+  if (InstanceGraph* ig = c->getInstanceGraph()) ig->addModule(m);
   return m;
 }
 
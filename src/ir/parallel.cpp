@@ -0,0 +1,94 @@
+#include "coreir/ir/parallel.h"
+#include "coreir/ir/context.h"
+
+using namespace std;
+
+namespace CoreIR {
+
+uint getHardwareThreads() {
+  uint n = thread::hardware_concurrency();
+  return n ? n : 1;
+}
+
+ThreadPool::ThreadPool(uint numThreads) {
+  if (numThreads==0) numThreads = 1;
+  workers.reserve(numThreads-1);
+  for (uint t=1; t<numThreads; ++t) {
+    workers.emplace_back([this]() { workerLoop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto& th : workers) th.join();
+}
+
+void ThreadPool::work() {
+  while (!failed) {
+    size_t i = next++;
+    if (i >= jobSize) return;
+    try {
+      (*job)(i);
+    } catch(...) {
+      lock_guard<mutex> guard(lock);
+      if (!failed) error = current_exception();
+      failed = true;
+    }
+  }
+}
+
+void ThreadPool::workerLoop() {
+  uint seen = 0;
+  while (true) {
+    {
+      unique_lock<mutex> guard(lock);
+      wake.wait(guard,[&]() { return stopping || generation != seen; });
+      if (stopping) return;
+      seen = generation;
+    }
+    work();
+    {
+      lock_guard<mutex> guard(lock);
+      if (--active==0) done.notify_one();
+    }
+  }
+}
+
+void ThreadPool::parallelFor(size_t n, std::function<void(size_t)> f) {
+  bool idle = false;
+  if (workers.empty() || n <= 1 || !busy.compare_exchange_strong(idle,true)) {
+    for (size_t i=0; i<n; ++i) f(i);
+    return;
+  }
+  {
+    lock_guard<mutex> guard(lock);
+    job = &f;
+    jobSize = n;
+    next = 0;
+    failed = false;
+    active = workers.size();
+    ++generation;
+  }
+  wake.notify_all();
+  work();
+  exception_ptr e;
+  {
+    unique_lock<mutex> guard(lock);
+    done.wait(guard,[&]() { return active==0; });
+    job = nullptr;
+    e = error;
+    error = nullptr;
+  }
+  busy = false;
+  if (e) rethrow_exception(e);
+}
+
+void parallelFor(Context* c, size_t n, std::function<void(size_t)> f) {
+  c->getThreadPool()->parallelFor(n,f);
+}
+
+}//CoreIR namespace
@@ -1,12 +1,47 @@
 #include <stack>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sys/resource.h>
 #include "coreir/common/logging_lite.hpp"
 #include "coreir/ir/passmanager.h"
+#include "coreir/ir/parallel.h"
+#include "coreir/ir/json.h"
 #include "coreir/passes/common.h"
 #include "coreir/passes/analysis/createinstancegraph.h"
 #include "coreir/passes/analysis/createinstancemap.h"
 
 using namespace CoreIR;
 
+namespace {
+
+struct IRSize {
+  size_t instances = 0;
+  size_t connections = 0;
+};
+
+//Lazy definitions are not counted so that measuring does not load them
+IRSize getIRSize(Context* c) {
+  IRSize size;
+  for (auto nsmap : c->getNamespaces()) {
+    for (auto modmap : nsmap.second->getModules()) {
+      Module* m = modmap.second;
+      if (!m->hasDef() || m->hasLazyDef()) continue;
+      size.instances += m->getDef()->getInstances().size();
+      size.connections += m->getDef()->getConnections().size();
+    }
+  }
+  return size;
+}
+
+long getPeakRssKB() {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF,&ru);
+  return ru.ru_maxrss;
+}
+
+}
+
 PassManager::PassManager(Context* c) : c(c) {
   initializePasses(*this);
   
@@ -46,17 +81,32 @@ bool PassManager::runContextPass(Pass* pass) {
 
 //Only runs on modules with definitions
 bool PassManager::runModulePass(Pass* pass) {
-  bool modified = false;
   ModulePass* mpass = cast<ModulePass>(pass);
+  vector<Module*> modules;
   for (auto ns : this->nss) {
     for (auto modmap : ns->getModules()) {
       Module* m = modmap.second;
-      if (m->hasDef()) {
-        modified |= mpass->runOnModule(m);
-      }
+      if (!m->hasDef()) continue;
+      //A lazy definition has not changed since it was loaded
+      if (onlyUnverified && (!m->isUnverified() || m->hasLazyDef())) continue;
+      modules.push_back(m);
     }
   }
-  return modified;
+  if (!mpass->isModuleParallel() || c->getNumThreads() <= 1) {
+    bool modified = false;
+    for (auto m : modules) modified |= mpass->runOnModule(m);
+    return modified;
+  }
+  //Each module is its own task. Lazy definitions are loaded by their task.
+  //The instance graph catches up with the modules once they are done.
+  InstanceGraph* ig = c->getInstanceGraph();
+  if (ig) for (auto m : modules) ig->detachModule(m);
+  vector<char> modified(modules.size(),0);
+  parallelFor(c,modules.size(),[&](size_t i) {
+    modified[i] = mpass->runOnModule(modules[i]);
+  });
+  if (ig) for (auto m : modules) ig->attachModule(m);
+  return std::find(modified.begin(),modified.end(),1) != modified.end();
 }
 
 //Only runs on Instances
@@ -102,10 +152,39 @@ bool PassManager::runInstanceGraphPass(Pass* pass) {
   bool modified = false;
   InstanceGraphPass* igpass = cast<InstanceGraphPass>(pass);
   bool onlyTop = igpass->isOnlyTop();
-  for (auto node : cig->getInstanceGraph()->getSortedNodes()) {
-    if (!onlyTop || cig->getInstanceGraph()->validOnlyTop(node)) {
+  //The graph follows the changes the pass makes, so the nodes to run on are
+  //picked before
+  InstanceGraph* ig = cig->getInstanceGraph();
+  if (!igpass->isLevelParallel() || c->getNumThreads() <= 1) {
+    vector<InstanceGraphNode*> nodes;
+    for (auto node : ig->getSortedNodes()) {
+      if (!onlyTop || ig->validOnlyTop(node)) {
+        nodes.push_back(node);
+      }
+    }
+    for (auto node : nodes) {
       modified |= igpass->runOnInstanceGraphNode(*node);
     }
+    return modified;
+  }
+  //Each level waits for the ones below it
+  vector<vector<InstanceGraphNode*>> levels;
+  for (auto& level : ig->getLevels()) {
+    levels.emplace_back();
+    for (auto node : level) {
+      if (!onlyTop || ig->validOnlyTop(node)) {
+        levels.back().push_back(node);
+      }
+    }
+  }
+  for (auto& nodes : levels) {
+    for (auto node : nodes) ig->detachModule(node->getModule());
+    vector<char> nodeModified(nodes.size(),0);
+    parallelFor(c,nodes.size(),[&](size_t i) {
+      nodeModified[i] = igpass->runOnInstanceGraphNode(*nodes[i]);
+    });
+    for (auto node : nodes) ig->attachModule(node->getModule());
+    modified |= std::find(nodeModified.begin(),nodeModified.end(),1) != nodeModified.end();
   }
   return modified;
 }
@@ -114,6 +193,16 @@ bool PassManager::runPass(Pass* p,vector<string>& pArgs) {
   if (verbose) {
     LOG(INFO) << "Running Pass: " << p->getName();
   }
+  IRSize sizeBefore;
+  long rssBefore = 0;
+  std::clock_t cpuBefore = 0;
+  auto wallBefore = std::chrono::steady_clock::now();
+  if (instrumented) {
+    sizeBefore = getIRSize(c);
+    rssBefore = getPeakRssKB();
+    cpuBefore = std::clock();
+    wallBefore = std::chrono::steady_clock::now();
+  }
   //Translate vector<string> into argc and argv
   int argc = pArgs.size();
   char** argv = new char*[argc];
@@ -148,6 +237,24 @@ bool PassManager::runPass(Pass* p,vector<string>& pArgs) {
       ASSERT(0,"NYI!");
   }
   modified |= p->finalize();
+  if (instrumented) {
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallBefore).count();
+    double cpu = double(std::clock() - cpuBefore)/CLOCKS_PER_SEC;
+    long rss = getPeakRssKB() - rssBefore;
+    IRSize sizeAfter = modified ? getIRSize(c) : sizeBefore;
+    if (!passStats.count(p->getName())) {
+      passStatsOrder.push_back(p->getName());
+      passStats[p->getName()].instancesBefore = sizeBefore.instances;
+      passStats[p->getName()].connectionsBefore = sizeBefore.connections;
+    }
+    PassStats& stats = passStats[p->getName()];
+    stats.runs++;
+    stats.wallSeconds += wall;
+    stats.cpuSeconds += cpu;
+    stats.peakRssDeltaKB += rss;
+    stats.instancesAfter = sizeAfter.instances;
+    stats.connectionsAfter = sizeAfter.connections;
+  }
   if (verbose) {
     p->print();
   }
@@ -211,14 +318,14 @@ bool PassManager::run(vector<string>& passes,vector<string> nsnames) {
         analysisPasses[passString] = true;
       }
       else if (modified) { //Not analysis
-        //If it modified, need to conservatly invalidate all analysis passes
+        //If it modified, invalidate all analysis passes it does not preserve
         for (auto amap : analysisPasses) {
-          analysisPasses[amap.first] = false;
+          string aname = splitStringByWhitespace(amap.first)[0];
+          if (!p->preserves(aname) && !passMap[aname]->isKeptUpToDate()) {
+            analysisPasses[amap.first] = false;
+          }
         }
-        //Run Verifier pass
-        vector<string> verArgs = {"verifyinputconnections"};
-        this->runPass(passMap["verifyinputconnections"],verArgs);
-        analysisPasses["verifyinputconnections"] = true;
+        verifyModified();
       }
       ret |= modified;
 
@@ -226,6 +333,31 @@ bool PassManager::run(vector<string>& passes,vector<string> nsnames) {
   }
   return ret;
 }
+//Runs the verifier on the modules that changed since they were last
+//verified, or on every module with verifyAll
+void PassManager::verifyModified() {
+  //Lazy definitions are skipped (unless verifyAll), so they stay unverified
+  //until they are loaded and verified by a later run
+  vector<Module*> verified;
+  bool complete = true;
+  for (auto ns : this->nss) {
+    for (auto modmap : ns->getModules()) {
+      Module* m = modmap.second;
+      if (!verifyAll && m->hasLazyDef()) {
+        complete = false;
+        continue;
+      }
+      verified.push_back(m);
+    }
+  }
+  vector<string> verArgs = {"verifyinputconnections"};
+  onlyUnverified = !verifyAll;
+  this->runPass(passMap["verifyinputconnections"],verArgs);
+  onlyUnverified = false;
+  for (auto m : verified) m->clearUnverified();
+  analysisPasses["verifyinputconnections"] = complete;
+}
+
 bool PassManager::isAnalysisCached(string pass) {
   ASSERT(analysisPasses.count(pass),pass + " was never loaded");
   return analysisPasses.at(pass);
@@ -252,6 +384,54 @@ void PassManager::printPassChoices() {
 
 
 
+void PassManager::printPassStats(std::ostream& os) {
+  std::ios::fmtflags flags = os.flags();
+  std::streamsize precision = os.precision();
+  os << std::left << std::setw(32) << "Pass" << std::right;
+  os << std::setw(6) << "Runs" << std::setw(12) << "Wall(s)" << std::setw(12) << "CPU(s)";
+  os << std::setw(14) << "PeakRSS+(KB)" << std::setw(26) << "Instances" << std::setw(26) << "Connections" << endl;
+  PassStats total;
+  for (auto& name : passStatsOrder) {
+    PassStats& stats = passStats[name];
+    os << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(3);
+    os << std::setw(6) << stats.runs << std::setw(12) << stats.wallSeconds << std::setw(12) << stats.cpuSeconds;
+    os << std::setw(14) << stats.peakRssDeltaKB;
+    os << std::setw(26) << (to_string(stats.instancesBefore) + " -> " + to_string(stats.instancesAfter));
+    os << std::setw(26) << (to_string(stats.connectionsBefore) + " -> " + to_string(stats.connectionsAfter)) << endl;
+    total.runs += stats.runs;
+    total.wallSeconds += stats.wallSeconds;
+    total.cpuSeconds += stats.cpuSeconds;
+    total.peakRssDeltaKB += stats.peakRssDeltaKB;
+  }
+  os << std::left << std::setw(32) << "Total" << std::right;
+  os << std::setw(6) << total.runs << std::setw(12) << total.wallSeconds << std::setw(12) << total.cpuSeconds;
+  os << std::setw(14) << total.peakRssDeltaKB << endl;
+  os << "Peak RSS (KB): " << getPeakRssKB() << endl;
+  os.flags(flags);
+  os.precision(precision);
+}
+
+void PassManager::writePassStatsJson(std::ostream& os) {
+  nlohmann::json jstats;
+  jstats["passes"] = nlohmann::json::array();
+  for (auto& name : passStatsOrder) {
+    PassStats& stats = passStats[name];
+    nlohmann::json jpass;
+    jpass["name"] = name;
+    jpass["runs"] = stats.runs;
+    jpass["wall_seconds"] = stats.wallSeconds;
+    jpass["cpu_seconds"] = stats.cpuSeconds;
+    jpass["peak_rss_delta_kb"] = stats.peakRssDeltaKB;
+    jpass["instances_before"] = stats.instancesBefore;
+    jpass["instances_after"] = stats.instancesAfter;
+    jpass["connections_before"] = stats.connectionsBefore;
+    jpass["connections_after"] = stats.connectionsAfter;
+    jstats["passes"].push_back(jpass);
+  }
+  jstats["peak_rss_kb"] = getPeakRssKB();
+  os << jstats.dump(2) << endl;
+}
+
 PassManager::~PassManager() {
   for (auto p : passMap) {
     delete p.second;
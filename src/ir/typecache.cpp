@@ -61,6 +61,7 @@ TypeCache::~TypeCache() {
 
 
 ArrayType* TypeCache::getArray(uint len, Type* t) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (ArrayCache.count(t) && ArrayCache[t].count(len)) {
     return ArrayCache[t][len];
   } 
@@ -82,6 +83,7 @@ ArrayType* TypeCache::getArray(uint len, Type* t) {
 }
 
 RecordType* TypeCache::getRecord(RecordParams params) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   auto it = RecordCache.find(params);
   if (it != RecordCache.end()) {
     return it->second;
@@ -111,6 +113,7 @@ RecordType* TypeCache::getRecord(RecordParams params) {
 }
 
 BitVectorType* TypeCache::getBitVector(int width) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (bitVectorCache.count(width)) return bitVectorCache[width];
   BitVectorType* bv = new BitVectorType(c,width);
   bitVectorCache.emplace(width,bv);
@@ -11,6 +11,7 @@ namespace CoreIR {
 
 
 Type* TypeGen::getType(Values args) {
+  std::lock_guard<std::recursive_mutex> lock(typeCacheLock);
   if (typeCache.count(args)) {
     return typeCache.at(args);
   }
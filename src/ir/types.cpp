@@ -47,6 +47,13 @@ Type* Type::sel(string selstr) {
   ASSERT(0,"Bad Select");
 }
 
+Type* Type::sel(uint i) {
+  auto at = dyn_cast<ArrayType>(this);
+  ASSERT(at,"Cannot select index " + to_string(i) + " from " + this->toString());
+  ASSERT(i < at->getLen(),"Bad Select!");
+  return at->getElemType();
+}
+
 vector<std::string> Type::getSelects() {
   if (auto rt = dyn_cast<RecordType>(this)) {
     return rt->getFields();
@@ -75,6 +82,13 @@ bool Type::canSel(string selstr) {
   return false;
 }
 
+bool Type::canSel(uint i) {
+  if (auto at = dyn_cast<ArrayType>(this)) {
+    return i < at->getLen();
+  }
+  return false;
+}
+
 bool Type::canSel(SelectPath path) {
   if (path.size()==0) return true;
   string sel = path.front();
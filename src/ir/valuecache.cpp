@@ -61,6 +61,7 @@ ConstBool* ValueCache::getBool(bool val) {
 }
 
 ConstInt* ValueCache::getInt(int val) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (intCache.count(val) ) return intCache[val];
   auto v = new ConstInt(c->Int(),val);
   intCache[val] = v;
@@ -68,6 +69,7 @@ ConstInt* ValueCache::getInt(int val) {
 }
 
 ConstBitVector* ValueCache::getBitVector(BitVector val) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (bvCache.count(val) ) return bvCache[val];
   auto v = new ConstBitVector(c->BitVector(val.bitLength()),val);
   bvCache[val] = v;
@@ -75,6 +77,7 @@ ConstBitVector* ValueCache::getBitVector(BitVector val) {
 }
 
 ConstString* ValueCache::getString(string val) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (stringCache.count(val) ) return stringCache[val];
   auto v = new ConstString(c->String(),val);
   stringCache[val] = v;
@@ -82,6 +85,7 @@ ConstString* ValueCache::getString(string val) {
 }
 
 ConstCoreIRType* ValueCache::getType(Type* val) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (typeCache.count(val) ) return typeCache[val];
   auto v = new ConstCoreIRType(CoreIRType::make(c),val);
   typeCache[val] = v;
@@ -89,6 +93,7 @@ ConstCoreIRType* ValueCache::getType(Type* val) {
 }
 
 ConstModule* ValueCache::getModule(Module* val) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (moduleCache.count(val) ) return moduleCache[val];
   auto v = new ConstModule(ModuleType::make(c),val);
   moduleCache[val] = v;
@@ -96,6 +101,7 @@ ConstModule* ValueCache::getModule(Module* val) {
 }
 
 ConstJson* ValueCache::getJson(Json val) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
   if (JsonCache.count(val) ) return JsonCache[val];
   auto v = new ConstJson(JsonType::make(c),val);
   JsonCache[val] = v;
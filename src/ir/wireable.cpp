@@ -9,6 +9,9 @@
 #include "coreir/ir/types.h"
 #include "coreir/ir/typegen.h"
 #include "coreir/ir/value.h"
+#include "coreir/ir/interner.h"
+#include "coreir/ir/instancegraph.h"
+#include <algorithm>
 
 
 using namespace std;
@@ -23,24 +26,40 @@ const string Interface::instname = "self";
 
 Wireable::~Wireable() {
   for (auto selmap : selects) {
-    delete selmap.second;
+    container->freeWireable(selmap.second);
   }
 }
 
+Select* Wireable::newSel(Symbol sym, Type* t) {
+  Select* select = container->newWireable<Select>(container,this,sym,t);
+  selects.emplace(sym,select);
+  return select;
+}
+
 Select* Wireable::sel(const std::string& selStr) {
-  if (selects.count(selStr)) {
-    return selects[selStr];
+  Symbol sym = getContext()->getInterner()->intern(selStr);
+  auto it = selects.find(sym);
+  if (it != selects.end()) {
+    return it->second;
   }
   ASSERT(type->canSel(selStr),"Cannot select " + selStr + " From " + this->toString() + "\n  Type: " + type->toString());
-
-  Select* select = new Select(this->getContainer(),this,selStr, type->sel(selStr));
-
-  selects[selStr] = select;
-
-  return select;
+  //Array selects are all created through the index path
+  if (isa<ArrayType>(type)) {
+    return sel((uint) std::stoi(selStr,nullptr,0));
+  }
+  return newSel(sym,type->sel(selStr));
 }
 
-Select* Wireable::sel(uint selStr) { return sel(to_string(selStr)); }
+Select* Wireable::sel(uint i) {
+  auto at = dyn_cast<ArrayType>(type);
+  ASSERT(at && i < at->getLen(),"Cannot select " + to_string(i) + " From " + this->toString() + "\n  Type: " + type->toString());
+  Symbol sym = getContext()->getInterner()->intern(to_string(i));
+  auto it = selects.find(sym);
+  if (it != selects.end()) {
+    return it->second;
+  }
+  return newSel(sym,at->getElemType());
+}
 
 Select* Wireable::sel(const SelectPath& path) {
   Wireable* ret = this;
@@ -48,6 +67,20 @@ Select* Wireable::sel(const SelectPath& path) {
   return cast<Select>(ret);
 }
 
+Select* Wireable::sel(Symbol sym) {
+  auto it = selects.find(sym);
+  if (it != selects.end()) {
+    return it->second;
+  }
+  return sel(getContext()->getInterner()->getString(sym));
+}
+
+Select* Wireable::sel(const SymbolPath& path) {
+  Wireable* ret = this;
+  for (auto sym : path) ret = ret->sel(sym);
+  return cast<Select>(ret);
+}
+
 Select* Wireable::sel(std::initializer_list<const char*> path) {
   return sel(SelectPath(path.begin(),path.end()));
 }
@@ -61,6 +94,10 @@ bool Wireable::canSel(string selstr) {
   return type->canSel(selstr);
 }
 
+bool Wireable::canSel(uint i) {
+  return type->canSel(i);
+}
+
 bool Wireable::canSel(SelectPath path) {
   return type->canSel(path);
 }
@@ -97,35 +134,49 @@ void Wireable::disconnect() {
   this->getContainer()->disconnect(this);
 }
 
+std::map<std::string,Select*> Wireable::getSelects() {
+  std::map<std::string,Select*> ret;
+  for (auto& sels : selects) {
+    ret.emplace(sels.second->getSelStr(),sels.second);
+  }
+  return ret;
+}
+
 void Wireable::disconnectAll() {
-  for (auto sels : this->getSelects()) {
+  for (auto sels : selects) {
     sels.second->disconnectAll();
   }
   this->disconnect();
 }
 
 void Wireable::removeSel(string selStr) {
-  ASSERT(selects.count(selStr),"Cannot remove " + selStr + "Because it does not exist!");
-  Select* s = selects[selStr];
-  selects.erase(selStr);
+  auto it = selects.find(getContext()->getInterner()->intern(selStr));
+  ASSERT(it != selects.end(),"Cannot remove " + selStr + "Because it does not exist!");
+  Select* s = it->second;
+  selects.erase(it);
   
-  delete s;
+  container->freeWireable(s);
 }
 
 
-SelectPath& Wireable::getSelectPath() {
+SelectPath Wireable::getSelectPath() {
+  return getContext()->getInterner()->toSelectPath(getSymbolPath());
+}
+
+const SymbolPath& Wireable::getSymbolPath() {
   if (selectpath.size()==0) {
     Wireable* top = this;
     while(auto s = dyn_cast<Select>(top)) {
-      selectpath.push_front(s->getSelStr());
+      selectpath.push_back(s->getSelsym());
       top = s->getParent();
     }
-    if (isa<Interface>(top))
-      selectpath.push_front("self");
-    else { //This should be an instance
-      string instname = cast<Instance>(top)->getInstname();
-      selectpath.push_front(instname);
+    if (auto inst = dyn_cast<Instance>(top)) {
+      selectpath.push_back(inst->getInstsym());
+    }
+    else {
+      selectpath.push_back(getContext()->getInterner()->intern(cast<Interface>(top)->getInstname()));
     }
+    std::reverse(selectpath.begin(),selectpath.end());
   }
   return selectpath;
 }
@@ -215,7 +266,7 @@ string Interface::toString() const{
 
 
 
-Instance::Instance(ModuleDef* container, string instname, Module* moduleRef, Values modargs) : Wireable(WK_Instance,container,nullptr), instname(instname), moduleRef(moduleRef) {
+Instance::Instance(ModuleDef* container, string instname, Module* moduleRef, Values modargs) : Wireable(WK_Instance,container,nullptr), instsym(container->getContext()->getInterner()->intern(instname)), instname(container->getContext()->getInterner()->getString(instsym)), moduleRef(moduleRef) {
   checkStringSyntax(instname);
   //ASSERT(container->getInstances().count(instname)==0,"Cannot add two instances with the same name: " + instname);
   ASSERT(moduleRef,"Module is null, in inst: " + this->getInstname());
@@ -237,12 +288,23 @@ string Instance::toString() const {
 void Instance::replace(Module* moduleRef, Values modargs) {
   ASSERT(moduleRef,"ModuleRef is null in inst: " + this->getInstname());
   ASSERT(this->getType()==moduleRef->getType(),"NYI, Cannot replace with a different type");
+  InstanceGraph* ig = this->getContainer()->getInstanceGraph();
+  if (ig) ig->removeInstance(this);
   this->moduleRef = moduleRef;
   this->modargs = modargs;
+  if (ig) ig->addInstance(this);
   checkValuesAreParams(modargs,moduleRef->getModParams(),this->getInstname());
+  this->getContainer()->getModule()->markDirty();
+}
+
+Select::Select(ModuleDef* container, Wireable* parent, Symbol selsym, Type* type) : Wireable(WK_Select,container,type), parent(parent), selsym(selsym) {}
+
+const string& Select::getSelStr() const {
+  return container->getContext()->getInterner()->getString(selsym);
 }
 
 string Select::toString() const {
+  const string& selStr = getSelStr();
   string ret = parent->toString();
   if (isNumber(selStr)) return ret + "[" + selStr + "]";
   return ret + "." + selStr;
@@ -261,7 +261,7 @@ namespace CoreIR {
 
     vector<Select*> sels;
     for (uint i = 0; i < len; i++) {
-      Select* inSel = sel->sel(to_string(i));
+      Select* inSel = sel->sel(i);
       Select* driverSel = getDriverSelect(inSel);
 
       sels.push_back(driverSel);
@@ -81,17 +81,23 @@ void Aetherling_createMapGenerator(Context* c) {
             auto opOutputFields = getInputOrOutputFields(c, opType, false);
 
             // now create each op and wire the inputs and outputs to it
+            vector<ModuleDef::InstanceDecl> decls;
+            for (uint i = 0; i < numInputs; i++) {
+                decls.push_back({"op_" + to_string(i), opModule});
+            }
+            vector<Instance*> ops = def->addInstances(decls);
+            Wireable* self = def->getInterface();
+            vector<Connection> cons;
+            cons.reserve(numInputs * (opInputFields.size() + opOutputFields.size()));
             for (uint i = 0; i < numInputs; i++) {
-                string idxStr = to_string(i);                
-                string opStr = "op_" + idxStr;
-                def->addInstance(opStr, opModule);
                 for (auto opInputField : opInputFields) {
-                    def->connect("self." + opInputField.first + "." + idxStr, opStr + "." + opInputField.first);
+                    cons.emplace_back(self->sel(opInputField.first)->sel(i), ops[i]->sel(opInputField.first));
                 }
                 for (auto opOutputField: opOutputFields) {
-                    def->connect(opStr + "." + opOutputField.first, "self." + opOutputField.first + "." + idxStr);
+                    cons.emplace_back(ops[i]->sel(opOutputField.first), self->sel(opOutputField.first)->sel(i));
                 }
             }
+            def->connectBulk(cons);
         });
 
     aetherlinglib->newTypeGen(
@@ -55,25 +55,37 @@ void Aetherling_createReduceGenerator(Context* c) {
             Module* opModule = genargs.at("operator")->get<Module*>();
 
             // create each layer for all dpeths other than input
+            vector<ModuleDef::InstanceDecl> decls;
             for (uint i = 0; i < depth; i++) {
                 // since its a binary tree, each layer has 2^i elements
-                for (uint j = 0; j < pow(2, i); j++) {
-                    string opStr = getOpName(i, j);
-                    def->addInstance(opStr, opModule);
+                for (uint j = 0; j < (1u << i); j++) {
+                    decls.push_back({getOpName(i, j), opModule});
+                }
+            }
+            vector<Instance*> ops = def->addInstances(decls);
+            // layer i starts at index 2^i-1
+            auto op = [&ops](uint i, uint j) { return ops[(1u << i) - 1 + j]; };
+
+            Wireable* self = def->getInterface();
+            vector<Connection> cons;
+            cons.reserve(2*numInputs);
+            for (uint i = 0; i < depth; i++) {
+                for (uint j = 0; j < (1u << i); j++) {
                     // wire up inputs special only if first layer
                     if (i == depth - 1) {
-                        def->connect("self.in." + to_string(j*2), opStr + ".in0");
-                        def->connect("self.in." + to_string(j*2+1), opStr + ".in1");
+                        cons.emplace_back(self->sel("in")->sel(j*2), op(i, j)->sel("in0"));
+                        cons.emplace_back(self->sel("in")->sel(j*2+1), op(i, j)->sel("in1"));
                     }
                     // wire output special only if last layer
                     if (i == 0) {
-                        def->connect(opStr + ".out", "self.out");
+                        cons.emplace_back(op(i, j)->sel("out"), self->sel("out"));
                     }
                     else {
-                        def->connect(opStr + ".out", getOpName(i-1, j/2) + ".in" + to_string(j % 2));
+                        cons.emplace_back(op(i, j)->sel("out"), op(i-1, j/2)->sel("in" + to_string(j % 2)));
                     }
                 }
             }
+            def->connectBulk(cons);
         });
 
     /*
@@ -109,15 +121,19 @@ void Aetherling_createReduceGenerator(Context* c) {
             RecordType* opType = opModule->getType();
             uint elementWidth = opType->sel("out")->getSize();
             
-            def->addInstance("reducer", "aetherlinglib.reduceParallelPower2Inputs", {
+            Instance* reducer = def->addInstance("reducer", "aetherlinglib.reduceParallelPower2Inputs", {
                     {"numInputs", Const::make(c, numInputsRoundedUpToPow2)},
                     {"operator", Const::make(c, opModule)}
                 });
 
+            Wireable* data = def->getInterface()->sel("in")->sel("data");
+            Wireable* identity = def->getInterface()->sel("in")->sel("identity");
+            Wireable* reducerIn = reducer->sel("in");
+            vector<Connection> cons;
+            cons.reserve(numInputsRoundedUpToPow2);
             uint i;
             for (i = 0; i < numInputs; i++) {
-                string iStr = to_string(i);
-                def->connect("self.in.data." + iStr, "reducer.in." + iStr);
+                cons.emplace_back(data->sel(i), reducerIn->sel(i));
             }
             // hook up the identity to a term if not needed as power 2 inputs
             if (i == numInputsRoundedUpToPow2) {
@@ -127,9 +143,10 @@ void Aetherling_createReduceGenerator(Context* c) {
             else {
               // connect identity to rest of in now, all others up to power of 2
               for (; i < numInputsRoundedUpToPow2; i++) {
-                  def->connect("self.in.identity", "reducer.in." + to_string(i));
+                  cons.emplace_back(identity, reducerIn->sel(i));
               }
             }
+            def->connectBulk(cons);
             def->connect("reducer.out", "self.out");
         });
 
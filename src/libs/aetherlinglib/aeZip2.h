@@ -55,11 +55,17 @@ void Aetherling_createZipGenerator(Context* c) {
             assert(input1TypeRecord != 0); // 0 if cast failed, so input type wasn't RecordType
             */
             // now create each op and wire the inputs and outputs to it
+            Wireable* self = def->getInterface();
+            Wireable* in0 = self->sel("in0");
+            Wireable* in1 = self->sel("in1");
+            Wireable* out = self->sel("out");
+            vector<Connection> cons;
+            cons.reserve(2*numInputs);
             for (uint i = 0; i < numInputs; i++) {
-                string idxStr = to_string(i);
-                def->connect("self.in0." + idxStr, "self.out." + idxStr + ".el0");
-                def->connect("self.in1." + idxStr, "self.out." + idxStr + ".el1");
+                cons.emplace_back(in0->sel(i), out->sel(i)->sel("el0"));
+                cons.emplace_back(in1->sel(i), out->sel(i)->sel("el1"));
             }
+            def->connectBulk(cons);
         });
 }
 
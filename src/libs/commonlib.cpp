@@ -471,20 +471,29 @@ Namespace* CoreIRLoadLibrary_commonlib(Context* c) {
 
       // create and wire up registers
       assert(in_wires.size() == out_wires.size());
+      Values reg_args = {{"width", Const::make(c,bitwidth)},
+                         {"has_en", Const::make(c,en)},
+                         {"has_clr", Const::make(c,clr)},
+                         {"has_rst", Const::make(c,rst)}};
+      Values reg_configargs = {{"init", Const::make(c,BitVector(bitwidth,init))}};
+      Wireable* self = def->getInterface();
+      def->reserve(in_wires.size(),in_wires.size()*(2+en+clr+rst));
+      Module* regModule = c->getGenerator("mantle.reg")->getModule(reg_args);
+      std::vector<ModuleDef::InstanceDecl> decls;
       for (uint i=0; i<in_wires.size(); ++i) {
-        std::string reg_name = "reg_" + std::to_string(i);
-        Values reg_args = {{"width", Const::make(c,bitwidth)},
-                           {"has_en", Const::make(c,en)},
-                           {"has_clr", Const::make(c,clr)},
-                           {"has_rst", Const::make(c,rst)}};
-        Values reg_configargs = {{"init", Const::make(c,BitVector(bitwidth,init))}};
-        Wireable* reg = def->addInstance(reg_name, "mantle.reg", reg_args, reg_configargs);
-        if (en) { def->connect("self.en", reg_name+".en"); }
-        if (clr) { def->connect("self.clr", reg_name+".clr"); }
-        if (rst) { def->connect("self.rst", reg_name+".rst"); }
-        def->connect(in_wires[i], reg->sel("in"));
-        def->connect(reg->sel("out"), out_wires[i]);
+        decls.push_back({"reg_" + std::to_string(i), regModule, reg_configargs});
       }
+      auto regs = def->addInstances(decls);
+      std::vector<Connection> cons;
+      for (uint i=0; i<in_wires.size(); ++i) {
+        Wireable* reg = regs[i];
+        if (en) { cons.emplace_back(self->sel("en"), reg->sel("en")); }
+        if (clr) { cons.emplace_back(self->sel("clr"), reg->sel("clr")); }
+        if (rst) { cons.emplace_back(self->sel("rst"), reg->sel("rst")); }
+        cons.emplace_back(in_wires[i], reg->sel("in"));
+        cons.emplace_back(reg->sel("out"), out_wires[i]);
+      }
+      def->connectBulk(cons);
 
     });
 
@@ -534,16 +543,21 @@ Namespace* CoreIRLoadLibrary_commonlib(Context* c) {
         Const* aNlarge = Const::make(c,Nlargehalf);
         Const* aNsmall = Const::make(c,Nsmallhalf);
 
-        def->addInstance("muxN_0",muxN,{{"width",aWidth},{"N",aNlarge}});
-        def->addInstance("muxN_1",muxN,{{"width",aWidth},{"N",aNsmall}});
+        Instance* muxN_0 = def->addInstance("muxN_0",muxN,{{"width",aWidth},{"N",aNlarge}});
+        Instance* muxN_1 = def->addInstance("muxN_1",muxN,{{"width",aWidth},{"N",aNsmall}});
 
+        Wireable* data = def->sel("self.in.data");
+        Wireable* data_0 = muxN_0->sel("in")->sel("data");
+        Wireable* data_1 = muxN_1->sel("in")->sel("data");
+        vector<Connection> cons;
+        cons.reserve(N);
         for (uint i=0; i<Nlargehalf; ++i) {
-          def->connect({"self","in","data",to_string(i)},{"muxN_0","in","data",to_string(i)});
+          cons.emplace_back(data->sel(i),data_0->sel(i));
         }
-
         for (uint i=0; i<Nsmallhalf; ++i) {
-          def->connect({"self","in","data",to_string(i+Nlargehalf)},{"muxN_1","in","data",to_string(i)});
+          cons.emplace_back(data->sel(i+Nlargehalf),data_1->sel(i));
         }
+        def->connectBulk(cons);
 
         def->connect("muxN_0.out","_join.in0");
         def->connect("muxN_1.out","_join.in1");
@@ -609,14 +623,20 @@ Namespace* CoreIRLoadLibrary_commonlib(Context* c) {
       Const* aNlarge = Const::make(c,Nlargehalf);
       Const* aNsmall = Const::make(c,Nsmallhalf);
 
-      def->addInstance("opN_0",opN,{{"width",aWidth},{"N",aNlarge},{"operator",aOperator}});
-      def->addInstance("opN_1",opN,{{"width",aWidth},{"N",aNsmall},{"operator",aOperator}});
+      Instance* opN_0 = def->addInstance("opN_0",opN,{{"width",aWidth},{"N",aNlarge},{"operator",aOperator}});
+      Instance* opN_1 = def->addInstance("opN_1",opN,{{"width",aWidth},{"N",aNsmall},{"operator",aOperator}});
+      Wireable* in = def->sel("self.in");
+      Wireable* in_0 = opN_0->sel("in");
+      Wireable* in_1 = opN_1->sel("in");
+      vector<Connection> cons;
+      cons.reserve(N);
       for (uint i=0; i<Nlargehalf; ++i) {
-        def->connect({"self","in",to_string(i)},{"opN_0","in",to_string(i)});
+        cons.emplace_back(in->sel(i),in_0->sel(i));
       }
       for (uint i=0; i<Nsmallhalf; ++i) {
-        def->connect({"self","in",to_string(i+Nlargehalf)},{"opN_1","in",to_string(i)});
+        cons.emplace_back(in->sel(i+Nlargehalf),in_1->sel(i));
       }
+      def->connectBulk(cons);
       def->connect("opN_0.out","_join.in0");
       def->connect("opN_1.out","_join.in1");
     }
@@ -662,14 +682,20 @@ Namespace* CoreIRLoadLibrary_commonlib(Context* c) {
       Const* aNlarge = Const::make(c,Nlargehalf);
       Const* aNsmall = Const::make(c,Nsmallhalf);
 
-      def->addInstance("opN_0",opN,{{"N",aNlarge},{"operator",aOperator}});
-      def->addInstance("opN_1",opN,{{"N",aNsmall},{"operator",aOperator}});
+      Instance* opN_0 = def->addInstance("opN_0",opN,{{"N",aNlarge},{"operator",aOperator}});
+      Instance* opN_1 = def->addInstance("opN_1",opN,{{"N",aNsmall},{"operator",aOperator}});
+      Wireable* in = def->sel("self.in");
+      Wireable* in_0 = opN_0->sel("in");
+      Wireable* in_1 = opN_1->sel("in");
+      vector<Connection> cons;
+      cons.reserve(N);
       for (uint i=0; i<Nlargehalf; ++i) {
-        def->connect({"self","in",to_string(i)},{"opN_0","in",to_string(i)});
+        cons.emplace_back(in->sel(i),in_0->sel(i));
       }
       for (uint i=0; i<Nsmallhalf; ++i) {
-        def->connect({"self","in",to_string(i+Nlargehalf)},{"opN_1","in",to_string(i)});
+        cons.emplace_back(in->sel(i+Nlargehalf),in_1->sel(i));
       }
+      def->connectBulk(cons);
       def->connect("opN_0.out","_join.in0");
       def->connect("opN_1.out","_join.in1");
     }
@@ -726,91 +752,108 @@ Namespace* CoreIRLoadLibrary_commonlib(Context* c) {
     //uint width = genargs.at("width")->get<int>();
     uint depth = genargs.at("depth")->get<int>();
     uint awidth = (uint) ceil(log2(depth));
-
-    def->addInstance("raddr","mantle.reg",{{"width",Const::make(c,awidth)},{"has_en",Const::make(c,true)}});
-    def->addInstance("waddr","mantle.reg",{{"width",Const::make(c,awidth)},{"has_en",Const::make(c,true)}});
-
-    def->addInstance("mem","coreir.mem",genargs);
-
-    def->addInstance("add_r","coreir.add",{{"width",Const::make(c,awidth)}});
-    def->addInstance("add_w","coreir.add",{{"width",Const::make(c,awidth)}});
-    def->addInstance("c1","coreir.const",{{"width",Const::make(c,awidth)}},{{"value",Const::make(c,awidth,1)}});
-
-    if (!isPowerOfTwo(depth)) {
-
+    bool wrap = !isPowerOfTwo(depth);
+
+    Values awidthArgs = {{"width",Const::make(c,awidth)}};
+    Module* areg = c->getGenerator("mantle.reg")->getModule({{"width",Const::make(c,awidth)},{"has_en",Const::make(c,true)}});
+    Module* aadd = c->getGenerator("coreir.add")->getModule(awidthArgs);
+    Module* aconst = c->getGenerator("coreir.const")->getModule(awidthArgs);
+    std::vector<ModuleDef::InstanceDecl> decls = {
+      {"raddr",areg},
+      {"waddr",areg},
+      {"mem",c->getGenerator("coreir.mem")->getModule(genargs)},
+      {"add_r",aadd},
+      {"add_w",aadd},
+      {"c1",aconst,{{"value",Const::make(c,awidth,1)}}}
+    };
+    if (wrap) {
+      Module* amux = c->getGenerator("coreir.mux")->getModule(awidthArgs);
+      Module* aeq = c->getGenerator("coreir.eq")->getModule(awidthArgs);
       // Multiplexers to check max value
-      def->addInstance("raddr_mux", "coreir.mux", {{"width", Const::make(c, awidth)}});
-      def->addInstance("waddr_mux", "coreir.mux", {{"width", Const::make(c, awidth)}});
-
+      decls.push_back({"raddr_mux",amux});
+      decls.push_back({"waddr_mux",amux});
       // Equals to test if addresses are at the max
-      def->addInstance("raddr_eq", "coreir.eq", {{"width", Const::make(c, awidth)}});
-      def->addInstance("waddr_eq", "coreir.eq", {{"width", Const::make(c, awidth)}});
-    
+      decls.push_back({"raddr_eq",aeq});
+      decls.push_back({"waddr_eq",aeq});
       // Reset constant
-      def->addInstance("zero_const",
-                       "coreir.const",
-                       {{"width",Const::make(c,awidth)}},
-                       {{"value", Const::make(c, awidth, 0)}});
-
+      decls.push_back({"zero_const",aconst,{{"value",Const::make(c,awidth,0)}}});
       // Max constant
-      def->addInstance("max_const",
-                       "coreir.const",
-                       {{"width",Const::make(c,awidth)}},
-                       // Fix this for 64 bit constants!
-                       {{"value", Const::make(c, awidth, depth)}}); //(1 << awidth) - 1)}});
+      // Fix this for 64 bit constants!
+      decls.push_back({"max_const",aconst,{{"value",Const::make(c,awidth,depth)}}}); //(1 << awidth) - 1)}});
+    }
+    decls.push_back({"veq",c->getGenerator("coreir.neq")->getModule(awidthArgs)});
+    def->addInstances(decls);
+    auto inst = [def](const std::string& name) -> Wireable* { return def->getInstances().at(name); };
+    Wireable* self = def->getInterface();
+    Wireable* raddr = inst("raddr");
+    Wireable* waddr = inst("waddr");
+    Wireable* mem = inst("mem");
+    Wireable* add_r = inst("add_r");
+    Wireable* add_w = inst("add_w");
+    Wireable* c1 = inst("c1");
+    Wireable* veq = inst("veq");
+
+    std::vector<Connection> cons;
+    if (wrap) {
+      Wireable* raddr_mux = inst("raddr_mux");
+      Wireable* waddr_mux = inst("waddr_mux");
+      Wireable* raddr_eq = inst("raddr_eq");
+      Wireable* waddr_eq = inst("waddr_eq");
+      Wireable* zero_const = inst("zero_const");
+      Wireable* max_const = inst("max_const");
 
       // Wire up the resets
-      def->connect("raddr_eq.out", "raddr_mux.sel");
-      def->connect("waddr_eq.out", "waddr_mux.sel");
+      cons.emplace_back(raddr_eq->sel("out"),raddr_mux->sel("sel"));
+      cons.emplace_back(waddr_eq->sel("out"),waddr_mux->sel("sel"));
 
-      def->connect("zero_const.out", "raddr_mux.in1");
-      def->connect("zero_const.out", "waddr_mux.in1");
+      cons.emplace_back(zero_const->sel("out"),raddr_mux->sel("in1"));
+      cons.emplace_back(zero_const->sel("out"),waddr_mux->sel("in1"));
 
-      def->connect("add_r.out", "raddr_mux.in0");
-      def->connect("add_w.out", "waddr_mux.in0");
+      cons.emplace_back(add_r->sel("out"),raddr_mux->sel("in0"));
+      cons.emplace_back(add_w->sel("out"),waddr_mux->sel("in0"));
 
-      def->connect("waddr_mux.out", "waddr.in");
-      def->connect("raddr_mux.out", "raddr.in");
+      cons.emplace_back(waddr_mux->sel("out"),waddr->sel("in"));
+      cons.emplace_back(raddr_mux->sel("out"),raddr->sel("in"));
 
       // Wire up equals inputs
-      def->connect("add_r.out", "raddr_eq.in0");
-      def->connect("max_const.out", "raddr_eq.in1");
+      cons.emplace_back(add_r->sel("out"),raddr_eq->sel("in0"));
+      cons.emplace_back(max_const->sel("out"),raddr_eq->sel("in1"));
 
-      def->connect("add_w.out", "waddr_eq.in0");
-      def->connect("max_const.out", "waddr_eq.in1");
+      cons.emplace_back(add_w->sel("out"),waddr_eq->sel("in0"));
+      cons.emplace_back(max_const->sel("out"),waddr_eq->sel("in1"));
 
     } else {
-      def->connect("add_r.out","raddr.in");    
-      def->connect("add_w.out","waddr.in");
+      cons.emplace_back(add_r->sel("out"),raddr->sel("in"));
+      cons.emplace_back(add_w->sel("out"),waddr->sel("in"));
     }
 
     // Wire up the rest of the circuit
-    def->connect("self.wdata","mem.wdata");
+    cons.emplace_back(self->sel("wdata"),mem->sel("wdata"));
 
-    def->connect("self.wen","mem.wen");
-    def->connect("self.clk","mem.clk");
+    cons.emplace_back(self->sel("wen"),mem->sel("wen"));
+    cons.emplace_back(self->sel("clk"),mem->sel("clk"));
 
-    def->connect("waddr.out","mem.waddr");
-    def->connect("raddr.out","mem.raddr");
-    def->connect("mem.rdata","self.rdata");
+    cons.emplace_back(waddr->sel("out"),mem->sel("waddr"));
+    cons.emplace_back(raddr->sel("out"),mem->sel("raddr"));
+    cons.emplace_back(mem->sel("rdata"),self->sel("rdata"));
 
 
-    def->connect("add_r.in0","raddr.out");
-    def->connect("add_r.in1","c1.out");
+    cons.emplace_back(add_r->sel("in0"),raddr->sel("out"));
+    cons.emplace_back(add_r->sel("in1"),c1->sel("out"));
 
-    def->connect("waddr.en","self.wen");
-    def->connect("waddr.clk","self.clk");
+    cons.emplace_back(waddr->sel("en"),self->sel("wen"));
+    cons.emplace_back(waddr->sel("clk"),self->sel("clk"));
 
-    def->connect("raddr.en","self.wen");
-    def->connect("raddr.clk","self.clk");
+    cons.emplace_back(raddr->sel("en"),self->sel("wen"));
+    cons.emplace_back(raddr->sel("clk"),self->sel("clk"));
 
-    def->connect("add_w.in0","waddr.out");
-    def->connect("add_w.in1","c1.out");
+    cons.emplace_back(add_w->sel("in0"),waddr->sel("out"));
+    cons.emplace_back(add_w->sel("in1"),c1->sel("out"));
 
-    def->addInstance("veq","coreir.neq",{{"width",Const::make(c,awidth)}});
-    def->connect("veq.in0","raddr.out");
-    def->connect("veq.in1","waddr.out");
-    def->connect("veq.out","self.valid");
+    cons.emplace_back(veq->sel("in0"),raddr->sel("out"));
+    cons.emplace_back(veq->sel("in1"),waddr->sel("out"));
+    cons.emplace_back(veq->sel("out"),self->sel("valid"));
+    def->connectBulk(cons);
   });
 
 //// reference verilog code for lbmem
@@ -1843,6 +1886,12 @@ Namespace* CoreIRLoadLibrary_commonlib(Context* c) {
 
   // Not yet implemented
 
+  //Part of the key of the generator cache. Bump this whenever a generator
+  //above produces different definitions.
+  for (auto gpair : commonlib->getGenerators()) {
+    gpair.second->setVersion("1");
+  }
+
   return commonlib;
 }
 
@@ -6,120 +6,126 @@
 using namespace CoreIR;
 using namespace std;
 namespace {
-typedef vector<std::pair<string,string>> VStringPair;
 
 string tab(uint s) {
-  string ret = "";
-  for (uint i=0; i<s; ++i) {
-    ret += " ";
-  }
-  return ret;
-}
-string quote(string s) {
-  return "\""+s+"\"";
+  return string(s,' ');
 }
 
-class Dict {
-  string ts="";
-  vector<string> fields;
-  map<string,string> sorted;
-  public:
-    Dict(uint i) : ts(tab(i)) {}
-    Dict() {}
-    bool isEmpty() { return fields.size()==0;}
-    void add(string field,string val) { 
-      fields.push_back(quote(field)+":"+val);
-      sorted[field] = quote(field)+":"+val;
+//Streams json directly into the output. Objects and arrays are written either
+//on one line or across multiple lines indented by the given offset. In compact
+//mode no whitespace is written at all.
+class JsonWriter {
+  ostream& os;
+  bool compact;
+  struct Level {
+    string sep;
+    string close;
+    bool first;
+  };
+  vector<Level> levels;
+
+  void open(char o, char c, int indent, const string& singleSep) {
+    os << o;
+    if (compact) {
+      levels.push_back({",",string(1,c),true});
     }
-    string toMultiString(bool sort=false) {
-      if (sort) {
-        fields.clear();
-        for (auto fmap : sorted) {
-          fields.push_back(fmap.second);
-        }
-      }
-      return "{\n" + ts + "  " + join(fields.begin(),fields.end(),",\n"+ts+"  ") + "\n"+ts+"}";
+    else if (indent < 0) {
+      levels.push_back({singleSep,string(1,c),true});
     }
-    string toString() {
-      return "{"+join(fields.begin(),fields.end(),string(", ")) + "}";
+    else {
+      string ts = tab(indent);
+      os << "\n" << ts << "  ";
+      levels.push_back({",\n"+ts+"  ","\n"+ts+c,true});
     }
-
-};
-
-class Array {
-  string ts="";
-  vector<string> fields;
+  }
+  void next() {
+    Level& l = levels.back();
+    if (l.first) l.first = false;
+    else os << l.sep;
+  }
   public:
-    Array(uint i) : ts(tab(i)) {}
-    Array() {}
-    void add(string field) { fields.push_back(field);}
-    string toString() {
-      return "[" + join(fields.begin(),fields.end(),string(",")) + "]";
+    JsonWriter(ostream& os, bool compact) : os(os), compact(compact) {}
+    bool isCompact() { return compact; }
+    //indent < 0 means on a single line
+    void openDict(int indent=-1) { open('{','}',indent,", "); }
+    void openArray(int indent=-1) { open('[',']',indent,","); }
+    void close() {
+      os << levels.back().close;
+      levels.pop_back();
     }
-    string toMultiString() {
-      return "[\n" + ts + "  " + join(fields.begin(),fields.end(),",\n"+ts+"  ") + "\n"+ts+"]";
+    //Starts the next member of a dict
+    void key(const string& k) {
+      next();
+      os << "\"" << k << "\":";
     }
+    //Starts the next element of an array
+    void elem() { next(); }
+    void quote(const string& s) { os << "\"" << s << "\""; }
+    ostream& out() { return os; }
 };
 
-
-string ValueType2Json(ValueType* vt) {
+void ValueType2Json(JsonWriter& w, ValueType* vt) {
   if (auto bvt = dyn_cast<BitVectorType>(vt)) {
-    Array a;
-    a.add(quote("BitVector"));
-    a.add(to_string(bvt->getWidth()));
-    return a.toString();
+    w.openArray();
+    w.elem(); w.quote("BitVector");
+    w.elem(); w.out() << bvt->getWidth();
+    w.close();
+    return;
   }
-  return quote(vt->toString());
+  w.quote(vt->toString());
 }
 
 //Ordere these in order as well
-string Params2Json(Params gp) {
-  Dict j;
-  for (auto it : gp) j.add(it.first,ValueType2Json(it.second));
-  return j.toString();
+void Params2Json(JsonWriter& w, const Params& gp) {
+  w.openDict();
+  for (auto it : gp) {
+    w.key(it.first);
+    ValueType2Json(w,it.second);
+  }
+  w.close();
 }
 
-string Type2Json(Type* t);
-string Values2Json(Values vs);
-string Value2Json(Value* v) {
-  Array ret;
-  ret.add(ValueType2Json(v->getValueType()));
+void Type2Json(JsonWriter& w, Type* t);
+void Values2Json(JsonWriter& w, const Values& vs);
+void Value2Json(JsonWriter& w, Value* v) {
+  w.openArray();
+  w.elem(); ValueType2Json(w,v->getValueType());
   if (auto a = dyn_cast<Arg>(v)) {
-    ret.add(quote("Arg"));
-    ret.add(quote(a->getField()));
+    w.elem(); w.quote("Arg");
+    w.elem(); w.quote(a->getField());
   }
   else if (auto con = dyn_cast<Const>(v)) {
+    w.elem();
     if (auto cb = dyn_cast<ConstBool>(con)) {
-      ret.add(cb->get() ? "true" : "false");
+      w.out() << (cb->get() ? "true" : "false");
     }
     else if (auto ci = dyn_cast<ConstInt>(con)) {
-      ret.add(to_string(ci->get()));
+      w.out() << ci->get();
     }
     else if (auto cbv = dyn_cast<ConstBitVector>(con)) {
       BitVector bv = cbv->get();
-      ret.add(quote(bv.hex_string()));
+      w.quote(bv.hex_string());
     }
     else if (auto cs = dyn_cast<ConstString>(con)) {
-      ret.add(quote(cs->get()));
+      w.quote(cs->get());
     }
     else if (auto ct = dyn_cast<ConstCoreIRType>(con)) {
-      ret.add(Type2Json(ct->get()));
+      Type2Json(w,ct->get());
     }
     else if (auto at = dyn_cast<ConstModule>(con)) {
       Module* m = at->get();
       if (m->isGenerated()) {
-        Values args = m->getGenArgs();
-        Array modarray;
-        modarray.add(quote(m->getRefName()));
-        modarray.add(Values2Json(args));
-        ret.add(modarray.toString());
+        w.openArray();
+        w.elem(); w.quote(m->getRefName());
+        w.elem(); Values2Json(w,m->getGenArgs());
+        w.close();
       }
       else {
-        ret.add(quote(m->getRefName()));
+        w.quote(m->getRefName());
       }
     }
     else if (auto cj = dyn_cast<ConstJson>(con)) {
-      ret.add(CoreIR::toString(cj->get()));
+      w.out() << cj->get();
     }
     else {
       ASSERT(0,"NYI");
@@ -128,246 +134,290 @@ string Value2Json(Value* v) {
   else {
     ASSERT(0,"NYI");
   }
-  return ret.toString();
+  w.close();
 }
 
-string Values2Json(Values vs) {
-  Dict j;
-  for (auto it : vs) j.add(it.first,Value2Json(it.second));
-  return j.toString();
+void Values2Json(JsonWriter& w, const Values& vs) {
+  w.openDict();
+  for (auto it : vs) {
+    w.key(it.first);
+    Value2Json(w,it.second);
+  }
+  w.close();
 }
 
-string TopType2Json(Type* t,int taboffset) {
-  ASSERT(isa<RecordType>(t),"Expecting Record type but got " + t->toString());
-  Array a;
-  a.add(quote("Record"));
-  auto rt = cast<RecordType>(t);
-  Array r(taboffset);
+void RecordFields2Json(JsonWriter& w, RecordType* rt, int indent) {
+  w.openArray(indent);
   for (auto field : rt->getFields()) {
-    Array f;
-    f.add(quote(field));
-    f.add(Type2Json(rt->getRecord().at(field)));
-    r.add(f.toString());
+    w.elem();
+    w.openArray();
+    w.elem(); w.quote(field);
+    w.elem(); Type2Json(w,rt->getRecord().at(field));
+    w.close();
   }
-  a.add(r.toMultiString());
-  return a.toString();
+  w.close();
+}
+
+void TopType2Json(JsonWriter& w, Type* t,int taboffset) {
+  ASSERT(isa<RecordType>(t),"Expecting Record type but got " + t->toString());
+  w.openArray();
+  w.elem(); w.quote("Record");
+  w.elem(); RecordFields2Json(w,cast<RecordType>(t),taboffset);
+  w.close();
 }
 
 //One Line
-string Type2Json(Type* t) {
-  if (isa<BitType>(t)) return quote("Bit");
-  if (isa<BitInType>(t)) return quote("BitIn");
+void Type2Json(JsonWriter& w, Type* t) {
+  if (isa<BitType>(t)) return w.quote("Bit");
+  if (isa<BitInType>(t)) return w.quote("BitIn");
 
   if (isa<BitInOutType>(t)) {
-    return quote("BitInOut");
+    return w.quote("BitInOut");
   }
-  Array a;
+  w.openArray();
   if (auto nt = dyn_cast<NamedType>(t)) {
-    a.add(quote("Named"));
-    a.add(quote(nt->getNamespace()->getName() + "." + nt->getName()));
+    w.elem(); w.quote("Named");
+    w.elem(); w.quote(nt->getNamespace()->getName() + "." + nt->getName());
   }
   else if(auto at = dyn_cast<ArrayType>(t)) {
-    a.add(quote("Array"));
-    a.add(to_string(at->getLen()));
-    a.add(Type2Json(at->getElemType()));
+    w.elem(); w.quote("Array");
+    w.elem(); w.out() << at->getLen();
+    w.elem(); Type2Json(w,at->getElemType());
   }
   else if (auto rt = dyn_cast<RecordType>(t)) {
-    a.add(quote("Record"));
-    Array r;
-    for (auto field : rt->getFields()) {
-      Array f;
-      f.add(quote(field));
-      f.add(Type2Json(rt->getRecord().at(field)));
-      r.add(f.toString());
-    }
-    a.add(r.toString());
+    w.elem(); w.quote("Record");
+    w.elem(); RecordFields2Json(w,rt,-1);
   }
   else {
     assert(0);
   }
-  return a.toString();
+  w.close();
 }
 
-string Instances2Json(map<string,Instance*>& insts,int taboffset) {
-  Dict jis(taboffset);
-  for (auto imap : insts) {
-    string iname = imap.first;
+void Instances2Json(JsonWriter& w, const map<string,Instance*>& insts,int taboffset) {
+  w.openDict(taboffset);
+  for (auto& imap : insts) {
     Instance* i = imap.second;
-    Dict j(taboffset+2);
+    w.key(imap.first);
+    w.openDict(taboffset+2);
     Module* m = i->getModuleRef();
     if (m->isGenerated()) {
-      j.add("genref",quote(m->getGenerator()->getRefName()));
-      j.add("genargs",Values2Json(m->getGenArgs()));
+      w.key("genref"); w.quote(m->getGenerator()->getRefName());
+      w.key("genargs"); Values2Json(w,m->getGenArgs());
     }
     else {
-      j.add("modref",quote(i->getModuleRef()->getNamespace()->getName() + "." + i->getModuleRef()->getName()));
+      w.key("modref"); w.quote(m->getNamespace()->getName() + "." + m->getName());
     }
     if (i->hasModArgs()) {
-      j.add("modargs",Values2Json(i->getModArgs()));
+      w.key("modargs"); Values2Json(w,i->getModArgs());
     }
     if (i->hasMetaData()) {
-      j.add("metadata",toString(i->getMetaData()));
+      w.key("metadata"); w.out() << i->getMetaData();
     }
-    jis.add(iname,j.toMultiString());
+    w.close();
   }
-  return jis.toMultiString();
+  w.close();
 }
 
-string Connections2Json(ModuleDef* def,int taboffset) {
-  Array a(taboffset);
-  
+void Connections2Json(JsonWriter& w, ModuleDef* def,int taboffset) {
+  w.openArray(taboffset);
   for (auto con : def->getSortedConnections()) {
-    auto pa = con.first->getSelectPath();
-    auto pb = con.second->getSelectPath();
+    SelectPath pa = con.first->getSelectPath();
+    SelectPath pb = con.second->getSelectPath();
     string sa = join(pa.begin(),pa.end(),string("."));
     string sb = join(pb.begin(),pb.end(),string("."));
-    Array b;
-    if (sa > sb) {
-      b.add(quote(sa));
-      b.add(quote(sb));
-    }
-    else {
-      b.add(quote(sb));
-      b.add(quote(sa));
-    }
+    w.elem();
+    w.openArray();
+    w.elem(); w.quote(sa > sb ? sa : sb);
+    w.elem(); w.quote(sa > sb ? sb : sa);
     if (def->hasMetaData(con.first,con.second)) {
-      b.add(toString(def->getMetaData(con.first,con.second)));
+      w.elem(); w.out() << def->getMetaData(con.first,con.second);
     }
-    a.add(b.toString());
-
+    w.close();
   }
-  return a.toMultiString();
+  w.close();
 }
 
-string Module2Json(Module* m, int taboffset) {
-  Dict j(taboffset);
-  j.add("type",TopType2Json(m->getType(),taboffset+2));
+void Module2Json(JsonWriter& w, Module* m, int taboffset) {
+  w.openDict(taboffset);
+  w.key("type"); TopType2Json(w,m->getType(),taboffset+2);
   if (!m->getModParams().empty()) {
-    j.add("modparams",Params2Json(m->getModParams()));
+    w.key("modparams"); Params2Json(w,m->getModParams());
   }
   if (!m->getDefaultModArgs().empty()) {
-    j.add("defaultmodargs",Values2Json(m->getDefaultModArgs()));
+    w.key("defaultmodargs"); Values2Json(w,m->getDefaultModArgs());
   }
   if (m->hasDef()) {
     ModuleDef* def = m->getDef();
     if (!def->getInstances().empty()) {
-      auto insts = def->getInstances();
-      j.add("instances",Instances2Json(insts, taboffset+2));
+      w.key("instances"); Instances2Json(w,def->getInstances(),taboffset+2);
     }
     if (!def->getConnections().empty()) {
-      j.add("connections",Connections2Json(def,taboffset+2));
+      w.key("connections"); Connections2Json(w,def,taboffset+2);
     }
   }
   if (m->hasMetaData()) {
-    j.add("metadata",toString(m->getMetaData()));
+    w.key("metadata"); w.out() << m->getMetaData();
   }
-  return j.toMultiString();
+  w.close();
 }
 
-Json Generator2Json(Generator* g) {
-  Dict j(6);
-  j.add("typegen",quote(g->getTypeGen()->getNamespace()->getName() + "."+g->getTypeGen()->getName()));
-  j.add("genparams",Params2Json(g->getGenParams()));
+void Generator2Json(JsonWriter& w, Generator* g) {
+  w.openDict(6);
+  w.key("typegen"); w.quote(g->getTypeGen()->getNamespace()->getName() + "."+g->getTypeGen()->getName());
+  w.key("genparams"); Params2Json(w,g->getGenParams());
   auto genmods = g->getGeneratedModules();
   if (!genmods.empty()) {
-    Array gms(8);
+    w.key("modules");
+    w.openArray(8);
     for (auto genmodp : genmods) {
       Module* m = genmodp.second;
-      Array gm;
-      gm.add(Values2Json(m->getGenArgs()));
-      gm.add(Module2Json(m,10));
-      gms.add(gm.toString());
+      w.elem();
+      w.openArray();
+      w.elem(); Values2Json(w,m->getGenArgs());
+      w.elem(); Module2Json(w,m,10);
+      w.close();
     }
-    j.add("modules",gms.toMultiString());
+    w.close();
   }
   if (!g->getDefaultGenArgs().empty()) {
-    j.add("defaultgenargs",Values2Json(g->getDefaultGenArgs()));
+    w.key("defaultgenargs"); Values2Json(w,g->getDefaultGenArgs());
   }
   if (g->hasMetaData()) {
-    j.add("metadata",toString(g->getMetaData()));
+    w.key("metadata"); w.out() << g->getMetaData();
   }
-  return j.toMultiString();
+  w.close();
 }
-}//anonomous namespace
 
-string Passes::CoreIRJson::ID = "coreirjson";
-bool Passes::CoreIRJson::runOnNamespace(Namespace* ns) {
-  Dict jns(2);
-  auto modlist = ns->getModules(false);
-  if (!modlist.empty()) {
-    Dict jmod(4);
-    for (auto m : modlist) {
-      string mname = m.first;
-      if (m.second->isGenerated()) mname = m.second->getGenerator()->getName();
-      jmod.add(mname,Module2Json(m.second,6));
+void Modules2Json(JsonWriter& w, const map<string,Module*>& modlist) {
+  w.key("modules");
+  w.openDict(4);
+  for (auto m : modlist) {
+    string mname = m.first;
+    if (m.second->isGenerated()) mname = m.second->getGenerator()->getName();
+    w.key(mname);
+    Module2Json(w,m.second,6);
+  }
+  w.close();
+}
+
+void Generators2Json(JsonWriter& w, const map<string,Generator*>& genlist) {
+  w.key("generators");
+  w.openDict(4);
+  for (auto g : genlist) {
+    w.key(g.first);
+    Generator2Json(w,g.second);
+  }
+  w.close();
+}
+
+void TypeGens2Json(JsonWriter& w, const map<string,TypeGen*>& tglist) {
+  w.key("typegens");
+  w.openDict(4);
+  //Spit out all of the cached types.
+  for (auto tgpair : tglist) {
+    TypeGen* tg = tgpair.second;
+    w.key(tgpair.first);
+    w.openArray();
+    w.elem(); Params2Json(w,tg->getParams());
+    if (tg->getCached().size()==0) {
+      w.elem(); w.quote("implicit");
     }
-    if (!jmod.isEmpty()) {
-      jns.add("modules",jmod.toMultiString());
+    else {
+      w.elem(); w.quote("sparse");
+      w.elem();
+      w.openArray(6);
+      for (auto vtpair : tg->getCached()) {
+        w.elem();
+        w.openArray();
+        w.elem(); Values2Json(w,vtpair.first);
+        w.elem(); Type2Json(w,vtpair.second);
+        w.close();
+      }
+      w.close();
     }
+    w.close();
+  }
+  w.close();
+}
+
+void Namespace2Json(JsonWriter& w, Namespace* ns) {
+  w.openDict(2);
+  auto modlist = ns->getModules(false);
+  if (!modlist.empty()) {
+    Modules2Json(w,modlist);
   }
   if (!ns->getGenerators().empty()) {
-    Dict jgen(4);
-    for (auto g : ns->getGenerators()) jgen.add(g.first,Generator2Json(g.second));
-    jns.add("generators",jgen.toMultiString());
+    Generators2Json(w,ns->getGenerators());
   }
-  //if (!namedTypeNameMap.empty()) {
-  //  ASSERT(0,"NYI");
-    //Dict jntypes;
-    //for (auto nPair : namedTypeNameMap) {
-    //  string n = nPair.first;
-    //  string nFlip = nPair.second;
-    //  NamedType* nt = namedTypeList.at(n);
-    //  Type* raw = nt->getRaw();
-    //  json jntype = {
-    //    {"flippedname",nFlip},
-    //    {"rawtype", raw->toJson()}
-    //  };
-    //  jntypes[n] = jntype;
-    //}
-    //j["namedtypes"] = jntypes;
-  //} 
   if (!ns->getTypeGens().empty()) {
-    Dict jtypegens(4);
-    //Spit out all of the cached types.
-    for (auto tgpair : ns->getTypeGens()) {
-      string tgname = tgpair.first;
-      TypeGen* tg = tgpair.second;
-      Array jtypegen;
-      jtypegen.add(Params2Json(tg->getParams()));
-      if (tg->getCached().size()==0) {
-        jtypegen.add(quote("implicit"));
-      }
-      else {
-        jtypegen.add(quote("sparse"));
-        Array jsparselist(6);
-        for (auto vtpair : tg->getCached()) {
-          Array jvtpair;
-          jvtpair.add(Values2Json(vtpair.first));
-          jvtpair.add(Type2Json(vtpair.second));
-          jsparselist.add(jvtpair.toString());
-        }
-        jtypegen.add(jsparselist.toMultiString());
-      }
-      jtypegens.add(tgname,jtypegen.toString());
-    }
-    jns.add("typegens",jtypegens.toMultiString());
+    TypeGens2Json(w,ns->getTypeGens());
   }
-  nsMap[ns->getName()] = jns.toMultiString();
+  w.close();
+}
+
+//Writes a whole document that only has the namespace ns, filled in by body
+void writeNamespaceDocument(ostream& os, Namespace* ns, bool compact, std::function<void(JsonWriter&)> body) {
+  JsonWriter w(os,compact);
+  os << "{";
+  if (!compact) os << "\n";
+  os << "\"namespaces\":";
+  w.openDict(0);
+  w.key(ns->getName());
+  w.openDict(2);
+  body(w);
+  w.close();
+  w.close();
+  if (!compact) os << "\n";
+  os << "}" << endl;
+}
+
+}//anonomous namespace
+
+string Passes::CoreIRJson::ID = "coreirjson";
+bool Passes::CoreIRJson::runOnNamespace(Namespace* ns) {
+  nsMap[ns->getName()] = ns;
   return false;
 }
 
 
-void Passes::CoreIRJson::writeToStream(std::ostream& os,string topRef) {
+void Passes::CoreIRJson::writeToStream(std::ostream& os,string topRef,bool compact) {
+  JsonWriter w(os,compact);
   os << "{";
   if (topRef!="") {
-    os << quote("top") << ":" << quote(topRef) << ",";
+    os << "\"top\":\"" << topRef << "\",";
   }
-  os << endl;
-  Dict jn(0);
+  if (!compact) os << "\n";
+  os << "\"namespaces\":";
+  w.openDict(0);
   for (auto nmap : nsMap) {
-    jn.add(nmap.first,nmap.second);
+    w.key(nmap.first);
+    Namespace2Json(w,nmap.second);
   }
-  os << quote("namespaces") << ":" << jn.toMultiString();
-  os << endl << "}" << endl;
+  w.close();
+  if (!compact) os << "\n";
+  os << "}" << endl;
 }
 
+void Passes::CoreIRJson::writeGlobalValueToStream(std::ostream& os, GlobalValue* gv, bool compact) {
+  writeNamespaceDocument(os,gv->getNamespace(),compact,[gv](JsonWriter& w) {
+    if (auto m = dyn_cast<Module>(gv)) {
+      ASSERT(!m->isGenerated(),"Generated modules are written with their generator: " + m->getRefName());
+      Modules2Json(w,{{m->getName(),m}});
+    }
+    else {
+      Generators2Json(w,{{gv->getName(),cast<Generator>(gv)}});
+    }
+  });
+}
+
+void Passes::CoreIRJson::writeTypeGensToStream(std::ostream& os, Namespace* ns, bool compact) {
+  writeNamespaceDocument(os,ns,compact,[ns](JsonWriter& w) {
+    TypeGens2Json(w,ns->getTypeGens());
+  });
+}
+
+void Passes::CoreIRJson::writeModuleToStream(std::ostream& os, Module* m, bool compact) {
+  JsonWriter w(os,compact);
+  Module2Json(w,m,0);
+}
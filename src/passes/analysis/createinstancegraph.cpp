@@ -6,7 +6,7 @@ using namespace std;
 
 std::string Passes::CreateInstanceGraph::ID = "createinstancegraph";
 bool Passes::CreateInstanceGraph::runOnContext(Context* c) {
-  ig->construct(c);
+  if (!ig->isConstructed()) ig->construct(c);
   return false;
 }
 void Passes::CreateInstanceGraph::releaseMemory() {
@@ -36,7 +36,7 @@ bool Passes::SMV::runOnInstanceGraphNode(InstanceGraphNode& node) {
   }
 
   if (this->getContext()->hasTop() &&
-      this->getContext()->getTop()->getMetaData().count("properties") > 0) {
+      this->getContext()->getTop()->hasMetaData("properties")) {
     json jprop = this->getContext()->getTop()->getMetaData()["properties"];
     if (jprop.size()) {
       for (uint i=0; i<jprop.size(); i++) {
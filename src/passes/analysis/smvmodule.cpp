@@ -59,10 +59,8 @@ string SMVModule::toInstanceString(Instance* inst, string path) {
     args[amap.first] = amap.second;
   }
   vector<string> params;
-  const json& jmeta = mref->getMetaData();
-  
-  if (jmeta.count("verilog") && jmeta["verilog"].count("parameters")) {
-    params = jmeta["verilog"]["parameters"].get<vector<string>>();
+  if (mref->hasMetaData("verilog") && mref->getMetaData()["verilog"].count("parameters")) {
+    params = mref->getMetaData()["verilog"]["parameters"].get<vector<string>>();
   }
   else {
     for (auto amap : args) {
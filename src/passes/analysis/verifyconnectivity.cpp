@@ -7,8 +7,7 @@ using namespace CoreIR;
 
 namespace {
 bool IsVerilogDefn(ModuleDef* defn) {
-  const auto& metadata = defn->getModule()->getMetaData();
-  return metadata.count("verilog") > 0;
+  return defn->getModule()->hasMetaData("verilog");
 }
 }
 
@@ -47,7 +46,7 @@ bool Passes::VerifyConnectivity::checkIfFullyConnected(Wireable* w,Error& e) {
     e.message("{"+w->getContainer()->getName() + "}." + w->toString()+" Is not fully connected (N)");
     return false;
   }
-  if (w->getSelects().size()==0) {
+  if (w->getSymbolSelects().size()==0) {
     w->getContainer()->print();
     e.message("{"+w->getContainer()->getName() + "}." + w->toString()+" Is not connected");
     if (w->getContainer()->getModule()->isGenerated()) {
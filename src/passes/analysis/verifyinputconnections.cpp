@@ -7,7 +7,7 @@ using namespace CoreIR;
 namespace {
 //True is error
 //False is no error
-bool checkTypes(Wireable* a, Wireable* b) {
+bool checkTypes(Wireable* a, Wireable* b, vector<Error>& errors) {
   Context* c = a->getContext();
   Type* ta = a->getType();
   Type* tb = b->getType();
@@ -22,7 +22,7 @@ bool checkTypes(Wireable* a, Wireable* b) {
   e.message("Cannot wire together");
   e.message("  " + a->toString() + " : " + a->getType()->toString());
   e.message("  " + b->toString() + " : " + b->getType()->toString());
-  c->error(e);
+  errors.push_back(e);
   return true;
 }
 
@@ -39,7 +39,7 @@ bool checkInputConnected(Wireable* w, Error* e) {
     return true;
   }
   bool err = false;
-  for (auto it : w->getSelects()) {
+  for (auto it : w->getSymbolSelects()) {
     err |= checkInputConnected(it.second,e);
   }
   return err;
@@ -60,13 +60,13 @@ bool checkInputOutputs(Wireable* w, Error* e) {
     return true;
   }
   else if (numwires==0 ) {
-    for ( auto it : w->getSelects()) {
+    for ( auto it : w->getSymbolSelects()) {
       err |= checkInputOutputs(it.second,e);
     }
   }
   else if (numwires==1) {
     // Check if any children is an input and connected
-    for ( auto it : w->getSelects()) {
+    for ( auto it : w->getSymbolSelects()) {
       if(checkInputConnected(it.second,e)) {
         err = true;
         for (auto other : w->getConnectedWireables() )
@@ -86,12 +86,11 @@ string Passes::VerifyInputConnections::ID = "verifyinputconnections";
 bool Passes::VerifyInputConnections::runOnModule(Module* m) {
   if (!m->hasDef()) return false;
   ModuleDef* mdef = m->getDef();
-  Context* c = this->getContext();
   
-  bool err = false;
+  vector<Error> merrors;
   // Check for type compatability of every connection
   for (auto connection : mdef->getConnections() ) {
-    err |= checkTypes(connection.first,connection.second);
+    checkTypes(connection.first,connection.second,merrors);
   }
   
   //Check if an input is connected to multiple outputs
@@ -106,10 +105,25 @@ bool Passes::VerifyInputConnections::runOnModule(Module* m) {
     e.message("Cannot connect multiple outputs to an inputs");
     e.message("In Module: " + m->getName());
     if (checkInputOutputs(w,&e)) {
-      err = true;
-      c->error(e);
+      merrors.push_back(e);
     }
   }
-  if (err) c->die();
+  if (merrors.size()) {
+    std::lock_guard<std::mutex> lock(errorLock);
+    //Generated modules share a ref name, so they are keyed by the long name
+    auto& slot = errors[m->getLongName()];
+    slot.insert(slot.end(),merrors.begin(),merrors.end());
+  }
+  return false;
+}
+
+bool Passes::VerifyInputConnections::finalize() {
+  if (errors.empty()) return false;
+  Context* c = this->getContext();
+  for (auto& merrors : errors) {
+    for (auto& e : merrors.second) c->error(e);
+  }
+  errors.clear();
+  c->die();
   return false;
 }
@@ -1,7 +1,10 @@
 #include <fstream>
+#include <iomanip>
+#include <cstdio>
 #include "coreir.h"
 #include "coreir/passes/analysis/vmodule.h"
 #include "coreir/passes/analysis/verilog.h"
+#include "coreir/ir/parallel.h"
 #include "coreir/tools/cxxopts.h"
 
 namespace CoreIR {
@@ -48,26 +51,93 @@ bool Passes::Verilog::runOnInstanceGraphNode(InstanceGraphNode& node) {
   return false;
 }
 
-void Passes::Verilog::writeToStream(std::ostream& os) {
+std::vector<const Passes::VerilogNamespace::VModule*> Passes::Verilog::getModulesToWrite() {
+  vmods.buildAll(getContext());
+  std::vector<const VerilogNamespace::VModule*> modules;
   for (auto module : vmods.vmods) {
     if (vmods._inline && module->inlineable) {
       continue;
     }
-    WriteModuleToStream(module, os);
+    modules.push_back(module);
   }
+  return modules;
 }
 
+//Modules are printed concurrently but written in order
+void Passes::Verilog::writeToStream(std::ostream& os) {
+  auto modules = getModulesToWrite();
+  std::vector<std::ostringstream> outs(modules.size());
+  parallelFor(getContext(),modules.size(),[&](size_t i) {
+    WriteModuleToStream(modules[i], outs[i]);
+  });
+  for (auto& out : outs) {
+    os << out.str();
+  }
+  os.flush();
+}
+
+//Hashes of the written files are kept next to them. A module whose hash did
+//not change is neither built nor rewritten so that its timestamp is kept.
 void Passes::Verilog::writeToFiles(const std::string& dir) {
+  const std::string manifestname = dir + "/.coreir_verilog.json";
+  json jold = json::object();
+  {
+    std::ifstream fin(manifestname);
+    if (fin.is_open()) {
+      try {
+        fin >> jold;
+        if (!jold.is_object() || jold.value("version",0)!=1) jold = json::object();
+      } catch (std::exception&) {
+        jold = json::object();
+      }
+    }
+  }
+
+  std::vector<VerilogNamespace::VModule*> modules;
   for (auto module : vmods.vmods) {
-    if (vmods._inline && module->inlineable) {
-      continue;
+    if (vmods._inline && module->inlineable) continue;
+    modules.push_back(module);
+  }
+  const json jfiles = jold.value("files",json::object());
+  std::vector<std::string> hashes(modules.size());
+  std::vector<char> skip(modules.size(),false);
+  parallelFor(getContext(),modules.size(),[&](size_t i) {
+    //Only coreir modules are expensive enough to need a key of their own
+    auto cmod = dynamic_cast<VerilogNamespace::CoreIRVModule*>(modules[i]);
+    std::string key = cmod ? cmod->getContentKey() : modules[i]->toString();
+    std::ostringstream hash;
+    hash << std::hex << std::setfill('0') << std::setw(16) << hashString(std::to_string(modules[i]->isExternal) + key);
+    hashes[i] = hash.str();
+    const std::string filename = modules[i]->modname + ".v";
+    skip[i] = jfiles.count(filename) && jfiles.at(filename)==hashes[i]
+      && std::ifstream(dir + "/" + filename).good();
+  });
+
+  parallelFor(getContext(),modules.size(),[&](size_t i) {
+    if (skip[i]) return;
+    if (auto cmod = dynamic_cast<VerilogNamespace::CoreIRVModule*>(modules[i])) {
+      cmod->build();
     }
-    const std::string filename = dir + "/" + module->modname + ".v";
+    const std::string filename = dir + "/" + modules[i]->modname + ".v";
     std::ofstream fout(filename);
     ASSERT(fout.is_open(), "Cannot open file: " + filename);
-    WriteModuleToStream(module, fout);
+    WriteModuleToStream(modules[i], fout);
     fout.close();
+  });
+
+  json jmanifest;
+  jmanifest["version"] = 1;
+  jmanifest["files"] = json::object();
+  for (size_t i=0; i<modules.size(); ++i) {
+    jmanifest["files"][modules[i]->modname + ".v"] = hashes[i];
+  }
+  const std::string tmpname = manifestname + ".tmp";
+  {
+    std::ofstream fout(tmpname);
+    ASSERT(fout.is_open(), "Cannot open file: " + tmpname);
+    fout << jmanifest.dump(2) << std::endl;
   }
+  ASSERT(rename(tmpname.c_str(),manifestname.c_str())==0, "Cannot move " + tmpname + " to " + manifestname);
 }
 
 Passes::Verilog::~Verilog() {
@@ -2,6 +2,7 @@
 
 #include "coreir.h"
 #include "coreir/passes/analysis/vmodule.h"
+#include "coreir/ir/parallel.h"
 
 namespace CoreIR {
 namespace Passes {
@@ -18,11 +19,17 @@ CoreIRVModule::CoreIRVModule(VModules* vmods, Module* m) : VModule(vmods) {
   }
   this->addParams(m->getModParams());
   this->addDefaults(m->getDefaultModArgs());
-  ModuleDef* def = m->getDef();
+  //Materialized here since lazy definitions cannot be loaded concurrently
+  this->def = m->getDef();
+}
+
+void CoreIRVModule::build() {
+  if (built) return;
+  built = true;
   for (auto imap : def->getInstances()) {
     this->addInstance(imap.second);
   }
-  if (vmods->_inline) {
+  if (this->vmods->_inline) {
     this->addConnectionsInlined(def);
   }
   else {
@@ -147,10 +154,10 @@ std::string CoreIRVModule::get_replace_str(std::string input_name, Instance* ins
 std::string CoreIRVModule::inline_instance(ModuleDef* def, std::queue<Connection> &worklist, Instance* right_parent) {
     std::string right_conn_str = "";
     Module* right_parent_module = right_parent->getModuleRef();
-    VModule* right_parent_verilog_module = vmods->mod2VMod[right_parent_module];
+    VModule* right_parent_verilog_module = vmods->getVModule(right_parent_module);
     if (auto vermod = dynamic_cast<VerilogVModule*>(right_parent_verilog_module)) {
         if (vmods->_inline && right_parent_verilog_module->inlineable) {
-            right_conn_str = vermod->jver["definition"].get<string>();
+            right_conn_str = vermod->jver.at("definition").get<string>();
             // assumes that if it's inlineable it only has one output named out
 
             // replace assign out = since that will be handled by the
@@ -275,7 +282,7 @@ void CoreIRVModule::addConnectionsInlined(ModuleDef* def) {
 //Need to choose if I am going to inline
 void CoreIRVModule::addInstance(Instance* inst) {
   Module* mref = inst->getModuleRef();
-  VModule* vmref = vmods->mod2VMod[mref];
+  VModule* vmref = vmods->getVModule(mref);
   if (auto vermod = dynamic_cast<VerilogVModule*>(vmref)) {
     if (vmods->_inline && vermod->inlineable) {
       // skip inlined instance
@@ -311,9 +318,9 @@ void VModules::addModule(Module* m) {
   bool hasDef = m->hasDef();
   bool genHasVerilog = false;
   if (isGen) {
-    genHasVerilog = g->getMetaData().count("verilog") > 0;
+    genHasVerilog = g->hasMetaData("verilog");
   }
-  bool modHasVerilog = m->getMetaData().count("verilog") > 0;
+  bool modHasVerilog = m->hasMetaData("verilog");
   // Linking concerns:
   //   Two Verilog defs, should be an error.
   ASSERT(!(modHasVerilog && genHasVerilog),"Linking issue!");
@@ -346,12 +353,47 @@ void VModules::addModule(Module* m) {
   }
   else {
     //m is either gen or not
-    vmod = new CoreIRVModule(this,m);
+    auto cvmod = new CoreIRVModule(this,m);
+    unbuilt.push_back(cvmod);
+    vmod = cvmod;
   }
   mod2VMod[m] = vmod;
   vmods.push_back(vmod);
 }
 
+string CoreIRVModule::getContentKey() const {
+  ostringstream o;
+  o << modname << "\n" << modComment << "\n";
+  o << "inline:" << vmods->_inline << " debug:" << vmods->_verilator_debug << "\n";
+  o << getStructuralKey(def->getModule());
+  for (auto imap : def->getInstances()) {
+    Module* mref = imap.second->getModuleRef();
+    VModule* vref = vmods->getVModule(mref);
+    o << "ref:" << imap.first << " " << mref->getType()->toString() << ::CoreIR::toString(mref->getModParams());
+    o << " " << (vref ? vref->getInstanceKey() : "") << "\n";
+  }
+  return o.str();
+}
+
+string VModule::getInstanceKey() const {
+  ostringstream o;
+  o << modname << (inlineable ? " inlineable" : "") << (isExternal ? " external" : "");
+  o << " params:" << join(params.begin(),params.end(),string(","));
+  o << " ports:";
+  for (auto& pmap : ports) {
+    o << pmap.first << "/" << pmap.second.isArray << "/" << pmap.second.dim << "/" << pmap.second.dir << ",";
+  }
+  o << " interface:" << join(interface.begin(),interface.end(),string(","));
+  return o.str();
+}
+
+void VModules::buildAll(Context* c) {
+  parallelFor(c,unbuilt.size(),[this](size_t i) {
+    unbuilt[i]->build();
+  });
+  unbuilt.clear();
+}
+
 string VModule::toString() const {
   // In the case that we want to blackbox the entirety of the module source, we
   // just return the verilog_string field.
@@ -406,13 +448,14 @@ string VModule::toString() const {
   return o.str();
 }
 
-string VModule::toInstanceString(Instance* inst) {
+//Can be called on the same VModule from concurrent builds, so this only reads
+string VModule::toInstanceString(Instance* inst) const {
   assert(this->modname != "");
   string instname = inst->getInstname();
   Module* mref = inst->getModuleRef();
-  SParams params_bk = this->params;
+  SParams params = this->params;
   for (auto p : mref->getModParams()) {
-    this->params.insert(p.first);
+    params.insert(p.first);
   }
 
   ostringstream o;
@@ -420,10 +463,11 @@ string VModule::toInstanceString(Instance* inst) {
   string mname;
   map<string,VWire> iports;
   Values args;
-  bool isVerilogGen = mref->isGenerated() && mref->getGenerator()->getMetaData().count("verilog") > 0;
+  bool isVerilogGen = mref->isGenerated() && mref->getGenerator()->hasMetaData("verilog");
   if (isVerilogGen) {
     args = mref->getGenArgs();
-    Type2Ports(mref->getGenerator()->getTypeGen()->getType(args),iports);
+    //Same as the type from the typegen, which might not be safe to call here
+    Type2Ports(mref->getType(),iports);
     mname = modname; 
   }
   else {
@@ -438,7 +482,7 @@ string VModule::toInstanceString(Instance* inst) {
   o << tab << mname << " ";
   
   vector<string> paramstrs;
-  for (auto param : this->params) {
+  for (auto param : params) {
     ASSERT(args.count(param),"Missing parameter " + param + " from " + ::CoreIR::toString(args));
 
     // TODO: Remove this when we have a better solution for verilog output
@@ -458,9 +502,6 @@ string VModule::toInstanceString(Instance* inst) {
   }
   o << instname << "(\n" << tab << tab << join(portstrs.begin(),portstrs.end(),",\n"+tab+tab) << "\n  );";
 
-  //TODO a bit of a hack. return params to original
-  this->params = params_bk;
-
   return o.str();
 }
 
@@ -0,0 +1,106 @@
+#include "coreir.h"
+#include "coreir/passes/transform/dedupmodules.h"
+
+using namespace std;
+using namespace CoreIR;
+
+namespace {
+//Picks which module of a group of duplicates survives
+Module* pickRepresentative(Context* c, const vector<Module*>& group) {
+  Module* rep = group[0];
+  for (auto m : group) {
+    if (c->hasTop() && c->getTop()==m) return m;
+    //Prefer modules the user declared over generated ones
+    if (rep->isGenerated() && !m->isGenerated()) rep = m;
+  }
+  return rep;
+}
+
+//Modules that Module values (modargs, genargs and their defaults) refer to.
+//Those values cannot be rewritten, genargs are the keys of the generated
+//modules, so these modules are never erased.
+set<Module*> getModuleValueRefs(Context* c) {
+  set<Module*> refs;
+  auto add = [&](const Values& vals) {
+    for (auto& vpair : vals) {
+      if (vpair.second->getKind()==Value::VK_ConstModule) {
+        refs.insert(vpair.second->get<Module*>());
+      }
+    }
+  };
+  for (auto npair : c->getNamespaces()) {
+    for (auto gpair : npair.second->getGenerators()) {
+      add(gpair.second->getDefaultGenArgs());
+    }
+    for (auto mpair : npair.second->getModules()) {
+      Module* m = mpair.second;
+      add(m->getDefaultModArgs());
+      if (m->isGenerated()) add(m->getGenArgs());
+      if (!m->hasDef()) continue;
+      for (auto ipair : m->getDef()->getInstances()) {
+        add(ipair.second->getModArgs());
+      }
+    }
+  }
+  return refs;
+}
+}
+
+string Passes::DedupModules::ID = "dedupmodules";
+bool Passes::DedupModules::runOnContext(Context* c) {
+  bool changed = false;
+  //Duplicates which could not be erased (generated or referenced ones)
+  set<Module*> retired;
+  //Redirecting instances does not change any values, so this stays valid
+  set<Module*> valueRefs = getModuleValueRefs(c);
+  while (true) {
+    //Group all the defined modules by structure
+    vector<Module*> allModules;
+    map<string,vector<Module*>> groups;
+    for (auto npair : c->getNamespaces()) {
+      for (auto mpair : npair.second->getModules()) {
+        Module* m = mpair.second;
+        allModules.push_back(m);
+        if (m->hasDef() && !retired.count(m)) {
+          groups[getStructuralKey(m)].push_back(m);
+        }
+      }
+    }
+    
+    unordered_map<Module*,Module*> replacement;
+    for (auto& gpair : groups) {
+      auto& group = gpair.second;
+      if (group.size() < 2) continue;
+      Module* rep = pickRepresentative(c,group);
+      for (auto m : group) {
+        if (m != rep) replacement[m] = rep;
+      }
+    }
+    if (replacement.empty()) break;
+
+    //Point every instance of a duplicate to its representative
+    for (auto m : allModules) {
+      if (!m->hasDef()) continue;
+      for (auto ipair : m->getDef()->getInstances()) {
+        Instance* inst = ipair.second;
+        auto it = replacement.find(inst->getModuleRef());
+        if (it != replacement.end()) {
+          inst->replace(it->second,inst->getModArgs());
+        }
+      }
+    }
+
+    //Generated modules are owned by their generator so only erase the others
+    for (auto rpair : replacement) {
+      Module* m = rpair.first;
+      if (m->isGenerated() || valueRefs.count(m)) {
+        retired.insert(m);
+      }
+      else {
+        m->getNamespace()->eraseModule(m->getName());
+      }
+    }
+    changed = true;
+  }
+  return changed;
+}
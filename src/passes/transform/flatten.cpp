@@ -6,10 +6,18 @@ using namespace CoreIR;
 
 string Passes::Flatten::ID = "flatten";
 bool Passes::Flatten::runOnInstanceGraphNode(InstanceGraphNode& node) {
+  Module* m = node.getModule();
+  if (!m->hasDef()) return false;
+  ModuleDef* def = m->getDef();
+
+  //The modules that are instanced here are already flat, so each of their
+  //instances is inlined once
+  vector<Instance*> insts;
+  for (auto inst = def->getInstancesIterBegin(); inst != def->getInstancesIterEnd(); inst = def->getInstancesIterNext(inst)) {
+    insts.push_back(inst);
+  }
   bool changed = false;
-  //int i = 0;
-  for (auto inst : node.getInstanceList()) {
-    //cout << "inlining " << i++ << endl;
+  for (auto inst : insts) {
     changed |= inlineInstance(inst);
   }
   return changed;
@@ -6,6 +6,12 @@ using namespace CoreIR;
 
 string Passes::MarkDirty::ID = "markdirty";
 bool Passes::MarkDirty::runOnContext(Context* c) {
+  //Every module is saved again by the next incremental save
+  for (auto nspair : c->getNamespaces()) {
+    for (auto mpair : nspair.second->getModules()) {
+      mpair.second->markDirty();
+    }
+  }
   //Always return modified
   return true;
 }
@@ -82,7 +82,9 @@ bool Passes::RegisterInputs::runOnInstanceGraphNode(InstanceGraphNode& node) {
   // }
 
   vector<Connection> toDelete;
-  for (auto& conn : def->getConnections()) {
+  //connect invalidates the iterators, so loop over a copy
+  vector<Connection> cons(def->getConnections().begin(),def->getConnections().end());
+  for (auto& conn : cons) {
     //cout << Connection2Str(conn) << " ";
 
     
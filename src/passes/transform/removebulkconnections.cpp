@@ -28,7 +28,9 @@ bool Passes::RemoveBulkConnections::runOnModule(Module* m) {
     hasChanged = false;
     //Loop through all connections
     vector<Connection> toRemove;
-    for (auto con : def->getConnections()) {
+    //connect invalidates the iterators, so loop over a copy
+    vector<Connection> cons(def->getConnections().begin(),def->getConnections().end());
+    for (auto con : cons) {
       Type* t = con.first->getType();
       if (isBitOrArrOfBits(t)) continue;
 
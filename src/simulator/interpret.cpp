@@ -398,7 +398,7 @@ namespace CoreIR {
     hasSymTable = false;
 
     // Create symbol table if it exists
-    if (mod->getMetaData().get<map<string,json>>().count("symtable")) {
+    if (mod->hasMetaData("symtable")) {
       hasSymTable = true;
       symTable =
         mod->getMetaData()["symtable"].get<map<string,json>>();
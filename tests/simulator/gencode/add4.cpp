@@ -0,0 +1,28 @@
+#include "add4.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint32_t  add00_out;
+uint32_t  add01_out;
+uint32_t  add1_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_out) = ((uint32_t) (((uint32_t) ((state->self_in0)  +  (state->self_in1)))  +  ((uint32_t) ((state->self_in2)  +  (state->self_in3)))));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
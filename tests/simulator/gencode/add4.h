@@ -0,0 +1,16 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint32_t self_out;
+	uint32_t self_in3;
+	uint32_t self_in2;
+	uint32_t self_in1;
+	uint32_t self_in0;
+};
+
+void simulate( circuit_state* __restrict const state );
@@ -0,0 +1,26 @@
+#include "add63.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint64_t  add0_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_output) = ((uint64_t) MASK(0b00000000000000000000000000111111, ((state->self_input)[0]  +  (state->self_input)[1])));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,13 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint64_t self_output;
+	uint64_t self_input[ 2 ];
+};
+
+void simulate( circuit_state* __restrict const state );
@@ -0,0 +1,30 @@
+#include "add_cin_cout.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint32_t  add0_out;
+uint8_t  add0_cout;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+add0_out = MASK( 31, (((state->self_in)[0]  +  (state->self_in)[1]) + (state->self_cin)) );
+add0_cout = (((((state->self_in)[0]  +  (state->self_in)[1]) + (state->self_cin)) >> 31) & 0x1);
+(state->self_out) = add0_out;
+(state->self_cout) = add0_cout;
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint32_t self_in[ 2 ];
+	uint8_t self_cin;
+	uint32_t self_out;
+	uint8_t self_cout;
+};
+
+void simulate( circuit_state* __restrict const state );
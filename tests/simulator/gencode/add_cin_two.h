@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_O;
+	uint8_t self_CIN;
+	uint8_t self_I1;
+	uint8_t self_I0;
+};
+
+void simulate( circuit_state* __restrict const state );
@@ -0,0 +1,30 @@
+#include "add_cout_16.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint16_t  add0_out;
+uint8_t  add0_cout;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+add0_out = ((state->self_in)[0]  +  (state->self_in)[1]);
+add0_cout = (((((uint16_t) ((state->self_in)[0] + (state->self_in)[1])) < ((uint16_t) (state->self_in)[0])) || (((uint16_t) ((state->self_in)[0] + (state->self_in)[1])) < ((uint16_t) (state->self_in)[1]))));
+(state->self_cout) = add0_cout;
+(state->self_out) = add0_out;
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,11 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+};
+
+void simulate( circuit_state* __restrict const state );
@@ -0,0 +1,39 @@
+#include "comb_then_reg.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint32_t  add0_out;
+uint32_t  reg0_out;
+
+// Simulation code
+add0_out = ((uint32_t) ((state->self_in_0)  +  (state->self_in_1)));
+(state->self_out_0) = add0_out;
+if (((state->self_clk_last) == 0) && ((state->self_clk) == 1)) {
+// All updates inside clock
+add0_out = ((uint32_t) ((state->self_in_0)  +  (state->self_in_1)));
+(state->reg0) = add0_out;
+reg0_out = (state->reg0);
+(state->self_out_1) = reg0_out;
+
+}
+
+// ----- Update pure combinational logic
+
+// ----- Done
+
+// ----- Setting last clock values
+(state->self_clk_last) = (state->self_clk);
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
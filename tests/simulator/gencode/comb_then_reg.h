@@ -0,0 +1,18 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_clk;
+	uint8_t self_clk_last;
+	uint32_t self_in_1;
+	uint32_t self_in_0;
+	uint32_t self_out_0;
+	uint32_t reg0;
+	uint32_t self_out_1;
+};
+
+void simulate( circuit_state* __restrict const state );
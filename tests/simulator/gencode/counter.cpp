@@ -0,0 +1,39 @@
+#include "counter.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint16_t  ci_out;
+uint16_t  ai_out;
+uint16_t  ri$enMux_out;
+uint16_t  ri$reg0_out;
+
+// Simulation code
+if (((state->self_clk_last) == 0) && ((state->self_clk) == 1)) {
+// All updates inside clock
+ri$reg0_out = (state->ri$reg0);
+(state->ri$reg0) = ((state->self_en) ? ((uint16_t) (0b0000000000000001  +  ri$reg0_out)) : ri$reg0_out);
+ri$reg0_out = (state->ri$reg0);
+(state->self_out) = ri$reg0_out;
+
+}
+
+// ----- Update pure combinational logic
+
+// ----- Done
+
+// ----- Setting last clock values
+(state->self_clk_last) = (state->self_clk);
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
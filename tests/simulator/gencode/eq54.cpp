@@ -0,0 +1,26 @@
+#include "eq54.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint8_t  eq0_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_out) = ((uint8_t) MASK(0b00000000000000000000000000000001, ((state->self_A)[0]  ==  (state->self_A)[1])));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,35 @@
+#include "long_register_no_enable.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+bit_vector< 103 >  r0$reg0_out;
+
+// Simulation code
+if (((state->self_clk_last) == 0) && ((state->self_clk) == 1)) {
+// All updates inside clock
+(state->r0$reg0) = (state->self_a);
+r0$reg0_out = (state->r0$reg0);
+(state->self_cout) = r0$reg0_out;
+
+}
+
+// ----- Update pure combinational logic
+
+// ----- Done
+
+// ----- Setting last clock values
+(state->self_clk_last) = (state->self_clk);
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
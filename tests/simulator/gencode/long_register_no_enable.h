@@ -0,0 +1,16 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_clk;
+	uint8_t self_clk_last;
+	bit_vector< 103 > r0$reg0;
+	bit_vector< 103 > self_a;
+	bit_vector< 103 > self_cout;
+};
+
+void simulate( circuit_state* __restrict const state );
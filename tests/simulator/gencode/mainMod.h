@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_d;
+	uint8_t self_c;
+	uint8_t self_b;
+	uint8_t self_a;
+};
+
+void simulate( circuit_state* __restrict const state );
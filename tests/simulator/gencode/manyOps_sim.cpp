@@ -0,0 +1,191 @@
+#include "manyOps_sim.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint16_t  or_17_out;
+uint16_t  and_18_out;
+uint16_t  and_16_out;
+uint16_t  or_23_out;
+uint16_t  and_20_out;
+uint16_t  or_15_out;
+uint16_t  and_14_out;
+uint16_t  and_22_out;
+uint16_t  or_13_out;
+uint16_t  and_12_out;
+uint16_t  and_2_out;
+uint16_t  or_5_out;
+uint16_t  and_0_out;
+uint16_t  or_3_out;
+uint16_t  and_6_out;
+uint16_t  or_25_out;
+uint16_t  or_7_out;
+uint16_t  and_24_out;
+uint16_t  and_26_out;
+uint16_t  and_4_out;
+uint16_t  or_1_out;
+uint16_t  or_21_out;
+uint16_t  or_19_out;
+uint16_t  and_8_out;
+uint16_t  or_9_out;
+uint16_t  and_10_out;
+uint16_t  or_11_out;
+uint16_t  or_27_out;
+uint16_t  and_28_out;
+uint16_t  or_29_out;
+uint16_t  and_30_out;
+uint16_t  reg_24_out;
+uint16_t  reg_16_out;
+uint16_t  reg_9_out;
+uint16_t  reg_19_out;
+uint16_t  reg_12_out;
+uint16_t  reg_17_out;
+uint16_t  reg_15_out;
+uint16_t  reg_20_out;
+uint16_t  reg_4_out;
+uint16_t  reg_26_out;
+uint16_t  reg_14_out;
+uint16_t  reg_22_out;
+uint16_t  reg_13_out;
+uint16_t  reg_27_out;
+uint16_t  reg_29_out;
+uint16_t  reg_5_out;
+uint16_t  reg_3_out;
+uint16_t  reg_21_out;
+uint16_t  reg_10_out;
+uint16_t  reg_6_out;
+uint16_t  reg_8_out;
+uint16_t  reg_18_out;
+uint16_t  reg_23_out;
+uint16_t  reg_1_out;
+uint16_t  reg_11_out;
+uint16_t  reg_0_out;
+uint16_t  reg_2_out;
+uint16_t  reg_7_out;
+uint16_t  reg_25_out;
+uint16_t  reg_28_out;
+uint16_t  reg_30_out;
+uint16_t  or_31_out;
+uint16_t  reg_31_out;
+
+// Simulation code
+if (((state->self_clk_last) == 0) && ((state->self_clk) == 1)) {
+// All updates inside clock
+(state->reg_17) = ((uint16_t) ((state->self_in_34)  |  (state->self_in_35)));
+reg_17_out = (state->reg_17);
+(state->self_out_17) = reg_17_out;
+(state->reg_12) = ((uint16_t) ((state->self_in_24)  &  (state->self_in_25)));
+reg_12_out = (state->reg_12);
+(state->self_out_12) = reg_12_out;
+(state->reg_13) = ((uint16_t) ((state->self_in_26)  |  (state->self_in_27)));
+reg_13_out = (state->reg_13);
+(state->self_out_13) = reg_13_out;
+(state->reg_22) = ((uint16_t) ((state->self_in_44)  &  (state->self_in_45)));
+reg_22_out = (state->reg_22);
+(state->self_out_22) = reg_22_out;
+(state->reg_3) = ((uint16_t) ((state->self_in_6)  |  (state->self_in_7)));
+reg_3_out = (state->reg_3);
+(state->self_out_3) = reg_3_out;
+(state->reg_18) = ((uint16_t) ((state->self_in_36)  &  (state->self_in_37)));
+reg_18_out = (state->reg_18);
+(state->self_out_18) = reg_18_out;
+(state->reg_15) = ((uint16_t) ((state->self_in_30)  |  (state->self_in_31)));
+reg_15_out = (state->reg_15);
+(state->self_out_15) = reg_15_out;
+(state->reg_14) = ((uint16_t) ((state->self_in_28)  &  (state->self_in_29)));
+reg_14_out = (state->reg_14);
+(state->self_out_14) = reg_14_out;
+(state->reg_23) = ((uint16_t) ((state->self_in_46)  |  (state->self_in_47)));
+reg_23_out = (state->reg_23);
+(state->self_out_23) = reg_23_out;
+(state->reg_24) = ((uint16_t) ((state->self_in_48)  &  (state->self_in_49)));
+reg_24_out = (state->reg_24);
+(state->self_out_24) = reg_24_out;
+(state->reg_4) = ((uint16_t) ((state->self_in_8)  &  (state->self_in_9)));
+reg_4_out = (state->reg_4);
+(state->self_out_4) = reg_4_out;
+(state->reg_21) = ((uint16_t) ((state->self_in_42)  |  (state->self_in_43)));
+reg_21_out = (state->reg_21);
+(state->self_out_21) = reg_21_out;
+(state->reg_0) = ((uint16_t) ((state->self_in_0)  &  (state->self_in_1)));
+reg_0_out = (state->reg_0);
+(state->self_out_0) = reg_0_out;
+(state->reg_2) = ((uint16_t) ((state->self_in_4)  &  (state->self_in_5)));
+reg_2_out = (state->reg_2);
+(state->self_out_2) = reg_2_out;
+(state->reg_1) = ((uint16_t) ((state->self_in_2)  |  (state->self_in_3)));
+reg_1_out = (state->reg_1);
+(state->self_out_1) = reg_1_out;
+(state->reg_20) = ((uint16_t) ((state->self_in_40)  &  (state->self_in_41)));
+reg_20_out = (state->reg_20);
+(state->self_out_20) = reg_20_out;
+(state->reg_7) = ((uint16_t) ((state->self_in_14)  |  (state->self_in_15)));
+reg_7_out = (state->reg_7);
+(state->self_out_7) = reg_7_out;
+(state->reg_16) = ((uint16_t) ((state->self_in_32)  &  (state->self_in_33)));
+reg_16_out = (state->reg_16);
+(state->self_out_16) = reg_16_out;
+(state->reg_19) = ((uint16_t) ((state->self_in_38)  |  (state->self_in_39)));
+reg_19_out = (state->reg_19);
+(state->self_out_19) = reg_19_out;
+(state->reg_5) = ((uint16_t) ((state->self_in_10)  |  (state->self_in_11)));
+reg_5_out = (state->reg_5);
+(state->self_out_5) = reg_5_out;
+(state->reg_8) = ((uint16_t) ((state->self_in_16)  &  (state->self_in_17)));
+reg_8_out = (state->reg_8);
+(state->self_out_8) = reg_8_out;
+(state->reg_6) = ((uint16_t) ((state->self_in_12)  &  (state->self_in_13)));
+reg_6_out = (state->reg_6);
+(state->self_out_6) = reg_6_out;
+(state->reg_9) = ((uint16_t) ((state->self_in_18)  |  (state->self_in_19)));
+reg_9_out = (state->reg_9);
+(state->self_out_9) = reg_9_out;
+(state->reg_11) = ((uint16_t) ((state->self_in_22)  |  (state->self_in_23)));
+reg_11_out = (state->reg_11);
+(state->self_out_11) = reg_11_out;
+(state->reg_10) = ((uint16_t) ((state->self_in_20)  &  (state->self_in_21)));
+reg_10_out = (state->reg_10);
+(state->self_out_10) = reg_10_out;
+(state->reg_25) = ((uint16_t) ((state->self_in_50)  |  (state->self_in_51)));
+reg_25_out = (state->reg_25);
+(state->self_out_25) = reg_25_out;
+(state->reg_26) = ((uint16_t) ((state->self_in_52)  &  (state->self_in_53)));
+reg_26_out = (state->reg_26);
+(state->self_out_26) = reg_26_out;
+(state->reg_27) = ((uint16_t) ((state->self_in_54)  |  (state->self_in_55)));
+reg_27_out = (state->reg_27);
+(state->self_out_27) = reg_27_out;
+(state->reg_28) = ((uint16_t) ((state->self_in_56)  &  (state->self_in_57)));
+reg_28_out = (state->reg_28);
+(state->self_out_28) = reg_28_out;
+(state->reg_29) = ((uint16_t) ((state->self_in_58)  |  (state->self_in_59)));
+reg_29_out = (state->reg_29);
+(state->self_out_29) = reg_29_out;
+(state->reg_30) = ((uint16_t) ((state->self_in_60)  &  (state->self_in_61)));
+reg_30_out = (state->reg_30);
+(state->self_out_30) = reg_30_out;
+(state->reg_31) = ((uint16_t) ((state->self_in_62)  |  (state->self_in_63)));
+reg_31_out = (state->reg_31);
+(state->self_out_31) = reg_31_out;
+
+}
+
+// ----- Update pure combinational logic
+
+// ----- Done
+
+// ----- Setting last clock values
+(state->self_clk_last) = (state->self_clk);
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,141 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_clk;
+	uint8_t self_clk_last;
+	uint16_t reg_17;
+	uint16_t self_in_35;
+	uint16_t self_in_34;
+	uint16_t self_out_17;
+	uint16_t reg_12;
+	uint16_t self_in_25;
+	uint16_t self_in_24;
+	uint16_t self_out_12;
+	uint16_t reg_13;
+	uint16_t self_in_27;
+	uint16_t self_in_26;
+	uint16_t self_out_13;
+	uint16_t reg_22;
+	uint16_t self_in_45;
+	uint16_t self_in_44;
+	uint16_t self_out_22;
+	uint16_t reg_3;
+	uint16_t self_in_7;
+	uint16_t self_in_6;
+	uint16_t self_out_3;
+	uint16_t reg_18;
+	uint16_t self_in_37;
+	uint16_t self_in_36;
+	uint16_t self_out_18;
+	uint16_t reg_15;
+	uint16_t self_in_31;
+	uint16_t self_in_30;
+	uint16_t self_out_15;
+	uint16_t reg_14;
+	uint16_t self_in_29;
+	uint16_t self_in_28;
+	uint16_t self_out_14;
+	uint16_t reg_23;
+	uint16_t self_in_47;
+	uint16_t self_in_46;
+	uint16_t self_out_23;
+	uint16_t reg_24;
+	uint16_t self_in_49;
+	uint16_t self_in_48;
+	uint16_t self_out_24;
+	uint16_t reg_4;
+	uint16_t self_in_9;
+	uint16_t self_in_8;
+	uint16_t self_out_4;
+	uint16_t reg_21;
+	uint16_t self_in_43;
+	uint16_t self_in_42;
+	uint16_t self_out_21;
+	uint16_t reg_0;
+	uint16_t self_in_1;
+	uint16_t self_in_0;
+	uint16_t self_out_0;
+	uint16_t reg_2;
+	uint16_t self_in_5;
+	uint16_t self_in_4;
+	uint16_t self_out_2;
+	uint16_t reg_1;
+	uint16_t self_in_3;
+	uint16_t self_in_2;
+	uint16_t self_out_1;
+	uint16_t reg_20;
+	uint16_t self_in_41;
+	uint16_t self_in_40;
+	uint16_t self_out_20;
+	uint16_t reg_7;
+	uint16_t self_in_15;
+	uint16_t self_in_14;
+	uint16_t self_out_7;
+	uint16_t reg_16;
+	uint16_t self_in_33;
+	uint16_t self_in_32;
+	uint16_t self_out_16;
+	uint16_t reg_19;
+	uint16_t self_in_39;
+	uint16_t self_in_38;
+	uint16_t self_out_19;
+	uint16_t reg_5;
+	uint16_t self_in_11;
+	uint16_t self_in_10;
+	uint16_t self_out_5;
+	uint16_t reg_8;
+	uint16_t self_in_17;
+	uint16_t self_in_16;
+	uint16_t self_out_8;
+	uint16_t reg_6;
+	uint16_t self_in_13;
+	uint16_t self_in_12;
+	uint16_t self_out_6;
+	uint16_t reg_9;
+	uint16_t self_in_19;
+	uint16_t self_in_18;
+	uint16_t self_out_9;
+	uint16_t reg_11;
+	uint16_t self_in_23;
+	uint16_t self_in_22;
+	uint16_t self_out_11;
+	uint16_t reg_10;
+	uint16_t self_in_21;
+	uint16_t self_in_20;
+	uint16_t self_out_10;
+	uint16_t reg_25;
+	uint16_t self_in_51;
+	uint16_t self_in_50;
+	uint16_t self_out_25;
+	uint16_t reg_26;
+	uint16_t self_in_53;
+	uint16_t self_in_52;
+	uint16_t self_out_26;
+	uint16_t reg_27;
+	uint16_t self_in_55;
+	uint16_t self_in_54;
+	uint16_t self_out_27;
+	uint16_t reg_28;
+	uint16_t self_in_57;
+	uint16_t self_in_56;
+	uint16_t self_out_28;
+	uint16_t reg_29;
+	uint16_t self_in_59;
+	uint16_t self_in_58;
+	uint16_t self_out_29;
+	uint16_t reg_30;
+	uint16_t self_in_61;
+	uint16_t self_in_60;
+	uint16_t self_out_30;
+	uint16_t reg_31;
+	uint16_t self_in_63;
+	uint16_t self_in_62;
+	uint16_t self_out_31;
+};
+
+void simulate( circuit_state* __restrict const state );
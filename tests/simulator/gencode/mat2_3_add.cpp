@@ -0,0 +1,36 @@
+#include "mat2_3_add.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint64_t  add1_0_out;
+uint64_t  add0_2_out;
+uint64_t  add1_1_out;
+uint64_t  add0_1_out;
+uint64_t  add0_0_out;
+uint64_t  add1_2_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_out)[1][1] = ((uint64_t) ((state->self_A)[1][1]  +  (state->self_B)[1][1]));
+(state->self_out)[0][2] = ((uint64_t) ((state->self_A)[0][2]  +  (state->self_B)[0][2]));
+(state->self_out)[0][0] = ((uint64_t) ((state->self_A)[0][0]  +  (state->self_B)[0][0]));
+(state->self_out)[0][1] = ((uint64_t) ((state->self_A)[0][1]  +  (state->self_B)[0][1]));
+(state->self_out)[1][2] = ((uint64_t) ((state->self_A)[1][2]  +  (state->self_B)[1][2]));
+(state->self_out)[1][0] = ((uint64_t) ((state->self_A)[1][0]  +  (state->self_B)[1][0]));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,14 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint64_t self_out[ 2 ][ 3 ];
+	uint64_t self_B[ 2 ][ 3 ];
+	uint64_t self_A[ 2 ][ 3 ];
+};
+
+void simulate( circuit_state* __restrict const state );
@@ -0,0 +1,35 @@
+#include "memory.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint16_t  m0_rdata;
+
+// Simulation code
+if (((state->self_clk_last) == 0) && ((state->self_clk) == 1)) {
+// All updates inside clock
+(state->m0)[ (state->self_write_addr) ] = (((state->self_write_en)) ? (state->self_write_data) : (state->m0)[ (state->self_write_addr) ]);
+m0_rdata = ((state->m0)[ (state->self_read_addr) ]);
+(state->self_read_data) = m0_rdata;
+
+}
+
+// ----- Update pure combinational logic
+
+// ----- Done
+
+// ----- Setting last clock values
+(state->self_clk_last) = (state->self_clk);
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
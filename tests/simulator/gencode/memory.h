@@ -0,0 +1,19 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_clk;
+	uint8_t self_clk_last;
+	uint8_t self_write_en;
+	uint8_t self_write_addr;
+	uint16_t m0[ 2 ];
+	uint16_t self_write_data;
+	uint8_t self_read_addr;
+	uint16_t self_read_data;
+};
+
+void simulate( circuit_state* __restrict const state );
@@ -0,0 +1,28 @@
+#include "multiply_shift_16.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint16_t  mul0_out;
+uint16_t  four_out;
+uint16_t  dashr0_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_out) = ((uint16_t) (((0b1 & (((uint16_t) ((state->self_A)[0]  *  (state->self_A)[1])) >> 15)) ? (((1ULL << 0b0000000000000100) - 0b0000000000000000000000000000000000000000000000000000000000000001) << (16 - 0b0000000000000100)) : 0) | (((uint16_t) ((state->self_A)[0]  *  (state->self_A)[1]))  >>  0b0000000000000100)));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
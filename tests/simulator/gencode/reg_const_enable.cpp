@@ -0,0 +1,44 @@
+#include "reg_const_enable.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint8_t  en_const_out;
+uint8_t  r0$enMux_out;
+uint8_t  r0$reg0_out;
+uint8_t  r1$enMux_out;
+uint8_t  r1$reg0_out;
+
+// Simulation code
+if (((state->self_clk_last) == 0) && ((state->self_clk) == 1)) {
+// All updates inside clock
+r0$reg0_out = (state->r0$reg0);
+r1$reg0_out = (state->r1$reg0);
+(state->r0$reg0) = (0b1 ? (state->self_a) : r0$reg0_out);
+r0$reg0_out = (state->r0$reg0);
+(state->self_out_0) = r0$reg0_out;
+(state->r1$reg0) = (0b1 ? (state->self_a) : r1$reg0_out);
+r1$reg0_out = (state->r1$reg0);
+(state->self_out_1) = r1$reg0_out;
+
+}
+
+// ----- Update pure combinational logic
+
+// ----- Done
+
+// ----- Setting last clock values
+(state->self_clk_last) = (state->self_clk);
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,18 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_clk;
+	uint8_t self_clk_last;
+	uint8_t r0$reg0;
+	uint8_t r1$reg0;
+	uint8_t self_a;
+	uint8_t self_out_0;
+	uint8_t self_out_1;
+};
+
+void simulate( circuit_state* __restrict const state );
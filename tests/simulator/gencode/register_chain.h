@@ -0,0 +1,20 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_clk;
+	uint8_t self_clk_last;
+	uint16_t r1$reg0;
+	uint16_t r0$reg0;
+	uint16_t r2$reg0;
+	uint16_t self_ap;
+	uint8_t self_en;
+	uint16_t self_out;
+	uint16_t self_bp;
+};
+
+void simulate( circuit_state* __restrict const state );
@@ -0,0 +1,16 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint8_t self_clk;
+	uint8_t self_clk_last;
+	uint8_t r0$reg0;
+	uint8_t self_a;
+	uint8_t self_cout;
+};
+
+void simulate( circuit_state* __restrict const state );
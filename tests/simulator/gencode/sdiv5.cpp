@@ -0,0 +1,26 @@
+#include "sdiv5.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint8_t  sdiv0_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_out) = MASK(0b00000000000000000000000000000101, (((int8_t) SIGN_EXTEND( 5, 8, (state->self_A)[0] ))  /  ((int8_t) SIGN_EXTEND( 5, 8, (state->self_A)[1] ))));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
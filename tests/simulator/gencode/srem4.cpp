@@ -0,0 +1,29 @@
+#include "srem4.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint8_t  srem00_out;
+uint8_t  srem01_out;
+uint8_t  srem1_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+srem00_out = MASK(0b00000000000000000000000000000110, (((int8_t) SIGN_EXTEND( 6, 8, (state->self_in)[0] ))  %  ((int8_t) SIGN_EXTEND( 6, 8, (state->self_in)[1] ))));
+(state->self_out) = MASK(0b00000000000000000000000000000110, (((int8_t) SIGN_EXTEND( 6, 8, srem00_out ))  %  ((int8_t) SIGN_EXTEND( 6, 8, MASK(0b00000000000000000000000000000110, (((int8_t) SIGN_EXTEND( 6, 8, (state->self_in)[2] ))  %  ((int8_t) SIGN_EXTEND( 6, 8, srem00_out )))) ))));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
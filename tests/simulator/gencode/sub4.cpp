@@ -0,0 +1,28 @@
+#include "sub4.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint64_t  sub00_out;
+uint64_t  sub01_out;
+uint64_t  sub1_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_out) = ((uint64_t) (((uint64_t) ((state->self_in)[0]  -  (state->self_in)[1]))  -  ((uint64_t) ((state->self_in)[2]  -  (state->self_in)[3]))));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
@@ -0,0 +1,15 @@
+#include <stdint.h>
+#include <cstdio>
+
+#include "bit_vector.h"
+
+using namespace bsim;
+
+struct __attribute__((packed, aligned(32))) circuit_state {
+	uint16_t self_out1;
+	uint16_t self_in1;
+	uint16_t self_out0;
+	uint16_t self_in0;
+};
+
+void simulate( circuit_state* __restrict const state );
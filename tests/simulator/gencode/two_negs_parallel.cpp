@@ -0,0 +1,28 @@
+#include "two_negs_parallel.h"
+#include <immintrin.h>
+using namespace bsim;
+
+#define SIGN_EXTEND(start, end, x) (((x) & ((1ULL << (start)) - 1)) | (((x) & (1ULL << ((start) - 1))) ? (((1ULL << ((end) - (start))) - 1) << (start)) : 0))
+
+#define MASK(width, expr) (((1ULL << (width)) - 1) & ((expr)))
+
+void simulate_0( circuit_state* __restrict const state ) {
+
+// Variable declarations
+
+// Internal variables
+uint16_t  neg0_out;
+uint16_t  neg1_out;
+
+// Simulation code
+
+// ----- Update pure combinational logic
+(state->self_out1) = (~(state->self_in1));
+(state->self_out0) = (~(state->self_in0));
+
+// ----- Done
+}
+
+void simulate( circuit_state* __restrict const state ) {
+simulate_0( state );
+}
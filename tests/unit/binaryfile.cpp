@@ -0,0 +1,109 @@
+#include "coreir.h"
+#include <fstream>
+
+using namespace std;
+using namespace CoreIR;
+
+//Builds a couple of modules that use most of what the format has to store
+Module* build(Context* c) {
+  Namespace* g = c->getGlobal();
+  uint width = 4;
+
+  Type* inner = c->Record({
+    {"in",c->BitIn()->Arr(width)->Arr(2)},
+    {"clk",c->Named("coreir.clkIn")},
+    {"out",c->Bit()->Arr(width)}
+  });
+  Module* mInner = g->newModuleDecl("inner",inner,{{"init",c->BitVector(width)}});
+  mInner->getMetaData()["note"] = "inner";
+  ModuleDef* def = mInner->newModuleDef();
+  Instance* add = def->addInstance("add","coreir.add",{{"width",Const::make(c,width)}});
+  add->getMetaData()["kind"] = {1,2};
+  def->addInstance("r","coreir.reg",{{"width",Const::make(c,width)}},{{"init",mInner->getArg("init")}});
+  def->connect("self.in.0","add.in0");
+  def->connect("self.in.1","add.in1");
+  def->connect("add.out","r.in");
+  def->connect("self.clk","r.clk");
+  def->connect("r.out.3","self.out.3");
+  def->getMetaData(def->sel("r.out.3"),def->sel("self.out.3"))["conn"] = true;
+  mInner->setDef(def);
+
+  Type* outer = c->Record({
+    {"in",c->BitIn()->Arr(width)->Arr(2)},
+    {"clk",c->Named("coreir.clkIn")}
+  });
+  Module* mOuter = g->newModuleDecl("outer",outer);
+  def = mOuter->newModuleDef();
+  def->addInstance("i","global.inner",{{"init",Const::make(c,BitVector(width,5))}});
+  def->addInstance("t","coreir.term",{{"width",Const::make(c,width)}});
+  def->connect("self.in","i.in");
+  def->connect("self.clk","i.clk");
+  def->connect("i.out","t.in");
+  mOuter->setDef(def);
+
+  g->newModuleDecl("decl",c->Record({{"x",c->BitIn()}}));
+  c->setTop(mOuter);
+  return mOuter;
+}
+
+int main() {
+  Context* c = newContext();
+  Module* top = build(c);
+  string outerKey = getStructuralKey(top);
+  string innerKey = getStructuralKey(c->getGlobal()->getModule("inner"));
+  assert(saveToBinaryFile(c,"_binaryfile.coreirb"));
+  deleteContext(c);
+
+  //Lazy load. Definitions only exist once they are asked for
+  c = newContext();
+  Module* ltop = nullptr;
+  assert(loadFromBinaryFile(c,"_binaryfile.coreirb",&ltop));
+  assert(ltop && ltop->getRefName()=="global.outer");
+  assert(c->getTop()==ltop);
+  Module* inner = c->getGlobal()->getModule("inner");
+  assert(inner->hasDef() && inner->hasLazyDef());
+  assert(!c->getGlobal()->getModule("decl")->hasDef());
+  assert(ltop->hasLazyDef());
+  assert(getStructuralKey(ltop)==outerKey);
+  assert(!ltop->hasLazyDef());
+  assert(inner->hasLazyDef());
+  assert(getStructuralKey(inner)==innerKey);
+  //Instance order is preserved
+  assert(inner->getDef()->getInstancesIterBegin()->getInstname()=="add");
+  Instance* r = cast<Instance>(inner->getDef()->sel("r"));
+  assert(r->getModArgs().at("init")==inner->getArg("init"));
+
+  //Saving again (over the mapped file) gives the same bytes
+  assert(saveToBinaryFile(c,"_binaryfile2.coreirb"));
+  deleteContext(c);
+  std::ifstream f1("_binaryfile.coreirb",std::ios::binary), f2("_binaryfile2.coreirb",std::ios::binary);
+  string b1((std::istreambuf_iterator<char>(f1)),std::istreambuf_iterator<char>());
+  string b2((std::istreambuf_iterator<char>(f2)),std::istreambuf_iterator<char>());
+  assert(!b1.empty() && b1==b2);
+
+  //Eager load
+  c = newContext();
+  assert(loadFromBinaryFile(c,"_binaryfile.coreirb",nullptr,false));
+  assert(!c->getGlobal()->getModule("outer")->hasLazyDef());
+  assert(getStructuralKey(c->getGlobal()->getModule("outer"))==outerKey);
+  deleteContext(c);
+
+  //Bad files are reported
+  {
+    std::ofstream bad("_binaryfile.coreirb",std::ios::binary);
+    bad << b1.substr(0,40);
+  }
+  c = newContext();
+  assert(!loadFromBinaryFile(c,"_binaryfile.coreirb"));
+  assert(!loadFromBinaryFile(c,"_missing.coreirb"));
+  deleteContext(c);
+
+  //So are corrupt definitions when loading eagerly
+  {
+    std::ofstream bad("_binaryfile.coreirb",std::ios::binary);
+    bad << b1.substr(0,b1.size()-4);
+  }
+  c = newContext();
+  assert(!loadFromBinaryFile(c,"_binaryfile.coreirb",nullptr,false));
+  deleteContext(c);
+}
@@ -49,5 +49,16 @@ int main() {
   //    exists?
   assert(addMod->getDef()->canSel("self.out.0"));
 
+  //Integer selects on arrays
+  Wireable* out = def->sel("self.out");
+  assert(out->canSel(3));
+  assert(!out->canSel(width));
+  assert(!def->sel("self")->canSel(0));
+  assert(out->getType()->sel(2) == c->BitIn());
+  assert(out->sel(2) == def->sel("self.out.2"));
+  assert(out->sel(2) == out->sel("2"));
+  assert(out->sel(2)->getSelStr() == "2");
+  assert(out->getSelects().size() == width);
+
   deleteContext(c);
 }
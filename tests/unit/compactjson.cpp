@@ -0,0 +1,48 @@
+#include "coreir.h"
+#include <fstream>
+
+using namespace std;
+using namespace CoreIR;
+
+string readFile(string filename) {
+  std::ifstream f(filename);
+  return string((std::istreambuf_iterator<char>(f)),std::istreambuf_iterator<char>());
+}
+
+int main() {
+  Context* c = newContext();
+  Namespace* g = c->getGlobal();
+  uint width = 8;
+  Module* top = g->newModuleDecl("top",c->Record({
+    {"in",c->BitIn()->Arr(width)},
+    {"out",c->Bit()->Arr(width)}
+  }));
+  ModuleDef* def = top->newModuleDef();
+  def->addInstance("c","coreir.const",{{"width",Const::make(c,width)}},{{"value",Const::make(c,BitVector(width,3))}});
+  Instance* add = def->addInstance("add","coreir.add",{{"width",Const::make(c,width)}});
+  add->getMetaData()["note"] = "a b";
+  def->connect("self.in","add.in0");
+  def->connect("c.out","add.in1");
+  def->connect("add.out","self.out");
+  def->getMetaData(def->sel("add.out"),def->sel("self.out"))["x"] = 1;
+  top->setDef(def);
+  c->setTop(top);
+  string key = getStructuralKey(top);
+
+  assert(saveToFile(c,"_compactjson_pretty.json"));
+  assert(saveToFile(c,"_compactjson.json",true,true));
+  deleteContext(c);
+
+  string pretty = readFile("_compactjson_pretty.json");
+  string compact = readFile("_compactjson.json");
+  assert(compact.size() < pretty.size());
+  //Only the trailing newline
+  assert(compact.find('\n')==compact.size()-1);
+  assert(json::parse(compact)==json::parse(pretty));
+
+  c = newContext();
+  Module* ltop = nullptr;
+  assert(loadFromFile(c,"_compactjson.json",&ltop));
+  assert(getStructuralKey(ltop)==key);
+  deleteContext(c);
+}
@@ -61,6 +61,32 @@ int main() {
   assert(def->getInstances().size() == 0);
   mod->print();
 
+  //Bulk connect bit by bit
+  Wireable* i1 = def->addInstance("i1",const16,{{"value",Const::make(c,BitVector(16,5))}});
+  vector<Connection> cons;
+  for (uint i=0; i<16; ++i) {
+    cons.emplace_back(i1->sel("out")->sel(i),self->sel("out")->sel(i));
+  }
+  def->reserve(0,cons.size());
+  def->connectBulk(cons);
+  assert(!def->validate());
+  assert(def->getConnections().size() == 16);
+  assert(def->hasConnection(self->sel("out")->sel(7),i1->sel("out")->sel(7)));
+
+  //Bulk instances, and the types of bulk connections are checked at commit
+  def->removeInstance("i1");
+  auto consts = def->addInstances({
+    {"i2",const16,{{"value",Const::make(c,BitVector(16,6))}}},
+    {"i3",const16,{{"value",Const::make(c,BitVector(16,7))}}}
+  });
+  assert(consts.size() == 2 && consts[1]->getInstname() == "i3");
+  assert(def->getInstancesIterBegin() == consts[0]);
+  def->connectBulk({{consts[0]->sel("out"),self->sel("out")}});
+  assert(!def->commitBulk());
+  def->connectBulk({{consts[1]->sel("out"),consts[0]->sel("out")}});
+  assert(def->commitBulk());
+  assert(!def->commitBulk());
+
   deleteContext(c);
   
   return 0;
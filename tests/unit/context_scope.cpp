@@ -0,0 +1,55 @@
+#include "coreir.h"
+#include <cstring>
+
+using namespace std;
+using namespace CoreIR;
+
+int main() {
+  Context* c = newContext();
+
+  //Outside of a scope arrays live as long as the context
+  char* persistent = c->newStringBuffer(6);
+  strcpy(persistent,"hello");
+
+  c->beginScope();
+  assert(c->getScopeDepth() == 1);
+  Wireable** warr = c->newWireableArray(16);
+  for (uint i=0; i<16; ++i) warr[i] = nullptr;
+  c->beginScope();
+  assert(c->getScopeDepth() == 2);
+  for (uint i=0; i<10000; ++i) {
+    char* buf = c->newStringBuffer(32);
+    strcpy(buf,"transient");
+  }
+  //Maps built in a scope are released with it as well
+  for (uint i=0; i<1000; ++i) {
+    Values* vals = c->newValues();
+    (*vals)["width"] = Const::make(c,16);
+    Params* params = c->newParams();
+    (*params)["width"] = c->Int();
+    RecordParams* rparams = c->newRecordParams();
+    rparams->push_back({"in",c->BitIn()});
+  }
+  c->endScope();
+  //The outer scope is still valid
+  assert(warr[15] == nullptr);
+  c->newConstStringArray(0);
+  c->endScope();
+  assert(c->getScopeDepth() == 0);
+
+  assert(string(persistent) == "hello");
+
+  //Maps are copied by the API calls that take them, so a module built from
+  //scoped maps outlives the scope
+  c->beginScope();
+  Params* gparams = c->newParams();
+  (*gparams)["width"] = c->Int();
+  Module* m = c->getGlobal()->newModuleDecl("scoped",c->Record({{"in",c->BitIn()}}),*gparams);
+  c->endScope();
+  assert(m->getModParams().count("width"));
+
+  //Scopes left open are released with the context
+  c->beginScope();
+  c->newValueArray(4);
+  deleteContext(c);
+}
@@ -0,0 +1,97 @@
+#include "coreir.h"
+
+using namespace std;
+using namespace CoreIR;
+
+Module* makeWrapper(Context* c, string name, string op, Values args=Values()) {
+  Type* t = c->Record({
+    {"in0", c->BitIn()->Arr(8)},
+    {"in1", c->BitIn()->Arr(8)},
+    {"out", c->Bit()->Arr(8)}
+  });
+  Module* m = c->getGlobal()->newModuleDecl(name,t);
+  ModuleDef* def = m->newModuleDef();
+  def->addInstance("op", op, args);
+  def->connect("self.in0", "op.in0");
+  def->connect("self.in1", "op.in1");
+  def->connect("op.out", "self.out");
+  m->setDef(def);
+  return m;
+}
+
+int main() {
+  Context* c = newContext();
+  Namespace* g = c->getGlobal();
+
+  Module* a = makeWrapper(c,"A","coreir.add",{{"width", Const::make(c,8)}});
+  Module* b = makeWrapper(c,"B","coreir.add",{{"width", Const::make(c,8)}});
+  Module* s = makeWrapper(c,"S","coreir.sub",{{"width", Const::make(c,8)}});
+  assert(getFingerprint(a) == getFingerprint(b));
+  assert(getFingerprint(a) != getFingerprint(s));
+  assert(getFingerprint(a) != getFingerprint(c->getGenerator("coreir.add")->getModule({{"width",Const::make(c,8)}})));
+
+  //Two levels, so the wrappers of A and B only become identical after A and B merge
+  Module* wa = makeWrapper(c,"WA","global.A");
+  Module* wb = makeWrapper(c,"WB","global.B");
+  assert(getFingerprint(wa) != getFingerprint(wb));
+
+  Type* topType = c->Record({
+    {"in", c->BitIn()->Arr(8)},
+    {"out0", c->Bit()->Arr(8)},
+    {"out1", c->Bit()->Arr(8)},
+    {"out2", c->Bit()->Arr(8)}
+  });
+  Module* top = g->newModuleDecl("top",topType);
+  ModuleDef* def = top->newModuleDef();
+  int i = 0;
+  for (auto m : {wa, wb, s}) {
+    string iname = "i" + to_string(i);
+    def->addInstance(iname,m);
+    def->connect("self.in",iname + ".in0");
+    def->connect("self.in",iname + ".in1");
+    def->connect(iname + ".out","self.out" + to_string(i));
+    ++i;
+  }
+  top->setDef(def);
+  c->setTop(top);
+
+  c->runPasses({"dedupmodules"});
+
+  Module* i0Ref = cast<Instance>(def->sel("i0"))->getModuleRef();
+  Module* i1Ref = cast<Instance>(def->sel("i1"))->getModuleRef();
+  assert(i0Ref == i1Ref);
+  assert(cast<Instance>(def->sel("i2"))->getModuleRef() == s);
+  //One of each pair of duplicates was erased
+  assert(g->hasModule("A") != g->hasModule("B"));
+  assert(g->hasModule("WA") != g->hasModule("WB"));
+  assert(g->hasModule("S"));
+  assert(g->hasModule("top"));
+  deleteContext(c);
+
+  //Duplicates that a Module value refers to are redirected but kept
+  c = newContext();
+  g = c->getGlobal();
+  a = makeWrapper(c,"A","coreir.add",{{"width", Const::make(c,8)}});
+  b = makeWrapper(c,"B","coreir.add",{{"width", Const::make(c,8)}});
+  Module* holder = g->newModuleDecl("holder",c->Record({{"in",c->BitIn()}}),{{"m",ModuleType::make(c)}});
+  top = g->newModuleDecl("top",c->Record({{"in",c->BitIn()->Arr(8)},{"out",c->Bit()->Arr(8)}}));
+  def = top->newModuleDef();
+  def->addInstance("a",a);
+  def->addInstance("b",b);
+  def->addInstance("h",holder,{{"m",Const::make(c,a)}});
+  def->addInstance("h2",holder,{{"m",Const::make(c,b)}});
+  def->connect("self.in","a.in0");
+  def->connect("self.in","a.in1");
+  def->connect("self.in","b.in0");
+  def->connect("self.in","b.in1");
+  def->connect("self.in.0","h.in");
+  def->connect("self.in.1","h2.in");
+  def->connect("a.out","self.out");
+  top->setDef(def);
+  c->setTop(top);
+  c->runPasses({"dedupmodules"});
+  assert(cast<Instance>(def->sel("a"))->getModuleRef()==cast<Instance>(def->sel("b"))->getModuleRef());
+  assert(g->hasModule("A") && g->hasModule("B"));
+  assert(cast<Instance>(def->sel("h2"))->getModArgs().at("m")->get<Module*>()==b);
+  deleteContext(c);
+}
@@ -0,0 +1,136 @@
+#include "coreir.h"
+#include <fstream>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace CoreIR;
+
+string readFile(string path) {
+  std::ifstream f(path);
+  return string((std::istreambuf_iterator<char>(f)),std::istreambuf_iterator<char>());
+}
+bool exists(string path) {
+  struct stat st;
+  return stat(path.c_str(),&st)==0;
+}
+//Marks a file so that it can be seen whether it was rewritten
+void touch(string path) {
+  std::ofstream f(path,std::ios::app);
+  f << " ";
+}
+bool touched(string path) {
+  string s = readFile(path);
+  return !s.empty() && s.back()==' ';
+}
+
+string mpath(string name) { return "_directoryfile/global/modules/" + name + ".json"; }
+string gpath(string name) { return "_directoryfile/global/generators/" + name + ".json"; }
+
+string key(Context* c) {
+  string ret;
+  for (auto m : c->getGlobal()->getModules()) ret += getStructuralKey(m.second);
+  return ret;
+}
+
+//Chain of modules where each one instances the previous one and a generated one
+void build(Context* c, int numModules) {
+  Namespace* g = c->getGlobal();
+  g->newTypeGen("width_type",{{"width",c->Int()}},[](Context* c, Values args) {
+    uint width = args.at("width")->get<int>();
+    return c->Record({{"in",c->BitIn()->Arr(width)},{"out",c->Bit()->Arr(width)}});
+  });
+  Generator* gen = g->newGeneratorDecl("pass",g->getTypeGen("width_type"),{{"width",c->Int()}});
+  Type* t = c->Record({{"in",c->BitIn()->Arr(8)},{"out",c->Bit()->Arr(8)}});
+  for (int i=0; i<numModules; ++i) {
+    Module* m = g->newModuleDecl("m" + to_string(i),t);
+    ModuleDef* def = m->newModuleDef();
+    def->addInstance("p",gen,{{"width",Const::make(c,8)}});
+    def->connect("self.in","p.in");
+    if (i>0) {
+      def->addInstance("sub","global.m" + to_string(i-1));
+      def->connect("p.out","sub.in");
+      def->connect("sub.out","self.out");
+    }
+    else {
+      def->connect("p.out","self.out");
+    }
+    m->setDef(def);
+  }
+  c->setTop(g->getModule("m" + to_string(numModules-1)));
+}
+
+int main() {
+  system("rm -rf _directoryfile _directoryfile2");
+  Context* c = newContext();
+  build(c,4);
+  Module* m2 = c->getGlobal()->getModule("m2");
+  assert(m2->isDirty());
+  assert(saveToDirectory(c,"_directoryfile"));
+  assert(!m2->isDirty());
+  assert(exists("_directoryfile/index.json"));
+  assert(exists("_directoryfile/global/typegens.json"));
+  assert(exists(gpath("pass")));
+  for (int i=0; i<4; ++i) assert(exists(mpath("m" + to_string(i))));
+
+  //Only what changed is rewritten
+  for (int i=0; i<4; ++i) touch(mpath("m" + to_string(i)));
+  touch(gpath("pass"));
+  ModuleDef* def = m2->getDef();
+  def->disconnect(def->sel("sub.out"),def->sel("self.out"));
+  def->removeInstance("sub");
+  def->connect("p.out","self.out");
+  assert(m2->isDirty());
+  //Instancing a new generated module rewrites the generator
+  def = c->getGlobal()->getModule("m0")->getDef();
+  def->addInstance("p16","global.pass",{{"width",Const::make(c,16)}});
+  c->setTop(m2);
+  c->getGlobal()->eraseModule("m3");
+  assert(saveToDirectory(c,"_directoryfile"));
+  assert(touched(mpath("m1")));
+  assert(!touched(mpath("m0")) && !touched(mpath("m2")) && !touched(gpath("pass")));
+  assert(!exists(mpath("m3")));
+  string savedKey = key(c);
+  deleteContext(c);
+
+  //Lazy loading from the directory. Loaded modules are clean
+  c = newContext();
+  Module* top = nullptr;
+  assert(loadFromDirectory(c,"_directoryfile",&top,true));
+  assert(top && top->getName()=="m2");
+  Module* m1 = c->getGlobal()->getModule("m1");
+  assert(m1->hasLazyDef() && !m1->isDirty());
+  assert(c->getGlobal()->getGenerator("pass")->getGeneratedModules().size()==2);
+  assert(key(c)==savedKey);
+  assert(!m1->isDirty());
+
+  //Saving back only writes the module that changed
+  for (int i=0; i<3; ++i) touch(mpath("m" + to_string(i)));
+  m1->getDef()->addInstance("t","coreir.term",{{"width",Const::make(c,8)}});
+  assert(saveToDirectory(c,"_directoryfile"));
+  assert(!touched(mpath("m1")));
+  assert(touched(mpath("m0")) && touched(mpath("m2")));
+  savedKey = key(c);
+
+  //Saving to another directory writes everything
+  assert(saveToDirectory(c,"_directoryfile2"));
+  assert(exists("_directoryfile2/global/modules/m0.json"));
+
+  //markdirty forces everything to be saved again
+  c->runPasses({"markdirty"});
+  assert(m1->isDirty());
+  assert(saveToDirectory(c,"_directoryfile"));
+  assert(!touched(mpath("m0")));
+  deleteContext(c);
+
+  //Eager load
+  c = newContext();
+  assert(loadFromDirectory(c,"_directoryfile"));
+  assert(!c->getGlobal()->getModule("m1")->hasLazyDef());
+  assert(key(c)==savedKey);
+  deleteContext(c);
+
+  c = newContext();
+  assert(!loadFromDirectory(c,"_missing"));
+  deleteContext(c);
+  system("rm -rf _directoryfile _directoryfile2");
+}
@@ -0,0 +1,145 @@
+#include "coreir.h"
+#include <fstream>
+
+using namespace std;
+using namespace CoreIR;
+
+int runs = 0;
+
+//Generator of a chain of N adders
+Generator* declare(Context* c, string version) {
+  Namespace* g = c->getGlobal();
+  g->newTypeGen("chain_type",{{"width",c->Int()},{"N",c->Int()}},[](Context* c, Values args) {
+    uint width = args.at("width")->get<int>();
+    return c->Record({{"in",c->BitIn()->Arr(width)},{"out",c->Bit()->Arr(width)}});
+  });
+  Generator* chain = g->newGeneratorDecl("chain",g->getTypeGen("chain_type"),{{"width",c->Int()},{"N",c->Int()}});
+  chain->setVersion(version);
+  chain->setGeneratorDefFromFun([](Context* c, Values args, ModuleDef* def) {
+    ++runs;
+    int width = args.at("width")->get<int>();
+    int N = args.at("N")->get<int>();
+    string prev = "self.in";
+    for (int i=0; i<N; ++i) {
+      string name = "add" + to_string(i);
+      Instance* add = def->addInstance(name,"coreir.add",{{"width",Const::make(c,width)}});
+      add->getMetaData()["i"] = i;
+      def->connect(prev,name + ".in0");
+      def->connect(prev,name + ".in1");
+      prev = name + ".out";
+    }
+    def->connect(prev,"self.out");
+    def->getModule()->getMetaData()["N"] = N;
+  });
+  return chain;
+}
+
+Module* generate(Context* c, string version, int N) {
+  Generator* chain = declare(c,version);
+  Module* m = chain->getModule({{"width",Const::make(c,8)},{"N",Const::make(c,N)}});
+  assert(m->runGenerator());
+  return m;
+}
+
+int main() {
+  system("rm -rf _generatorcache");
+  Context* c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  Module* m = generate(c,"1",3);
+  assert(runs==1);
+  string mkey = getStructuralKey(m);
+  string file = getGeneratorCacheFile(m);
+  assert(std::ifstream(file).good());
+  deleteContext(c);
+
+  //Same generator, version and genargs are loaded instead of run
+  c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  m = generate(c,"1",3);
+  assert(runs==1);
+  assert(getStructuralKey(m)==mkey);
+  assert(!m->getDef()->validate());
+  assert(m->getMetaData()["N"]==3);
+  deleteContext(c);
+
+  //Other genargs or versions are run
+  c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  generate(c,"1",4);
+  assert(runs==2);
+  deleteContext(c);
+  c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  m = generate(c,"2",3);
+  assert(runs==3);
+  assert(getGeneratorCacheFile(m)!=file);
+  deleteContext(c);
+
+  //Unversioned generators and contexts without a cache always run
+  c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  m = generate(c,"",3);
+  assert(runs==4);
+  assert(!std::ifstream(getGeneratorCacheFile(m)).good());
+  deleteContext(c);
+  c = newContext();
+  c->setGeneratorCacheDirectory("");
+  generate(c,"1",3);
+  assert(runs==5);
+  deleteContext(c);
+
+  //Bad entries are ignored and replaced
+  {
+    std::ofstream bad(file);
+    bad << "{\"key\":";
+  }
+  c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  m = generate(c,"1",3);
+  assert(runs==6);
+  assert(getStructuralKey(m)==mkey);
+  deleteContext(c);
+  c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  generate(c,"1",3);
+  assert(runs==6);
+  deleteContext(c);
+  //Including ones that are valid json but not valid coreir
+  string entry;
+  {
+    std::ifstream f(file);
+    entry.assign(std::istreambuf_iterator<char>(f),std::istreambuf_iterator<char>());
+  }
+  size_t pos = entry.find("[\"Int\",8]");
+  assert(pos != string::npos);
+  {
+    std::ofstream bad(file);
+    bad << entry.replace(pos+2,3,"Nat");
+  }
+  c = newContext();
+  c->setGeneratorCacheDirectory("_generatorcache");
+  generate(c,"1",3);
+  assert(runs==7);
+  deleteContext(c);
+  //Missing instances and badly typed connections
+  for (string replacement : {"add9.out","add2.in0"}) {
+    {
+      std::ifstream f(file);
+      entry.assign(std::istreambuf_iterator<char>(f),std::istreambuf_iterator<char>());
+    }
+    pos = entry.find("add2.out");
+    assert(pos != string::npos);
+    {
+      std::ofstream bad(file);
+      bad << entry.replace(pos,8,replacement);
+    }
+    int before = runs;
+    c = newContext();
+    c->setGeneratorCacheDirectory("_generatorcache");
+    m = generate(c,"1",3);
+    assert(runs==before+1);
+    assert(getStructuralKey(m)==mkey);
+    deleteContext(c);
+  }
+  system("rm -rf _generatorcache");
+}
@@ -0,0 +1,114 @@
+#include "coreir.h"
+#include "coreir/ir/instancegraph.h"
+#include "coreir/passes/analysis/createinstancegraph.h"
+
+using namespace std;
+using namespace CoreIR;
+
+Type* bits(Context* c) {
+  return c->Record({{"in",c->BitIn()->Arr(8)},{"out",c->Bit()->Arr(8)}});
+}
+
+Module* passThrough(Namespace* g, string name, vector<string> subs) {
+  Module* m = g->newModuleDecl(name,bits(g->getContext()));
+  ModuleDef* def = m->newModuleDef();
+  string prev = "self.in";
+  for (uint i=0; i<subs.size(); ++i) {
+    string iname = "s" + to_string(i);
+    def->addInstance(iname,subs[i]);
+    def->connect(prev,iname + ".in");
+    prev = iname + ".out";
+  }
+  def->connect(prev,"self.out");
+  m->setDef(def);
+  return m;
+}
+
+//Sorted order, levels and instances of every node
+string describe(InstanceGraph* ig) {
+  string s;
+  for (auto node : ig->getSortedNodes()) {
+    s += node->getModule()->getRefName() + ":" + to_string(node->getLevel()) + "(";
+    for (auto inst : node->getInstanceList()) {
+      s += inst->getContainer()->getModule()->getName() + "." + inst->getInstname() + " ";
+    }
+    s += ")" + string(ig->validOnlyTop(node) ? "t" : "") + " ";
+  }
+  return s;
+}
+
+int main() {
+  Context* c = newContext();
+  Namespace* g = c->getGlobal();
+  passThrough(g,"leaf",{});
+  passThrough(g,"mid",{"global.leaf","global.leaf"});
+  Module* top = passThrough(g,"top",{"global.mid"});
+  c->setTop(top);
+  c->runPasses({"createinstancegraph"});
+  PassManager* pm = c->getPassManager();
+  auto cig = static_cast<Passes::CreateInstanceGraph*>(pm->getAnalysisPass("createinstancegraph"));
+  InstanceGraph* ig = cig->getInstanceGraph();
+  assert(c->getInstanceGraph()==ig);
+  assert(ig->getLevels().size()==3);
+
+  //Adding instances adds edges and moves modules up a level
+  Module* leaf = g->getModule("leaf");
+  Module* other = passThrough(g,"other",{"global.mid"});
+  Instance* o = top->getDef()->addInstance("o",other);
+  auto levels = ig->getLevels();
+  assert(levels.size()==4);
+  assert(levels[3].size()==1 && levels[3][0]->getModule()==top);
+  assert(levels[2].size()==1 && levels[2][0]->getModule()==other);
+
+  //Replacing and removing instances
+  o->replace(leaf);
+  top->getDef()->removeInstance("s0");
+  assert(ig->getLevels().size()==3);
+  for (auto node : ig->getSortedNodes()) {
+    if (node->getModule()==leaf) {
+      assert(node->getInstanceList().size()==3);
+      assert(node->getInstanceList()[2]==o);
+    }
+    if (node->getModule()==other) {
+      assert(node->getInstanceList().empty() && !ig->validOnlyTop(node));
+    }
+  }
+
+  //Generated modules, new definitions and erased modules
+  ModuleDef* def = other->newModuleDef();
+  def->addInstance("a","coreir.add",{{"width",Const::make(c,8)}});
+  def->connect("self.in","a.in0");
+  def->connect("self.in","a.in1");
+  def->connect("a.out","self.out");
+  other->setDef(def);
+  top->getDef()->addInstance("p",other);
+  g->eraseModule("mid");
+  c->runPasses({"rungenerators"});
+  addPassthrough(top->getDef()->sel("p"),"_pt");
+  assert(pm->isAnalysisCached("createinstancegraph"));
+  assert(cig->getInstanceGraph()==ig);
+
+  //Changes to a detached module (like in module passes running in parallel)
+  //are picked up when it is attached again
+  ig->detachModule(top);
+  top->getDef()->removeInstance("o");
+  top->getDef()->addInstance("o2",leaf);
+  assert(ig->getLevels().size()==3);
+  ig->attachModule(top);
+  assert(describe(ig).find("top.o2") != string::npos);
+  assert(describe(ig).find("top.o ") == string::npos);
+
+  //Same as a graph constructed from scratch
+  string kept = describe(ig);
+  InstanceGraph fresh;
+  fresh.construct(c);
+  assert(describe(&fresh)==kept);
+  assert(kept.find("mid")==string::npos);
+  assert(kept.find("coreir.add") != string::npos);
+  assert(kept.find("_.passthrough") != string::npos);
+  top->getDef()->removeInstance("_pt");
+  assert(describe(&fresh).find("_.passthrough")==string::npos);
+  //Deleting the context detaches the graph instead of updating it
+  deleteContext(c);
+  assert(!fresh.isConstructed() && fresh.getSortedNodes().empty());
+}
@@ -0,0 +1,94 @@
+#include "coreir.h"
+#include "coreir/passes/analysis/verilog.h"
+#include <fstream>
+
+using namespace std;
+using namespace CoreIR;
+
+string dir = "_incrementalverilog";
+
+string readFile(string path) {
+  std::ifstream f(path);
+  return string((std::istreambuf_iterator<char>(f)),std::istreambuf_iterator<char>());
+}
+//Marks a file so that it can be seen whether it was rewritten
+void touch(string path) {
+  std::ofstream f(path,std::ios::app);
+  f << "//";
+}
+bool touched(string path) {
+  string s = readFile(path);
+  return s.size()>=2 && s.substr(s.size()-2)=="//";
+}
+string vpath(string name) { return dir + "/" + name + ".v"; }
+
+//top instances m0..m2, each of which adds a constant
+void emit(int constant, int width=8) {
+  Context* c = newContext();
+  Namespace* g = c->getGlobal();
+  Type* t = c->Record({{"in",c->BitIn()->Arr(width)},{"out",c->Bit()->Arr(width)}});
+  Module* top = g->newModuleDecl("top",t);
+  ModuleDef* tdef = top->newModuleDef();
+  string prev = "self.in";
+  for (int i=0; i<3; ++i) {
+    Module* m = g->newModuleDecl("m" + to_string(i),t);
+    ModuleDef* def = m->newModuleDef();
+    int value = i==1 ? constant : i;
+    def->addInstance("c","coreir.const",{{"width",Const::make(c,width)}},{{"value",Const::make(c,BitVector(width,value))}});
+    def->addInstance("a","coreir.add",{{"width",Const::make(c,width)}});
+    def->connect("self.in","a.in0");
+    def->connect("c.out","a.in1");
+    def->connect("a.out","self.out");
+    m->setDef(def);
+    string iname = "i" + to_string(i);
+    tdef->addInstance(iname,m);
+    tdef->connect(prev,iname + ".in");
+    prev = iname + ".out";
+  }
+  tdef->connect(prev,"self.out");
+  top->setDef(tdef);
+  c->setTop(top);
+  c->runPasses({"rungenerators","removebulkconnections","flattentypes","verilog"});
+  auto vpass = static_cast<Passes::Verilog*>(c->getPassManager()->getAnalysisPass("verilog"));
+  vpass->writeToFiles(dir);
+  deleteContext(c);
+}
+
+int main() {
+  system(("rm -rf " + dir + " && mkdir " + dir).c_str());
+  emit(1);
+  string m1 = readFile(vpath("m1"));
+  assert(m1.find("8'h01") != string::npos);
+  assert(readFile(dir + "/.coreir_verilog.json").find("m1.v") != string::npos);
+
+  //Nothing changed so nothing is rewritten
+  for (auto name : {"top","m0","m1","m2","coreir_add"}) touch(vpath(name));
+  emit(1);
+  for (auto name : {"top","m0","m1","m2","coreir_add"}) assert(touched(vpath(name)));
+
+  //Only the changed module is rewritten
+  emit(5);
+  assert(!touched(vpath("m1")));
+  assert(readFile(vpath("m1")).find("8'h05") != string::npos);
+  assert(touched(vpath("top")) && touched(vpath("m0")) && touched(vpath("m2")));
+
+  //A deleted file is written again
+  remove(vpath("m0").c_str());
+  emit(5);
+  assert(readFile(vpath("m0")).find("module m0") != string::npos);
+  assert(touched(vpath("top")));
+
+  //Changing the width changes every module
+  emit(5,16);
+  assert(!touched(vpath("top")) && !touched(vpath("m2")));
+
+  //A broken manifest rewrites everything
+  touch(vpath("m2"));
+  {
+    std::ofstream bad(dir + "/.coreir_verilog.json");
+    bad << "{";
+  }
+  emit(5,16);
+  assert(!touched(vpath("m2")));
+  system(("rm -rf " + dir).c_str());
+}
@@ -59,7 +59,15 @@ int main() {
     }
     def->connect(inst->sel("out"),def->getInterface()->sel("out"));
     add4->runAll();
+    ModuleDef* add4def = inst->getModuleRef()->getDef();
+    auto add4Instances = add4def->getInstances().size();
+    auto add4Connections = add4def->getConnections().size();
     inlineInstance(inst);
+    //The inlined definition is left untouched
+    assert(add4def->getInstances().size() == add4Instances);
+    assert(add4def->getConnections().size() == add4Connections);
+    assert(def->getInstances().count("i0$add1"));
+    assert(def->getInstances().count("i0") == 0);
   add->setDef(def);
   add->print();
   deleteContext(c);
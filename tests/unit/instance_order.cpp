@@ -0,0 +1,53 @@
+#include "coreir.h"
+
+using namespace std;
+using namespace CoreIR;
+
+vector<string> instanceOrder(ModuleDef* def) {
+  vector<string> ret;
+  for (auto inst = def->getInstancesIterBegin(); inst != def->getInstancesIterEnd(); inst = def->getInstancesIterNext(inst)) {
+    ret.push_back(inst->getInstname());
+  }
+  return ret;
+}
+
+int main() {
+  Context* c = newContext();
+  Namespace* g = c->getGlobal();
+
+  Type* modType = c->Record({
+    {"in", c->BitIn()->Arr(8)},
+    {"out", c->Bit()->Arr(8)}
+  });
+  Module* mod = g->newModuleDecl("mod", modType);
+  ModuleDef* def = mod->newModuleDef();
+  Values wargs({{"width", Const::make(c, 8)}});
+  for (auto name : {"i0","i1","i2","i3"}) {
+    def->addInstance(name, "coreir.neg", wargs);
+  }
+  assert(instanceOrder(def) == vector<string>({"i0","i1","i2","i3"}));
+
+  //Remove from the middle, the front and the back
+  def->removeInstance("i1");
+  assert(instanceOrder(def) == vector<string>({"i0","i2","i3"}));
+  def->removeInstance("i0");
+  assert(instanceOrder(def) == vector<string>({"i2","i3"}));
+  def->removeInstance("i3");
+  assert(instanceOrder(def) == vector<string>({"i2"}));
+
+  //New instances go to the back, also after emptying the list
+  def->addInstance("i4", "coreir.neg", wargs);
+  assert(instanceOrder(def) == vector<string>({"i2","i4"}));
+  def->removeInstance("i2");
+  def->removeInstance("i4");
+  assert(def->getInstancesIterBegin() == def->getInstancesIterEnd());
+  def->addInstance("i5", "coreir.neg", wargs);
+  assert(instanceOrder(def) == vector<string>({"i5"}));
+
+  //Copies keep the order
+  def->addInstance("i6", "coreir.neg", wargs);
+  ModuleDef* cdef = def->copy();
+  assert(instanceOrder(cdef) == vector<string>({"i5","i6"}));
+
+  deleteContext(c);
+}
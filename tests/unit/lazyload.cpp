@@ -0,0 +1,109 @@
+#include "coreir.h"
+#include "coreir/ir/parallel.h"
+#include <fstream>
+#include <cstdio>
+
+using namespace std;
+using namespace CoreIR;
+
+int main() {
+  //leaf is used by mid, mid by top. unused is never asked for
+  string design = R"({"top":"global.top",
+  "namespaces":{
+    "global":{
+      "modules":{
+        "leaf":{
+          "type":["Record",[["in",["Array",4,"BitIn"]],["out",["Array",4,"Bit"]]]],
+          "instances":{"n":{"genref":"coreir.not","genargs":{"width":["Int",4]}}},
+          "connections":[["self.in","n.in"],["self.out","n.out",{"m":1}]]
+        },
+        "mid":{
+          "type":["Record",[["in",["Array",4,"BitIn"]],["out",["Array",4,"Bit"]]]],
+          "instances":{"l":{"modref":"global.leaf"}},
+          "connections":[["self.in","l.in"],["self.out","l.out"]]
+        },
+        "top":{
+          "type":["Record",[["in",["Array",4,"BitIn"]],["out",["Array",4,"Bit"]]]],
+          "instances":{"m":{"modref":"global.mid"}},
+          "connections":[["self.in","m.in"],["self.out","m.out"]]
+        },
+        "unused":{
+          "type":["Record",[["in",["Array",4,"BitIn"]]]],
+          "instances":{"t":{"genref":"coreir.term","genargs":{"width":["Int",4]}}},
+          "connections":[["self.in","t.in"]]
+        }
+      }
+    }
+  }})";
+  {
+    std::ofstream f("_lazyload.json");
+    f << design;
+  }
+
+  Context* c = newContext();
+  assert(loadFromFile(c,"_lazyload.json"));
+  map<string,string> keys;
+  for (auto m : c->getGlobal()->getModules(false)) {
+    keys[m.first] = getStructuralKey(m.second);
+  }
+  deleteContext(c);
+
+  c = newContext();
+  Module* top = nullptr;
+  assert(loadFromFile(c,"_lazyload.json",&top,true));
+  //The mapping stays valid after the file is gone
+  remove("_lazyload.json");
+  Namespace* g = c->getGlobal();
+  for (auto name : {"leaf","mid","top","unused"}) {
+    assert(g->getModule(name)->hasDef());
+    assert(g->getModule(name)->hasLazyDef());
+  }
+  assert(top->getDef()->getInstances().size()==1);
+  assert(!top->hasLazyDef());
+  assert(g->getModule("mid")->hasLazyDef());
+
+  //Walking down from top only materializes what is used
+  std::function<void(Module*)> walk = [&](Module* m) {
+    if (!m->hasDef()) return;
+    for (auto inst : m->getDef()->getInstances()) walk(inst.second->getModuleRef());
+  };
+  walk(top);
+  assert(!g->getModule("leaf")->hasLazyDef());
+  assert(g->getModule("unused")->hasLazyDef());
+  for (auto name : {"leaf","mid","top","unused"}) {
+    assert(getStructuralKey(g->getModule(name))==keys[name]);
+  }
+  deleteContext(c);
+
+  //Concurrent requests for the same definition load it once
+  {
+    std::ofstream f("_lazyload.json");
+    f << design;
+  }
+  c = newContext();
+  c->setNumThreads(4);
+  assert(loadFromFile(c,"_lazyload.json",nullptr,true));
+  Module* unused = c->getGlobal()->getModule("unused");
+  vector<ModuleDef*> defs(64);
+  parallelFor(c,defs.size(),[&](size_t i) { defs[i] = unused->getDef(); });
+  for (auto def : defs) assert(def && def==defs[0]);
+  assert(!unused->hasLazyDef() && unused->hasDef());
+  assert(getStructuralKey(unused)==keys["unused"]);
+  deleteContext(c);
+
+  //Malformed definitions are still reported when the file is loaded
+  for (string bad : {
+    string(R"("connections":[["self.in"]])"),
+    string(R"("instances":{"t":{"modref":"global.x","bad":1}})"),
+    string(R"("connections":[["self.in",1]])")
+  }) {
+    {
+      std::ofstream f("_lazyload.json");
+      f << R"({"namespaces":{"global":{"modules":{"m":{"type":["Record",[["in","BitIn"]]],)" << bad << "}}}}}";
+    }
+    c = newContext();
+    assert(!loadFromFile(c,"_lazyload.json",nullptr,true));
+    deleteContext(c);
+  }
+  remove("_lazyload.json");
+}
@@ -0,0 +1,84 @@
+#include "coreir.h"
+#include "coreir/ir/fingerprint.h"
+#include "coreir/passes/analysis/createinstancegraph.h"
+
+using namespace std;
+using namespace CoreIR;
+
+//top instances mid0..midN, mid<i> instances leaf<i> and leaf<i+1> and a
+//leaf adds a constant
+Context* build(uint threads, int numMids) {
+  Context* c = newContext();
+  c->setNumThreads(threads);
+  Namespace* g = c->getGlobal();
+  Type* t = c->Record({{"in",c->BitIn()->Arr(8)},{"out",c->Bit()->Arr(8)}});
+  for (int i=0; i<=numMids; ++i) {
+    Module* leaf = g->newModuleDecl("leaf" + to_string(i),t);
+    ModuleDef* def = leaf->newModuleDef();
+    def->addInstance("c","coreir.const",{{"width",Const::make(c,8)}},{{"value",Const::make(c,BitVector(8,i))}});
+    def->addInstance("a","coreir.add",{{"width",Const::make(c,8)}});
+    def->connect("self.in","a.in0");
+    def->connect("c.out","a.in1");
+    def->connect("a.out","self.out");
+    leaf->setDef(def);
+  }
+  Module* top = g->newModuleDecl("top",t);
+  ModuleDef* tdef = top->newModuleDef();
+  string prev = "self.in";
+  for (int i=0; i<numMids; ++i) {
+    Module* mid = g->newModuleDecl("mid" + to_string(i),t);
+    ModuleDef* def = mid->newModuleDef();
+    def->addInstance("l0","global.leaf" + to_string(i));
+    def->addInstance("l1","global.leaf" + to_string(i+1));
+    def->connect("self.in","l0.in");
+    def->connect("l0.out","l1.in");
+    def->connect("l1.out","self.out");
+    mid->setDef(def);
+    string iname = "m" + to_string(i);
+    tdef->addInstance(iname,mid);
+    tdef->connect(prev,iname + ".in");
+    prev = iname + ".out";
+  }
+  tdef->connect(prev,"self.out");
+  top->setDef(tdef);
+  c->setTop(top);
+  c->runPasses({"rungenerators"});
+  return c;
+}
+
+int main() {
+  Context* c = build(1,50);
+  c->runPasses({"createinstancegraph"});
+  auto cig = static_cast<Passes::CreateInstanceGraph*>(c->getPassManager()->getAnalysisPass("createinstancegraph"));
+  auto levels = cig->getInstanceGraph()->getLevels();
+  assert(levels.size()==4);
+  assert(levels[3].size()==1 && levels[3][0]->getModule()->getName()=="top");
+  assert(levels[2].size()==50 && levels[1].size()==51);
+  //A module is at a higher level than everything it instances
+  map<Module*,int> moduleLevel;
+  for (uint l=0; l<levels.size(); ++l) {
+    for (auto node : levels[l]) {
+      assert(node->getLevel()==(int)l);
+      moduleLevel[node->getModule()] = l;
+    }
+  }
+  for (auto& level : levels) {
+    for (auto node : level) {
+      for (auto inst : node->getInstanceList()) {
+        assert(moduleLevel.at(inst->getContainer()->getModule()) > node->getLevel());
+      }
+    }
+  }
+  c->runPasses({"flatten"});
+  string serial = getStructuralKey(c->getTop());
+  ModuleDef* tdef = c->getTop()->getDef();
+  assert(tdef->getInstances().size()==200);
+  assert(tdef->getInstances().count("m7$l1$c"));
+  deleteContext(c);
+
+  //Same result when each level runs on many threads
+  c = build(8,50);
+  c->runPasses({"flatten","verifyflatcoreirprims"});
+  assert(getStructuralKey(c->getTop())==serial);
+  deleteContext(c);
+}
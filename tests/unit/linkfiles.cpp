@@ -0,0 +1,103 @@
+#include "coreir.h"
+#include <fstream>
+
+using namespace std;
+using namespace CoreIR;
+
+void writeFile(string path, string s) {
+  std::ofstream f(path);
+  f << s;
+}
+
+string type = "[\"Record\",[[\"in\",[\"Array\",8,\"BitIn\"]],[\"out\",[\"Array\",8,\"Bit\"]]]]";
+//Module name that instances sub (if any) and a generated adder
+string module(string name, string sub, string value="1") {
+  string s = "\"" + name + "\":{\"type\":" + type + ",\"instances\":{";
+  s += "\"a\":{\"genref\":\"coreir.add\",\"genargs\":{\"width\":[\"Int\",8]}},";
+  s += "\"c\":{\"genref\":\"coreir.const\",\"genargs\":{\"width\":[\"Int\",8]},\"modargs\":{\"value\":[[\"BitVector\",8],\"8'h0" + value + "\"]}}";
+  if (sub!="") s += ",\"s\":{\"modref\":\"" + sub + "\"}";
+  s += "},\"connections\":[[\"self.in\",\"a.in0\"],[\"c.out\",\"a.in1\"]";
+  s += sub!="" ? ",[\"a.out\",\"s.in\"],[\"s.out\",\"self.out\"]]}" : ",[\"a.out\",\"self.out\"]]}";
+  return s;
+}
+string file(string modules, string top="") {
+  string s = "{";
+  if (top!="") s += "\"top\":\"" + top + "\",";
+  return s + "\"namespaces\":{\"global\":{\"modules\":{" + modules + "}}}}";
+}
+string declaration(string name) {
+  return "\"" + name + "\":{\"type\":" + type + "}";
+}
+
+int main() {
+  //top -> mid -> leaf, each in its own file and listed before what it uses
+  writeFile("_link_top.json",file(module("top","global.mid") + "," + declaration("mid"),"global.top"));
+  writeFile("_link_mid.json",file(module("mid","global.leaf")));
+  writeFile("_link_leaf.json",file(module("leaf","")));
+  vector<string> files = {"_link_top.json","_link_mid.json","_link_leaf.json"};
+
+  //Loading them one by one keeps the first declaration of mid, which has no
+  //definition
+  Context* c = newContext();
+  for (auto f : files) assert(loadFromFile(c,f));
+  assert(!c->getGlobal()->getModule("mid")->hasDef());
+  deleteContext(c);
+
+  c = newContext();
+  c->setNumThreads(4);
+  Module* top = nullptr;
+  assert(linkFiles(c,files,&top));
+  assert(top && top->getName()=="top" && c->getTop()==top);
+  Module* mid = c->getGlobal()->getModule("mid");
+  assert(mid->hasDef());
+  assert(mid->getDef()->getInstances().at("s")->getModuleRef()==c->getGlobal()->getModule("leaf"));
+  assert(!top->getDef()->validate());
+  deleteContext(c);
+
+  //The same definition in two files is one symbol
+  writeFile("_link_leaf2.json",file(module("leaf","")));
+  c = newContext();
+  assert(linkFiles(c,{"_link_leaf2.json","_link_top.json","_link_mid.json","_link_leaf.json"},&top));
+  deleteContext(c);
+
+  //Definitions the context already has are checked against the files
+  writeFile("_link_leaf3.json",file(module("leaf","","2")));
+  c = newContext();
+  assert(loadFromFile(c,"_link_leaf.json"));
+  assert(linkFiles(c,files,&top));
+  deleteContext(c);
+  c = newContext();
+  assert(loadFromFile(c,"_link_leaf3.json"));
+  assert(!linkFiles(c,files,&top));
+  assert(!c->getGlobal()->getModule("top")->hasDef());
+  deleteContext(c);
+
+  //Different definitions, conflicting declarations and missing symbols are
+  //all reported and no definition is built
+  writeFile("_link_leaf2.json",file(module("leaf","","2") + ",\"mid\":{\"type\":[\"Array\",8,\"BitIn\"]}"));
+  writeFile("_link_other.json",file(module("other","global.missing") + "," + module("other2","global.missing")));
+  c = newContext();
+  assert(!linkFiles(c,{"_link_top.json","_link_mid.json","_link_leaf.json","_link_leaf2.json","_link_other.json"},&top));
+  assert(!c->getGlobal()->getModule("top")->hasDef());
+  deleteContext(c);
+
+  c = newContext();
+  assert(!linkFiles(c,{"_link_top.json","_link_mid.json"},&top));
+  deleteContext(c);
+
+  //Files that name a top have to agree on it
+  writeFile("_link_top2.json",file(module("top2",""),"global.top2"));
+  c = newContext();
+  assert(linkFiles(c,{"_link_top.json","_link_mid.json","_link_leaf.json","_link_top.json"},&top));
+  deleteContext(c);
+  c = newContext();
+  assert(!linkFiles(c,{"_link_top.json","_link_mid.json","_link_leaf.json","_link_top2.json"},&top));
+  deleteContext(c);
+  c = newContext();
+  assert(!linkFiles(c,{"_link_top.json","_link_nofile.json"},&top));
+  deleteContext(c);
+
+  for (auto f : {"_link_top.json","_link_mid.json","_link_leaf.json","_link_leaf2.json","_link_leaf3.json","_link_top2.json","_link_other.json"}) {
+    remove(f);
+  }
+}
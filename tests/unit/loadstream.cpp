@@ -0,0 +1,64 @@
+#include "coreir.h"
+#include <fstream>
+
+using namespace std;
+using namespace CoreIR;
+
+void writeFile(string filename, string contents) {
+  std::ofstream file(filename);
+  file << contents;
+}
+
+int main() {
+  //Odd whitespace, escaped strings, key order and brackets inside strings
+  string good = R"(
+  {"top" : "global.top",
+   "namespaces":{
+    "global":{
+      "modules":{
+        "top":{
+          "connections":[["self.out","i0.out"]] ,
+          "instances":{
+            "i0":{"modref":"global.decl"},
+            "i0":{"genref":"coreir.const","genargs":{"width":["Int",4]},"modargs":{"value":[["BitVector",4],"4'h5"]},"metadata":{"note":"a \"quoted\" {not} [json]"}}
+          },
+          "type":["Record",[["out",["Array",4,"Bit"]]]],
+          "metadata":{"esc\\aped":"A"}
+        },
+        "decl":{"type":["Record",[["in",["Array",4,"BitIn"]]]]}
+      }
+    }
+  }}
+  )";
+  writeFile("_loadstream.json",good);
+  Context* c = newContext();
+  Module* top = nullptr;
+  assert(loadFromFile(c,"_loadstream.json",&top));
+  assert(top && top->getName()=="top");
+  assert(c->getGlobal()->hasModule("decl"));
+  assert(!c->getGlobal()->getModule("decl")->hasDef());
+  ModuleDef* def = top->getDef();
+  //Repeated keys keep the last value
+  assert(def->getInstances().size()==1);
+  assert(cast<Instance>(def->sel("i0"))->getModuleRef()->isGenerated());
+  assert(def->getConnections().size()==1);
+  Instance* i0 = cast<Instance>(def->sel("i0"));
+  assert(i0->getMetaData()["note"] == "a \"quoted\" {not} [json]");
+  assert(top->getMetaData()["esc\\aped"] == "A");
+  deleteContext(c);
+
+  //Files with malformed structure are reported without touching the context
+  for (string bad : {
+    string("{\"namespaces\":{\"global\":{\"modules\":{}}}"),
+    string("{\"namespaces\":{\"global\":{\"modules\":{\"m\":{\"type\":\"Bit\"}}}}} x"),
+    string("{\"namespaces\":{\"global\":{\"bad\":{}}}}"),
+    string("{\"namespaces\":{\"global\":{\"modules\":{\"m\":{\"type\":\"Bit\",\"metadata\":{\"a\":[1}]}}}}}"),
+    string("")
+  }) {
+    writeFile("_loadstream.json",bad);
+    c = newContext();
+    assert(!loadFromFile(c,"_loadstream.json"));
+    assert(!c->getGlobal()->hasModule("m"));
+    deleteContext(c);
+  }
+}
@@ -0,0 +1,95 @@
+#include "coreir.h"
+#include "coreir/ir/parallel.h"
+#include <atomic>
+#include <fstream>
+
+using namespace std;
+using namespace CoreIR;
+
+//Chain of modules where each one instances the previous one
+string makeDesign(int numModules, bool broken=false) {
+  string mods;
+  for (int i=0; i<numModules; ++i) {
+    string name = "m" + to_string(i);
+    string insts = "\"a\":{\"genref\":\"coreir.add\",\"genargs\":{\"width\":[\"Int\",8]}}";
+    string cons = "[\"self.in\",\"a.in0\"],[\"self.in\",\"a.in1\"]";
+    if (i>0) {
+      insts += ",\"sub\":{\"modref\":\"global.m" + to_string(i-1) + "\",\"metadata\":{\"i\":" + to_string(i) + "}}";
+      cons += ",[\"a.out\",\"sub.in\"],[\"sub.out\",\"self.out\",{\"c\":" + to_string(i) + "}]";
+    }
+    else {
+      cons += ",[\"a.out\",\"self.out\"]";
+    }
+    if (broken && i==numModules/2) cons += ",[\"a.out\"]";
+    mods += string(i ? "," : "") + "\"" + name + "\":{\"type\":[\"Record\",[[\"in\",[\"Array\",8,\"BitIn\"]],[\"out\",[\"Array\",8,\"Bit\"]]]],"
+      + "\"instances\":{" + insts + "},\"connections\":[" + cons + "]}";
+  }
+  return "{\"top\":\"global.m" + to_string(numModules-1) + "\",\"namespaces\":{\"global\":{\"modules\":{" + mods + "}}}}";
+}
+
+int main() {
+  //parallelFor visits every index once and forwards exceptions. The pool
+  //is reused across loops, and nested loops run on the calling thread
+  ThreadPool pool(4);
+  assert(pool.getNumThreads()==4);
+  vector<atomic<int>> counts(1000);
+  for (auto& cnt : counts) cnt = 0;
+  for (int rep=0; rep<3; ++rep) {
+    pool.parallelFor(counts.size(),[&](size_t i) { counts[i]++; });
+  }
+  for (auto& cnt : counts) assert(cnt==3);
+  bool caught = false;
+  try {
+    pool.parallelFor(100,[](size_t i) { if (i==42) throw std::runtime_error("42"); });
+  } catch(std::runtime_error& e) {
+    caught = string(e.what())=="42";
+  }
+  assert(caught);
+  for (auto& cnt : counts) cnt = 0;
+  pool.parallelFor(10,[&](size_t i) {
+    pool.parallelFor(100,[&](size_t j) { counts[i*100+j]++; });
+  });
+  for (auto& cnt : counts) assert(cnt==1);
+
+  //Contexts are serial unless asked otherwise
+  Context* c1 = newContext();
+  assert(c1->getNumThreads()==1);
+  c1->setNumThreads(3);
+  assert(c1->getThreadPool()->getNumThreads()==3);
+  deleteContext(c1);
+
+  int numModules = 300;
+  {
+    std::ofstream f("_parallelload.json");
+    f << makeDesign(numModules);
+  }
+  vector<string> keys;
+  for (uint threads : {1,8}) {
+    Context* c = newContext();
+    c->setNumThreads(threads);
+    assert(c->getNumThreads()==threads);
+    Module* top = nullptr;
+    assert(loadFromFile(c,"_parallelload.json",&top));
+    assert(top && top->getName()=="m" + to_string(numModules-1));
+    ModuleDef* def = top->getDef();
+    assert(def->getInstances().size()==2);
+    assert(def->getMetaData(def->sel("sub.out"),def->sel("self.out"))["c"]==numModules-1);
+    string key;
+    for (int i=0; i<numModules; ++i) {
+      key += getStructuralKey(c->getGlobal()->getModule("m" + to_string(i)));
+    }
+    keys.push_back(key);
+    deleteContext(c);
+  }
+  assert(keys[0]==keys[1]);
+
+  //An error while parsing one of the definitions fails the whole load
+  {
+    std::ofstream f("_parallelload.json");
+    f << makeDesign(numModules,true);
+  }
+  Context* c = newContext();
+  c->setNumThreads(8);
+  assert(!loadFromFile(c,"_parallelload.json"));
+  deleteContext(c);
+}
@@ -0,0 +1,93 @@
+#include "coreir.h"
+#include "coreir/ir/fingerprint.h"
+
+using namespace std;
+using namespace CoreIR;
+
+//Adds a uniquely named generated instance to every module
+class AddUnique : public ModulePass {
+  public :
+    static string ID;
+    AddUnique() : ModulePass(ID,"Adds a uniquely named instance") {}
+    void setAnalysisInfo() override {
+      setModuleParallel();
+    }
+    bool runOnModule(Module* m) override {
+      Context* c = getContext();
+      int width = 1 + m->getName().size()%7;
+      m->getDef()->addInstance(c->getUnique(),"coreir.term",{{"width",Const::make(c,width)}});
+      return true;
+    }
+};
+string AddUnique::ID = "addunique";
+
+//Modules with bulk connections and a dead adder each
+Context* build(uint threads, int numModules) {
+  Context* c = newContext();
+  c->setNumThreads(threads);
+  Namespace* g = c->getGlobal();
+  Type* t = c->Record({
+    {"in",c->BitIn()->Arr(8)->Arr(2)},
+    {"out",c->Bit()->Arr(8)->Arr(2)},
+    {"sum",c->Bit()->Arr(8)}
+  });
+  Module* top = g->newModuleDecl("top",t);
+  ModuleDef* tdef = top->newModuleDef();
+  string prev = "self.in";
+  for (int i=0; i<numModules; ++i) {
+    Module* m = g->newModuleDecl("m" + to_string(i),t);
+    ModuleDef* def = m->newModuleDef();
+    def->addInstance("a","coreir.add",{{"width",Const::make(c,8)}});
+    def->addInstance("dead","coreir.add",{{"width",Const::make(c,8)}});
+    def->connect("self.in","self.out");
+    def->connect("self.in.0","a.in0");
+    def->connect("self.in.1","a.in1");
+    def->connect("self.in.0","dead.in0");
+    def->connect("a.out","self.sum");
+    m->setDef(def);
+    string iname = "i" + to_string(i);
+    tdef->addInstance(iname,m);
+    tdef->connect(prev,iname + ".in");
+    prev = iname + ".out";
+  }
+  tdef->connect(prev,"self.out");
+  top->setDef(tdef);
+  c->setTop(top);
+  c->getPassManager()->addPass(new AddUnique());
+  return c;
+}
+
+map<string,string> keys(Context* c) {
+  map<string,string> ret;
+  for (auto mpair : c->getGlobal()->getModules()) {
+    ret[mpair.first] = getStructuralKey(mpair.second);
+  }
+  return ret;
+}
+
+int main() {
+  Context* c = build(1,100);
+  c->runPasses({"removebulkconnections","deletedeadinstances"});
+  auto serial = keys(c);
+  assert(c->getGlobal()->getModule("m7")->getDef()->getInstances().count("dead")==0);
+  assert(c->getGlobal()->getModule("m7")->getDef()->getConnections().size()==5);
+  deleteContext(c);
+
+  //Same result on many threads
+  c = build(8,100);
+  c->runPasses({"removebulkconnections","deletedeadinstances"});
+  assert(keys(c)==serial);
+
+  //Unique names and generated modules can be asked for concurrently
+  c->runPasses({"addunique"});
+  set<string> names;
+  for (auto mpair : c->getGlobal()->getModules()) {
+    for (auto ipair : mpair.second->getDef()->getInstances()) {
+      if (ipair.first.substr(0,2)=="_U") names.insert(ipair.first);
+    }
+  }
+  assert(names.size()==101);
+  Generator* term = c->getGenerator("coreir.term");
+  assert(term->getGeneratedModules().size()<=7);
+  deleteContext(c);
+}
@@ -0,0 +1,60 @@
+#include "coreir.h"
+#include "coreir/passes/analysis/verilog.h"
+
+using namespace std;
+using namespace CoreIR;
+
+//Many modules that all instance the same parameterized module and generators
+string emit(uint threads, int numModules) {
+  Context* c = newContext();
+  c->setNumThreads(threads);
+  Namespace* g = c->getGlobal();
+  Type* t = c->Record({{"in",c->BitIn()->Arr(8)},{"out",c->Bit()->Arr(8)}});
+  Module* leaf = g->newModuleDecl("leaf",t,{{"init",c->BitVector(8)}});
+  ModuleDef* def = leaf->newModuleDef();
+  def->addInstance("r","coreir.const",{{"width",Const::make(c,8)}},{{"value",leaf->getArg("init")}});
+  def->addInstance("a","coreir.add",{{"width",Const::make(c,8)}});
+  def->connect("self.in","a.in0");
+  def->connect("r.out","a.in1");
+  def->connect("a.out","self.out");
+  leaf->setDef(def);
+
+  Module* top = g->newModuleDecl("top",t);
+  ModuleDef* tdef = top->newModuleDef();
+  string prev = "self.in";
+  for (int i=0; i<numModules; ++i) {
+    Module* m = g->newModuleDecl("m" + to_string(i),t);
+    def = m->newModuleDef();
+    def->addInstance("l0","global.leaf",{{"init",Const::make(c,BitVector(8,i))}});
+    def->addInstance("l1","global.leaf",{{"init",Const::make(c,BitVector(8,i+1))}});
+    def->addInstance("a","coreir.add",{{"width",Const::make(c,8)}});
+    def->connect("self.in","l0.in");
+    def->connect("self.in","l1.in");
+    def->connect("l0.out","a.in0");
+    def->connect("l1.out","a.in1");
+    def->connect("a.out","self.out");
+    m->setDef(def);
+    string iname = "i" + to_string(i);
+    tdef->addInstance(iname,m);
+    tdef->connect(prev,iname + ".in");
+    prev = iname + ".out";
+  }
+  tdef->connect(prev,"self.out");
+  top->setDef(tdef);
+  c->setTop(top);
+
+  c->runPasses({"rungenerators","removebulkconnections","flattentypes","verilog"});
+  auto vpass = static_cast<Passes::Verilog*>(c->getPassManager()->getAnalysisPass("verilog"));
+  std::ostringstream os;
+  vpass->writeToStream(os);
+  deleteContext(c);
+  return os.str();
+}
+
+int main() {
+  string serial = emit(1,200);
+  assert(serial.find("module m199") != string::npos);
+  assert(serial.find("leaf #(.init(8'h00)) l0") != string::npos);
+  //Same output in the same order
+  assert(emit(8,200)==serial);
+}
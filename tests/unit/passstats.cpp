@@ -0,0 +1,70 @@
+#include "coreir.h"
+#include <sstream>
+
+using namespace std;
+using namespace CoreIR;
+
+//top instances mid twice, which adds a constant
+void build(Context* c) {
+  Namespace* g = c->getGlobal();
+  Type* t = c->Record({{"in",c->BitIn()->Arr(8)},{"out",c->Bit()->Arr(8)}});
+  Module* mid = g->newModuleDecl("mid",t);
+  ModuleDef* def = mid->newModuleDef();
+  def->addInstance("c","coreir.const",{{"width",Const::make(c,8)}},{{"value",Const::make(c,BitVector(8,1))}});
+  def->addInstance("a","coreir.add",{{"width",Const::make(c,8)}});
+  def->connect("self.in","a.in0");
+  def->connect("c.out","a.in1");
+  def->connect("a.out","self.out");
+  mid->setDef(def);
+  Module* top = g->newModuleDecl("top",t);
+  def = top->newModuleDef();
+  def->addInstance("m0",mid);
+  def->addInstance("m1",mid);
+  def->connect("self.in","m0.in");
+  def->connect("m0.out","m1.in");
+  def->connect("m1.out","self.out");
+  top->setDef(def);
+  c->setTop(top);
+}
+
+int main() {
+  Context* c = newContext();
+  build(c);
+  PassManager* pm = c->getPassManager();
+  c->runPasses({"rungenerators"});
+  assert(pm->getPassStats().empty());
+
+  pm->setInstrumented(true);
+  c->runPasses({"flatten"});
+  c->runPasses({"flatten"});
+  auto& stats = pm->getPassStats();
+  assert(stats.count("flatten") && stats.at("flatten").runs==2);
+  //Flattening top adds the instances and connections of mid
+  const PassStats& flatten = stats.at("flatten");
+  assert(flatten.instancesBefore==4 && flatten.instancesAfter==6);
+  assert(flatten.connectionsBefore==6 && flatten.connectionsAfter==8);
+  assert(flatten.wallSeconds>=0 && flatten.cpuSeconds>=0 && flatten.peakRssDeltaKB>=0);
+  //The verifier that runs after a modifying pass is measured too
+  assert(stats.count("verifyinputconnections"));
+
+  std::ostringstream table;
+  pm->printPassStats(table);
+  assert(table.str().find("flatten") != string::npos);
+  assert(table.str().find("4 -> 6") != string::npos);
+
+  std::ostringstream os;
+  pm->writePassStatsJson(os);
+  json jstats = json::parse(os.str());
+  bool found = false;
+  for (auto& jpass : jstats.at("passes")) {
+    if (jpass.at("name")!="flatten") continue;
+    found = true;
+    assert(jpass.at("runs")==2);
+    assert(jpass.at("instances_after")==6);
+  }
+  assert(found);
+
+  pm->clearPassStats();
+  assert(pm->getPassStats().empty());
+  deleteContext(c);
+}
@@ -0,0 +1,119 @@
+#include "coreir.h"
+
+using namespace std;
+using namespace CoreIR;
+
+//Terminates the input of one module
+class TermOne : public ContextPass {
+  public :
+    static string ID;
+    TermOne() : ContextPass(ID,"Adds a term to one module") {}
+    bool runOnContext(Context* c) override {
+      ModuleDef* def = c->getGlobal()->getModule("m0")->getDef();
+      def->addInstance("t" + to_string(def->getInstances().size()),"coreir.term",{{"width",Const::make(c,8)}});
+      return true;
+    }
+};
+string TermOne::ID = "termone";
+
+//Reconnects a module and says that it keeps the instance map
+class Reconnect : public ContextPass {
+  public :
+    static string ID;
+    Reconnect() : ContextPass(ID,"Reconnects one module") {}
+    void setAnalysisInfo() override {
+      addPreserved("createfullinstancemap");
+    }
+    bool runOnContext(Context* c) override {
+      ModuleDef* def = c->getGlobal()->getModule("m0")->getDef();
+      def->disconnect(def->sel("self.in"),def->sel("self.out"));
+      def->connect("self.in","self.out");
+      return true;
+    }
+};
+string Reconnect::ID = "reconnect";
+
+Type* bits(Context* c) {
+  return c->Record({{"in",c->BitIn()->Arr(8)},{"out",c->Bit()->Arr(8)}});
+}
+
+void build(Context* c, int numModules) {
+  Namespace* g = c->getGlobal();
+  Module* top = g->newModuleDecl("top",bits(c));
+  ModuleDef* tdef = top->newModuleDef();
+  string prev = "self.in";
+  for (int i=0; i<numModules; ++i) {
+    Module* m = g->newModuleDecl("m" + to_string(i),bits(c));
+    ModuleDef* def = m->newModuleDef();
+    def->connect("self.in","self.out");
+    m->setDef(def);
+    string iname = "i" + to_string(i);
+    tdef->addInstance(iname,m);
+    tdef->connect(prev,iname + ".in");
+    prev = iname + ".out";
+  }
+  tdef->connect(prev,"self.out");
+  top->setDef(tdef);
+  c->setTop(top);
+}
+
+int main() {
+  Context* c = newContext();
+  build(c,4);
+  PassManager* pm = c->getPassManager();
+  pm->addPass(new TermOne());
+  pm->addPass(new Reconnect());
+
+  //Analyses are invalidated unless the pass preserves them (or they are kept
+  //up to date like the instance graph)
+  c->runPasses({"createinstancegraph","createfullinstancemap","verifyflattenedtypes"});
+  assert(pm->isAnalysisCached("createfullinstancemap"));
+  c->runPasses({"termone"});
+  assert(!pm->isAnalysisCached("createfullinstancemap"));
+  assert(!pm->isAnalysisCached("verifyflattenedtypes"));
+  assert(pm->isAnalysisCached("createinstancegraph"));
+  c->runPasses({"createfullinstancemap","verifyflattenedtypes"});
+  c->runPasses({"reconnect"});
+  assert(pm->isAnalysisCached("createfullinstancemap"));
+  assert(!pm->isAnalysisCached("verifyflattenedtypes"));
+  assert(pm->isAnalysisCached("verifyinputconnections"));
+
+  //Everything is verified after a modifying pass
+  for (auto mpair : c->getGlobal()->getModules()) assert(!mpair.second->isUnverified());
+  Module* m1 = c->getGlobal()->getModule("m1");
+  m1->getDef()->addInstance("t","coreir.term",{{"width",Const::make(c,8)}});
+  assert(m1->isUnverified());
+  assert(!c->getGlobal()->getModule("m2")->isUnverified());
+  c->runPasses({"termone"});
+  assert(!m1->isUnverified());
+  assert(saveToFile(c,"_preservedanalyses.json"));
+  deleteContext(c);
+
+  //Only the modified modules are verified, so the other lazy definitions are
+  //not loaded
+  c = newContext();
+  pm = c->getPassManager();
+  pm->addPass(new TermOne());
+  assert(loadFromFile(c,"_preservedanalyses.json",nullptr,true));
+  c->runPasses({"termone"});
+  assert(!c->getGlobal()->getModule("m0")->hasLazyDef());
+  assert(c->getGlobal()->getModule("m1")->hasLazyDef());
+  assert(c->getGlobal()->getModule("top")->hasLazyDef());
+  //They stay unverified, also once they are loaded
+  assert(c->getGlobal()->getModule("m1")->isUnverified());
+  assert(!pm->isAnalysisCached("verifyinputconnections"));
+  c->getGlobal()->getModule("m2")->getDef();
+  assert(c->getGlobal()->getModule("m2")->isUnverified());
+  c->runPasses({"termone"});
+  assert(!c->getGlobal()->getModule("m2")->isUnverified());
+  assert(c->getGlobal()->getModule("m1")->isUnverified());
+
+  //Unless everything is verified
+  pm->setVerifyAll(true);
+  c->runPasses({"termone"});
+  assert(!c->getGlobal()->getModule("m1")->hasLazyDef());
+  assert(!c->getGlobal()->getModule("m1")->isUnverified());
+  assert(pm->isAnalysisCached("verifyinputconnections"));
+  deleteContext(c);
+  remove("_preservedanalyses.json");
+}
@@ -0,0 +1,68 @@
+#include "coreir.h"
+#include "coreir/ir/parallel.h"
+
+using namespace std;
+using namespace CoreIR;
+
+int main() {
+  Context* c = newContext();
+  Namespace* g = c->getGlobal();
+  StringInterner* interner = c->getInterner();
+
+  uint width = 4;
+  Type* addType = c->Record({
+    {"in0", c->BitIn()->Arr(width)},
+    {"in1", c->BitIn()->Arr(width)},
+    {"out", c->Bit()->Arr(width)}
+  });
+
+  Module* addMod = g->newModuleDecl("addMod", addType);
+  ModuleDef* def = addMod->newModuleDef();
+  def->addInstance("add0", "coreir.add", {{"width", Const::make(c, width)}});
+  def->connect("self.in0", "add0.in0");
+  def->connect("self.in1", "add0.in1");
+  def->connect("add0.out", "self.out");
+  addMod->setDef(def);
+
+  //Same strings intern to the same symbol
+  assert(interner->intern("add0") == interner->intern("add0"));
+  assert(interner->intern("add0") != interner->intern("self"));
+
+  //Symbol paths select the same wireables as string paths
+  Wireable* w = def->sel("add0.out.3");
+  SymbolPath sp = w->getSymbolPath();
+  assert(sp.size() == 3);
+  assert(def->sel(sp) == w);
+  assert(interner->toSelectPath(sp) == w->getSelectPath());
+  assert(interner->toSymbolPath({"self","in1"}) == def->sel("self.in1")->getSymbolPath());
+
+  //Select strings and instance names are shared with the interner
+  Select* s = cast<Select>(w);
+  assert(&s->getSelStr() == &interner->getString(s->getSelsym()));
+  Instance* inst = cast<Instance>(def->sel("add0"));
+  assert(&inst->getInstname() == &interner->getString(inst->getInstsym()));
+
+  //Selects first made through symbols are the same as the string ones
+  Select* s2 = inst->sel(interner->toSymbolPath({"in0","2"}));
+  assert(s2 == inst->sel("in0")->sel(2));
+  assert(inst->sel(interner->intern("in1")) == def->sel("add0.in1"));
+  inst->sel("in0")->removeSel("2");
+  assert(inst->sel("in0")->sel(interner->intern("2")) == inst->sel("in0")->sel(2));
+
+  //Names added concurrently (enough to grow the table a few times) get one
+  //symbol each and stay readable
+  c->setNumThreads(4);
+  size_t before = interner->size();
+  vector<Symbol> syms(20000);
+  parallelFor(c,syms.size(),[&](size_t i) {
+    syms[i] = interner->intern("n" + to_string(i % 10000));
+    assert(interner->getString(syms[i]) == "n" + to_string(i % 10000));
+  });
+  assert(interner->size() == before + 10000);
+  for (uint i=0; i<10000; ++i) {
+    assert(syms[i] == syms[i+10000]);
+    assert(interner->isInterned("n" + to_string(i)));
+  }
+
+  deleteContext(c);
+}